@@ -46,9 +46,20 @@ volatile int num_filedes = 1;
 static ink_mutex insert_mutex;
 
 int thread_is_created = 0;
+
+// time from queueing to completion of each class of request
+enum {
+  AIO_LATENCY_FOREGROUND_READ,
+  AIO_LATENCY_FOREGROUND_WRITE,
+  AIO_LATENCY_BACKGROUND,
+  AIO_LATENCY_COUNT,
+};
+static RecHistogram aio_latency[AIO_LATENCY_COUNT];
 #endif // AIO_MODE == AIO_MODE_NATIVE
 RecInt cache_config_threads_per_disk = 12;
 RecInt api_config_threads_per_disk = 12;
+RecInt cache_config_aio_background_max_pending = 1;
+RecInt cache_config_aio_background_max_delay = 1000;
 
 RecRawStatBlock *aio_rsb = NULL;
 Continuation *aio_err_callbck = 0;
@@ -160,8 +171,15 @@ ink_aio_init(ModuleVersion v)
 #if AIO_MODE != AIO_MODE_NATIVE
   memset(&aio_reqs, 0, MAX_DISKS_POSSIBLE * sizeof(AIO_Reqs *));
   ink_mutex_init(&insert_mutex, NULL);
+  RecRegisterSharedHistogram(RECT_PROCESS, "proxy.process.cache.aio.latency.foreground_read",
+                             &aio_latency[AIO_LATENCY_FOREGROUND_READ]);
+  RecRegisterSharedHistogram(RECT_PROCESS, "proxy.process.cache.aio.latency.foreground_write",
+                             &aio_latency[AIO_LATENCY_FOREGROUND_WRITE]);
+  RecRegisterSharedHistogram(RECT_PROCESS, "proxy.process.cache.aio.latency.background", &aio_latency[AIO_LATENCY_BACKGROUND]);
 #endif
   REC_ReadConfigInteger(cache_config_threads_per_disk, "proxy.config.cache.threads_per_disk");
+  REC_ReadConfigInteger(cache_config_aio_background_max_pending, "proxy.config.cache.aio.background_max_pending");
+  REC_ReadConfigInteger(cache_config_aio_background_max_delay, "proxy.config.cache.aio.background_max_delay");
 }
 
 int
@@ -207,7 +225,13 @@ struct AIOThreadInfo : public Continuation {
    appropriate queue. If they fail to acquire the lock, they put the
    request in the atomic list. Requests are served in the order of
    highest priority first. If both the queues are empty, the aio threads
-   check if there is any request on the other disks */
+   check if there is any request on the other disks.
+
+   Background requests (directory sync, scans) have a third
+   queue, served only when the other two are empty or once its head waited
+   longer than proxy.config.cache.aio.background_max_delay, and by at most
+   proxy.config.cache.aio.background_max_pending threads of the disk at a
+   time so that they never take over a disk serving cache hits. */
 
 
 /* insert  an entry for file descriptor fildes into aio_reqs */
@@ -272,7 +296,9 @@ aio_insert(AIOCallback *op, AIO_Reqs *req)
   num_requests++;
   req->queued++;
 #endif
-  if (op->aiocb.aio_reqprio == AIO_LOWEST_PRIORITY) // http request
+  if (op->aiocb.aio_reqprio == AIO_BACKGROUND_PRIORITY) {
+    req->bg_aio_todo.enqueue(op);
+  } else if (op->aiocb.aio_reqprio == AIO_LOWEST_PRIORITY) // http request
   {
     AIOCallback *cb = (AIOCallback *)req->http_aio_todo.tail;
     if (!cb)
@@ -327,6 +353,7 @@ aio_queue_req(AIOCallbackInternal *op, int fromAPI = 0)
   op->link.next = NULL;
   ;
   op->link.prev = NULL;
+  op->queue_time = Thread::get_hrtime();
 #ifdef AIO_STATS
   ink_atomic_increment((int *)&data->num_req, 1);
 #endif
@@ -392,6 +419,22 @@ aio_queue_req(AIOCallbackInternal *op, int fromAPI = 0)
   }
 }
 
+/* next request to serve, called with aio_mutex held */
+static AIOCallback *
+aio_next(AIO_Reqs *req)
+{
+  AIOCallbackInternal *bg = (AIOCallbackInternal *)req->bg_aio_todo.head;
+  AIOCallback *op;
+
+  if (bg && req->bg_pending >= cache_config_aio_background_max_pending)
+    bg = NULL;
+  if (bg && Thread::get_hrtime() - bg->queue_time > HRTIME_MSECONDS(cache_config_aio_background_max_delay))
+    return req->bg_aio_todo.dequeue();
+  if ((op = req->aio_todo.pop()) || (op = req->http_aio_todo.pop()))
+    return op;
+  return bg ? req->bg_aio_todo.dequeue() : NULL;
+}
+
 static inline int
 cache_op(AIOCallbackInternal *op)
 {
@@ -467,8 +510,15 @@ aio_thread_main(void *arg)
       /* check if any pending requests on the atomic list */
       if (!INK_ATOMICLIST_EMPTY(my_aio_req->aio_temp_list))
         aio_move(my_aio_req);
-      if (!(op = my_aio_req->aio_todo.pop()) && !(op = my_aio_req->http_aio_todo.pop()))
+      if (!(op = aio_next(my_aio_req)))
         break;
+      int latency_class = AIO_LATENCY_FOREGROUND_READ;
+      if (op->aiocb.aio_reqprio == AIO_BACKGROUND_PRIORITY) {
+        latency_class = AIO_LATENCY_BACKGROUND;
+        current_req->bg_pending++;
+      } else if (op->aiocb.aio_lio_opcode == LIO_WRITE) {
+        latency_class = AIO_LATENCY_FOREGROUND_WRITE;
+      }
 #ifdef AIO_STATS
       num_requests--;
       current_req->queued--;
@@ -496,6 +546,8 @@ aio_thread_main(void *arg)
 #ifdef AIO_STATS
       ink_atomic_increment((int *)&current_req->pending, -1);
 #endif
+      RecIncrSharedHistogram(&aio_latency[latency_class],
+                             ink_hrtime_to_usec(Thread::get_hrtime() - ((AIOCallbackInternal *)op)->queue_time));
       op->link.prev = NULL;
       op->link.next = NULL;
       op->mutex = op->action.mutex;
@@ -508,6 +560,8 @@ aio_thread_main(void *arg)
       else
         op->thread->schedule_imm_signal(op);
       ink_mutex_acquire(&my_aio_req->aio_mutex);
+      if (latency_class == AIO_LATENCY_BACKGROUND)
+        current_req->bg_pending--;
     } while (1);
     timespec timedwait_msec = ink_hrtime_to_timespec(Thread::get_hrtime() + HRTIME_MSECONDS(net_config_poll_timeout));
     ink_cond_timedwait(&my_aio_req->aio_cond, &my_aio_req->aio_mutex, &timedwait_msec);
@@ -91,6 +91,8 @@ bool ink_aio_thread_num_set(int thread_num);
 
 #define AIO_LOWEST_PRIORITY 0
 #define AIO_DEFAULT_PRIORITY AIO_LOWEST_PRIORITY
+// internal housekeeping I/O, served after every other request of the disk
+#define AIO_BACKGROUND_PRIORITY -1
 
 struct AIOCallback : public Continuation {
   // set before calling aio_read/aio_write
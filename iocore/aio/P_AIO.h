@@ -99,6 +99,7 @@ struct AIOCallbackInternal : public AIOCallback {
   AIOCallback *first;
   AIO_Reqs *aio_req;
   ink_hrtime sleep_time;
+  ink_hrtime queue_time; // when the request was queued
   int io_complete(int event, void *data);
   AIOCallbackInternal()
   {
@@ -121,6 +122,7 @@ AIOCallbackInternal::io_complete(int event, void *data)
 struct AIO_Reqs {
   Que(AIOCallback, link) aio_todo;      /* queue for holding non-http requests */
   Que(AIOCallback, link) http_aio_todo; /* queue for http requests */
+  Que(AIOCallback, link) bg_aio_todo;   /* queue for background requests */
                                         /* Atomic list to temporarily hold the request if the
                                            lock for a particular queue cannot be acquired */
   InkAtomicList aio_temp_list;
@@ -131,6 +133,7 @@ struct AIO_Reqs {
   volatile int queued;  /* total number of aio_todo and http_todo requests */
   volatile int filedes; /* the file descriptor for the requests */
   volatile int requests_queued;
+  int bg_pending; /* background requests being served, under aio_mutex */
 };
 
 #endif // AIO_MODE == AIO_MODE_NATIVE
@@ -76,12 +76,20 @@ int cache_config_hit_evacuate_size_limit = 0;
 int cache_config_force_sector_size = 0;
 int cache_config_target_fragment_size = DEFAULT_TARGET_FRAGMENT_SIZE;
 int cache_config_agg_write_backlog = AGG_SIZE * 2;
+int cache_config_init_reads = 1;
 int cache_config_enable_checksum = 0;
 int cache_config_alt_rewrite_max_size = 4096;
 int cache_config_read_while_writer = 0;
 int cache_config_mutex_retry_delay = 2;
 int cache_read_while_writer_retry_delay = 50;
 int cache_config_read_while_writer_max_retries = 10;
+int cache_config_tier_volume = 0;
+int cache_config_tier_promote_hits = 4;
+int64_t cache_config_tier_promote_max_size = 16 * 1024 * 1024;
+int64_t cache_config_tier_index_size = 1048576;
+int cache_config_admission_enabled = 0;
+int cache_config_admission_min_hits = 2;
+int64_t cache_config_admission_sketch_size = 262144;
 #ifdef HTTP_CACHE
 static int enable_cache_empty_http_doc = 0;
 /// Fix up a specific known problem with the 4.2.0 release.
@@ -123,10 +131,18 @@ struct VolInitInfo {
   off_t recover_pos;
   AIOCallbackInternal vol_aio[4];
   char *vol_h_f;
+  // Vol::init_read
+  AIOCallbackInternal read_aio[VOL_MAX_INIT_READS];
+  int reads_pending;
+  bool read_failed;
+  ContinuationHandler read_handler;
 
   VolInitInfo()
   {
     recover_pos = 0;
+    reads_pending = 0;
+    read_failed = false;
+    read_handler = NULL;
     vol_h_f = (char *)ats_memalign(ats_pagesize(), 4 * STORE_BLOCK_SIZE);
     memset(vol_h_f, 0, 4 * STORE_BLOCK_SIZE);
   }
@@ -137,6 +153,10 @@ struct VolInitInfo {
       vol_aio[i].action = NULL;
       vol_aio[i].mutex.clear();
     }
+    for (int i = 0; i < VOL_MAX_INIT_READS; i++) {
+      read_aio[i].action = NULL;
+      read_aio[i].mutex.clear();
+    }
     free(vol_h_f);
   }
 };
@@ -1391,6 +1411,11 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   header = (VolHeaderFooter *)raw_dir;
   footer = (VolHeaderFooter *)(raw_dir + vol_dirlen(this) - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
 
+  // neither on disk copy is known to match memory, the first sync of each is full
+  for (int i = 0; i < 2; i++) {
+    dir_dirty[i] = (uint64_t *)ats_malloc(((segments + 63) / 64) * sizeof(uint64_t));
+    memset(dir_dirty[i], 0xff, ((segments + 63) / 64) * sizeof(uint64_t));
+  }
 
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
@@ -1428,6 +1453,55 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   return 0;
 }
 
+/* The directory and recovery reads are large and sequential. Split the read
+   described by io into proxy.config.cache.init_reads pieces issued together
+   so the disk's AIO threads work on it in parallel, then call the current
+   handler once with io, as if it had been read in one go. On a rotational
+   disk the pieces of one range become seeks, so by default it is one read.
+*/
+void
+Vol::init_read()
+{
+  int nreads = MIN(MAX(cache_config_init_reads, 1), VOL_MAX_INIT_READS);
+  size_t chunk = ROUND_TO_STORE_BLOCK((io.aiocb.aio_nbytes + nreads - 1) / nreads);
+  int n = 0;
+
+  ink_assert(io.aiocb.aio_nbytes > 0);
+  for (size_t done = 0; done < io.aiocb.aio_nbytes; done += chunk, n++) {
+    AIOCallback *op = &init_info->read_aio[n];
+    op->aiocb.aio_fildes = fd;
+    op->aiocb.aio_buf = (char *)io.aiocb.aio_buf + done;
+    op->aiocb.aio_nbytes = MIN(chunk, io.aiocb.aio_nbytes - done);
+    op->aiocb.aio_offset = io.aiocb.aio_offset + done;
+    op->action = this;
+    op->thread = AIO_CALLBACK_THREAD_ANY;
+    op->then = 0;
+  }
+  init_info->reads_pending = n;
+  init_info->read_failed = false;
+  init_info->read_handler = handler;
+  SET_HANDLER(&Vol::handle_init_read);
+  // the callbacks need our lock, none of them runs before we return
+  for (int i = 0; i < n; i++)
+    ink_assert(ink_aio_read(&init_info->read_aio[i]));
+}
+
+int
+Vol::handle_init_read(int event, void *data)
+{
+  AIOCallback *op = (AIOCallback *)data;
+
+  ink_assert(event == AIO_EVENT_DONE);
+  if ((size_t)op->aio_result != (size_t)op->aiocb.aio_nbytes)
+    init_info->read_failed = true;
+  if (--init_info->reads_pending)
+    return EVENT_CONT;
+
+  io.aio_result = init_info->read_failed ? -1 : (int64_t)io.aiocb.aio_nbytes;
+  handler = init_info->read_handler;
+  return handleEvent(AIO_EVENT_DONE, &io);
+}
+
 int
 Vol::handle_dir_clear(int event, void *data)
 {
@@ -1700,7 +1774,7 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
     goto Lclear;
   prev_recover_pos = recover_pos;
   io.aiocb.aio_offset = recover_pos;
-  ink_assert(ink_aio_read(&io));
+  init_read();
   return EVENT_CONT;
 
 Ldone : {
@@ -1787,6 +1861,7 @@ Vol::handle_recover_write_dir(int /* event ATS_UNUSED */, void * /* data ATS_UNU
   delete init_info;
   init_info = 0;
   set_io_not_in_progress();
+  header->agg_pos = header->write_pos; // no aggregation write in flight
   scan_pos = header->write_pos;
   periodic_scan();
   SET_HANDLER(&Vol::dir_init_done);
@@ -1824,7 +1899,7 @@ Vol::handle_header_read(int event, void *data)
       if (is_debug_tag_set("cache_init"))
         Note("using directory A for '%s'", hash_text.get());
       io.aiocb.aio_offset = skip;
-      ink_assert(ink_aio_read(&io));
+      init_read();
     }
     // try B
     else if (hf[2]->sync_serial == hf[3]->sync_serial) {
@@ -1832,7 +1907,7 @@ Vol::handle_header_read(int event, void *data)
       if (is_debug_tag_set("cache_init"))
         Note("using directory B for '%s'", hash_text.get());
       io.aiocb.aio_offset = skip + vol_dirlen(this);
-      ink_assert(ink_aio_read(&io));
+      init_read();
     } else {
       Note("no good directory, clearing '%s'", hash_text.get());
       clear_dir();
@@ -2119,6 +2194,10 @@ Cache::open_done()
 
   hosttable = new CacheHostTable(this, scheme);
   hosttable->register_config_callback(&hosttable);
+  if (scheme == CACHE_HTTP_TYPE) {
+    cacheTier.init(this);
+    cacheAdmission.init(this);
+  }
 
   if (hosttable->gen_host_rec.num_cachevols == 0)
     ready = CACHE_INIT_FAILED;
@@ -2472,11 +2551,17 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   // see if its in the aggregation buffer
   if (dir_agg_buf_valid(vol, &dir)) {
-    int agg_offset = vol_offset(vol, &dir) - vol->header->write_pos;
+    off_t o = vol_offset(vol, &dir);
+    char *agg;
     buf = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
+    if (o < vol->header->agg_pos) {
+      ink_assert(o + (off_t)io.aiocb.aio_nbytes <= vol->header->agg_pos);
+      agg = vol->agg_write_buffer + (o - vol->header->write_pos);
+    } else {
+      ink_assert(o - vol->header->agg_pos + (off_t)io.aiocb.aio_nbytes <= vol->agg_buf_pos);
+      agg = vol->agg_buffer + (o - vol->header->agg_pos);
+    }
     char *doc = buf->data();
-    char *agg = vol->agg_buffer + agg_offset;
     memcpy(doc, agg, io.aiocb.aio_nbytes);
     io.aio_result = io.aiocb.aio_nbytes;
     SET_HANDLER(&CacheVC::handleReadDone);
@@ -3089,6 +3174,8 @@ rebuild_host_table(Cache *cache)
       build_vol_hash_table(&h_rec[i]);
     }
   }
+  if (cache->scheme == CACHE_HTTP_TYPE)
+    cacheTier.rebuild();
 }
 
 // if generic_host_rec.vols == NULL, what do we do???
@@ -3189,6 +3276,16 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("sync.count", cache_directory_sync_count_stat);
   REG_INT("sync.bytes", cache_directory_sync_bytes_stat);
   REG_INT("sync.time", cache_directory_sync_time_stat);
+  REG_INT("tier.promote.active", cache_tier_promote_active_stat);
+  REG_INT("tier.promote.success", cache_tier_promote_success_stat);
+  REG_INT("tier.promote.failure", cache_tier_promote_failure_stat);
+  REG_INT("tier.promote.bytes", cache_tier_promote_bytes_stat);
+  REG_INT("tier.read", cache_tier_read_stat);
+  REG_INT("tier.read_fallback", cache_tier_read_fallback_stat);
+  REG_INT("admission.admitted", cache_admission_admitted_stat);
+  REG_INT("admission.admitted_bytes", cache_admission_admitted_bytes_stat);
+  REG_INT("admission.rejected", cache_admission_rejected_stat);
+  REG_INT("admission.rejected_bytes", cache_admission_rejected_bytes_stat);
 }
 
 
@@ -3262,6 +3359,20 @@ ink_cache_init(ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_agg_write_backlog, "proxy.config.cache.agg_write_backlog");
   Debug("cache_init", "proxy.config.cache.agg_write_backlog = %d", cache_config_agg_write_backlog);
 
+  REC_EstablishStaticConfigInt32(cache_config_init_reads, "proxy.config.cache.init_reads");
+  Debug("cache_init", "proxy.config.cache.init_reads = %d", cache_config_init_reads);
+
+  REC_EstablishStaticConfigInt32(cache_config_tier_volume, "proxy.config.cache.tier.volume");
+  Debug("cache_init", "proxy.config.cache.tier.volume = %d", cache_config_tier_volume);
+  REC_EstablishStaticConfigInt32(cache_config_tier_promote_hits, "proxy.config.cache.tier.promote_hits");
+  REC_EstablishStaticConfigInteger(cache_config_tier_promote_max_size, "proxy.config.cache.tier.promote_max_size");
+  REC_EstablishStaticConfigInteger(cache_config_tier_index_size, "proxy.config.cache.tier.index_size");
+
+  REC_EstablishStaticConfigInt32(cache_config_admission_enabled, "proxy.config.cache.admission.enabled");
+  Debug("cache_init", "proxy.config.cache.admission.enabled = %d", cache_config_admission_enabled);
+  REC_EstablishStaticConfigInt32(cache_config_admission_min_hits, "proxy.config.cache.admission.min_hits");
+  REC_EstablishStaticConfigInteger(cache_config_admission_sketch_size, "proxy.config.cache.admission.sketch_size");
+
   REC_EstablishStaticConfigInt32(cache_config_enable_checksum, "proxy.config.cache.enable_checksum");
   Debug("cache_init", "proxy.config.cache.enable_checksum = %d", cache_config_enable_checksum);
 
@@ -3318,6 +3429,15 @@ CacheProcessor::open_write(Continuation *cont, int expected_size, const HttpCach
   return caches[type]->open_write(cont, &key->hash, old_info, pin_in_cache, NULL /* key1 */, type, key->hostname, key->hostlen);
 }
 
+//----------------------------------------------------------------------------
+bool
+CacheProcessor::admit(const HttpCacheKey *key, int64_t size, CacheFragType type)
+{
+  if (!IsCacheReady(type))
+    return true;
+  return cacheAdmission.admit(&key->hash, caches[type]->key_to_vol(&key->hash, key->hostname, key->hostlen), size);
+}
+
 //----------------------------------------------------------------------------
 // Note: this should not be called from from the cluster processor, or bad
 // recursion could occur. This is merely a convenience wrapper.
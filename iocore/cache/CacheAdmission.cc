@@ -0,0 +1,98 @@
+/** @file
+
+  Frequency based admission of new objects to the cache
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+CacheAdmission cacheAdmission;
+
+void
+CacheAdmission::init(Cache *cache ATS_UNUSED)
+{
+  extern ConfigVolumes config_volumes;
+
+  for (ConfigVol *config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
+    if (config_vol->cachep)
+      config_vol->cachep->admission = config_vol->admission;
+  }
+
+  if (cache_config_admission_sketch_size <= 0)
+    return;
+  width = 1;
+  while (width < cache_config_admission_sketch_size)
+    width <<= 1;
+  counters = (uint8_t *)ats_malloc(width * CACHE_ADMISSION_DEPTH);
+  memset(counters, 0, width * CACHE_ADMISSION_DEPTH);
+  Debug("cache_init", "cache admission sketch of %d x %" PRId64 " counters", CACHE_ADMISSION_DEPTH, width);
+}
+
+bool
+CacheAdmission::filtered(Vol *vol) const
+{
+  if (!counters || !vol)
+    return false;
+  if (vol->cache_vol->admission)
+    return vol->cache_vol->admission > 0;
+  return cache_config_admission_enabled != 0;
+}
+
+// Count a miss of the key and decide whether the new object is written.
+bool
+CacheAdmission::admit(const CacheKey *key, Vol *vol, int64_t size)
+{
+  if (!filtered(vol))
+    return true;
+
+  uint8_t *c[CACHE_ADMISSION_DEPTH];
+  uint64_t h = key->slice64(0), step = key->slice64(1) | 1;
+  int count = 255;
+
+  for (int i = 0; i < CACHE_ADMISSION_DEPTH; i++) {
+    c[i] = counters + i * width + ((h + i * step) & (width - 1));
+    if (*c[i] < count)
+      count = *c[i];
+  }
+  // conservative update, only the counters holding the estimate grow
+  if (count < 255) {
+    for (int i = 0; i < CACHE_ADMISSION_DEPTH; i++) {
+      if (*c[i] == count)
+        ++*c[i];
+    }
+    ++count;
+  }
+  if (ink_atomic_increment(&samples, (int64_t)1) == width) {
+    for (int64_t i = 0; i < width * CACHE_ADMISSION_DEPTH; i++)
+      counters[i] >>= 1;
+    samples = 0;
+  }
+
+  if (size < 0) // chunked or otherwise unknown length
+    size = 0;
+  if (count >= cache_config_admission_min_hits) {
+    CACHE_SUM_DYN_STAT_THREAD(cache_admission_admitted_stat, 1);
+    CACHE_SUM_DYN_STAT_THREAD(cache_admission_admitted_bytes_stat, size);
+    return true;
+  }
+  CACHE_SUM_DYN_STAT_THREAD(cache_admission_rejected_stat, 1);
+  CACHE_SUM_DYN_STAT_THREAD(cache_admission_rejected_bytes_stat, size);
+  return false;
+}
@@ -58,11 +58,6 @@ Dir empty_dir;
 
 // OpenDir
 
-OpenDir::OpenDir()
-{
-  SET_HANDLER(&OpenDir::signal_readers);
-}
-
 /*
    If allow_if_writers is false, open_write fails if there are other writers.
    max_writers sets the maximum number of concurrent writers that are
@@ -105,31 +100,6 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
   return 1;
 }
 
-int
-OpenDir::signal_readers(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
-{
-  Queue<CacheVC, Link_CacheVC_opendir_link> newly_delayed_readers;
-  EThread *t = mutex->thread_holding;
-  CacheVC *c = NULL;
-  while ((c = delayed_readers.dequeue())) {
-    CACHE_TRY_LOCK(lock, c->mutex, t);
-    if (lock.is_locked()) {
-      c->f.open_read_timeout = 0;
-      c->handleEvent(EVENT_IMMEDIATE, 0);
-      continue;
-    }
-    newly_delayed_readers.push(c);
-  }
-  if (newly_delayed_readers.head) {
-    delayed_readers = newly_delayed_readers;
-    EThread *t1 = newly_delayed_readers.head->mutex->thread_holding;
-    if (!t1)
-      t1 = mutex->thread_holding;
-    t1->schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
-  }
-  return 0;
-}
-
 int
 OpenDir::close_write(CacheVC *cont)
 {
@@ -140,8 +110,7 @@ OpenDir::close_write(CacheVC *cont)
     unsigned int h = cont->first_key.slice32(0);
     int b = h % OPEN_DIR_BUCKETS;
     bucket[b].remove(cont->od);
-    delayed_readers.append(cont->od->readers);
-    signal_readers(0, 0);
+    cont->od->wake_readers();
     cont->od->vector.clear();
     THREAD_FREE(cont->od, openDirEntryAllocator, cont->mutex->thread_holding);
   }
@@ -164,13 +133,35 @@ int
 OpenDirEntry::wait(CacheVC *cont, int msec)
 {
   ink_assert(cont->vol->mutex->thread_holding == this_ethread());
-  cont->f.open_read_timeout = 1;
-  ink_assert(!cont->trigger);
+  ink_assert(!cont->trigger && !cont->wait_od);
   cont->trigger = cont->vol->mutex->thread_holding->schedule_in_local(cont, HRTIME_MSECONDS(msec));
+  cont->wait_od = this;
   readers.push(cont);
   return EVENT_CONT;
 }
 
+// Called by a writer with the vol lock held whenever it made progress. The
+// waiting readers are rescheduled rather than called so that they never run
+// inside the writer, each on the thread its timeout was set on. A reader whose
+// lock is busy is left to its timeout.
+void
+OpenDirEntry::wake_readers()
+{
+  EThread *t = this_ethread();
+  CacheVC *c = NULL;
+  while ((c = readers.pop())) {
+    ink_assert(c->wait_od == this);
+    c->wait_od = NULL;
+    CACHE_TRY_LOCK(lock, c->mutex, t);
+    if (lock.is_locked() && c->trigger) {
+      EThread *ct = c->trigger->ethread;
+      c->cancel_trigger();
+      c->writer_lock_retry = 0; // only a writer making no progress counts
+      c->trigger = ct->schedule_imm(c, EVENT_INTERVAL);
+    }
+  }
+}
+
 //
 // Cache Directory
 //
@@ -210,6 +201,7 @@ dir_init_segment(int s, Vol *d)
   d->header->freelist[s] = 0;
   Dir *seg = dir_segment(s, d);
   int l, b;
+  vol_dir_segment_dirty(d, s);
   memset(seg, 0, SIZEOF_DIR * DIR_DEPTH * d->buckets);
   for (l = 1; l < DIR_DEPTH; l++) {
     for (b = 0; b < d->buckets; b++) {
@@ -292,6 +284,7 @@ unlink_from_freelist(Dir *e, int s, Vol *d)
 {
   Dir *seg = dir_segment(s, d);
   Dir *p = dir_from_offset(dir_prev(e), seg);
+  vol_dir_segment_dirty(d, s);
   if (p)
     dir_set_next(p, dir_next(e));
   else
@@ -307,6 +300,7 @@ dir_delete_entry(Dir *e, Dir *p, int s, Vol *d)
   Dir *seg = dir_segment(s, d);
   int no = dir_next(e);
   d->header->dirty = 1;
+  vol_dir_segment_dirty(d, s);
   if (p) {
     unsigned int fo = d->header->freelist[s];
     unsigned int eo = dir_to_offset(e, seg);
@@ -436,6 +430,7 @@ freelist_pop(int s, Vol *d)
     return NULL;
   }
   d->header->freelist[s] = dir_next(e);
+  vol_dir_segment_dirty(d, s);
   // if the freelist if bad, punt.
   if (dir_offset(e)) {
     dir_init_segment(s, d);
@@ -497,6 +492,7 @@ dir_free_entry(Dir *e, int s, Vol *d)
   Dir *seg = dir_segment(s, d);
   unsigned int fo = d->header->freelist[s];
   unsigned int eo = dir_to_offset(e, seg);
+  vol_dir_segment_dirty(d, s);
   dir_set_next(e, fo);
   if (fo)
     dir_set_prev(dir_from_offset(fo, seg), eo);
@@ -616,6 +612,7 @@ Lfill:
          key->slice32(1), dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   d->header->dirty = 1;
+  vol_dir_segment_dirty(d, s);
   CACHE_INC_DIR_USED(d->mutex);
   return 1;
 }
@@ -689,6 +686,7 @@ Lfill:
          bi, e, t, dir_tag(e), dir_offset(e));
   CHECK_DIR(d);
   d->header->dirty = 1;
+  vol_dir_segment_dirty(d, s);
   return res;
 }
 
@@ -856,11 +854,75 @@ CacheSync::aio_write(int fd, char *b, int n, off_t o)
   io.aiocb.aio_offset = o;
   io.aiocb.aio_nbytes = n;
   io.aiocb.aio_buf = b;
+  io.aiocb.aio_reqprio = AIO_BACKGROUND_PRIORITY;
   io.action = this;
   io.thread = AIO_CALLBACK_THREAD_ANY;
   ink_assert(ink_aio_write(&io) >= 0);
 }
 
+// byte range of segment s in a directory copy, rounded out to store blocks
+static inline off_t
+dir_segment_sync_start(Vol *d, int s)
+{
+  return ROUND_DOWN_TO_STORE_BLOCK(vol_headerlen(d) + (off_t)s * d->buckets * DIR_DEPTH * SIZEOF_DIR);
+}
+
+static inline off_t
+dir_segment_sync_end(Vol *d, int s)
+{
+  return ROUND_TO_STORE_BLOCK(vol_headerlen(d) + (off_t)(s + 1) * d->buckets * DIR_DEPTH * SIZEOF_DIR);
+}
+
+/* Take the segments directory copy 'copy' is missing, those changed since
+   it was last written, and snapshot them along with the header and the
+   footer. The rest of that copy on disk already matches memory.
+*/
+void
+CacheSync::copy_segments(Vol *vol, int copy)
+{
+  int words = (vol->segments + 63) / 64;
+  int footerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+  size_t dirlen = vol_dirlen(vol);
+
+  if (segments_len < words) {
+    ats_free(segments);
+    segments = (uint64_t *)ats_malloc(words * sizeof(uint64_t));
+    segments_len = words;
+  }
+  memcpy(segments, vol->dir_dirty[copy], words * sizeof(uint64_t));
+  memset(vol->dir_dirty[copy], 0, words * sizeof(uint64_t));
+
+  memcpy(buf, vol->raw_dir, vol_headerlen(vol));
+  memcpy(buf + dirlen - footerlen, vol->raw_dir + dirlen - footerlen, footerlen);
+  for (int s = 0; s < vol->segments; s++) {
+    if (segments[s >> 6] & ((uint64_t)1 << (s & 63))) {
+      off_t o = dir_segment_sync_start(vol, s);
+      memcpy(buf + o, vol->raw_dir + o, dir_segment_sync_end(vol, s) - o);
+    }
+  }
+}
+
+// find the next run of changed segments at or after writepos
+bool
+CacheSync::next_segments(Vol *vol, off_t *o, int *l)
+{
+  int s = 0, e;
+
+  while (s < vol->segments && (!(segments[s >> 6] & ((uint64_t)1 << (s & 63))) || dir_segment_sync_end(vol, s) <= writepos))
+    s++;
+  if (s >= vol->segments)
+    return false;
+  *o = dir_segment_sync_start(vol, s);
+  if (*o < writepos)
+    *o = writepos;
+  for (e = s + 1; e < vol->segments && (segments[e >> 6] & ((uint64_t)1 << (e & 63))); e++) {
+    if (dir_segment_sync_end(vol, e) - *o > SYNC_MAX_WRITE)
+      break;
+  }
+  *l = dir_segment_sync_end(vol, e - 1) - *o;
+  return true;
+}
+
 uint64_t
 dir_entries_used(Vol *d)
 {
@@ -926,6 +988,20 @@ sync_cache_dir_on_shutdown(void)
     // check if we have data in the agg buffer
     // dont worry about the cachevc s in the agg queue
     // directories have not been inserted for these writes
+    if (d->header->agg_pos != d->header->write_pos) {
+      // an aggregation write is still in flight, write it out again ahead
+      // of the buffer being filled behind it
+      Debug("cache_dir_sync", "Dir %s: flushing agg buffer in flight", d->hash_text.get());
+      int n = d->header->agg_pos - d->header->write_pos;
+      int r = pwrite(d->fd, d->agg_write_buffer, n, d->header->write_pos);
+      if (r != n) {
+        ink_assert(!"flusing agg buffer failed");
+        continue;
+      }
+      d->header->last_write_pos = d->header->write_pos;
+      d->header->write_pos = d->header->agg_pos;
+      d->header->write_serial++;
+    }
     if (d->agg_buf_pos) {
       Debug("cache_dir_sync", "Dir %s: flushing agg buffer first", d->hash_text.get());
 
@@ -1024,8 +1100,11 @@ Lrestart:
     // AIO Thread
     if (io.aio_result != (int64_t)io.aiocb.aio_nbytes) {
       Warning("vol write error during directory sync '%s'", gvol[vol_idx]->hash_text.get());
+      // the segments have to go out again, hand them back under the volume lock
+      write_error = true;
       event = EVENT_NONE;
-      goto Ldone;
+      trigger = eventProcessor.schedule_imm(this);
+      return EVENT_CONT;
     }
     CACHE_SUM_DYN_STAT(cache_directory_sync_bytes_stat, io.aio_result);
 
@@ -1039,6 +1118,15 @@ Lrestart:
       return EVENT_CONT;
     }
 
+    if (write_error) {
+      uint64_t *dirty = vol->dir_dirty[vol->header->sync_serial & 1];
+      for (int i = 0; i < (vol->segments + 63) / 64; i++)
+        dirty[i] |= segments[i];
+      write_error = false;
+      event = EVENT_NONE;
+      goto Ldone;
+    }
+
     if (!vol->dir_sync_in_progress)
       start_time = Thread::get_hrtime();
 
@@ -1063,6 +1151,8 @@ Lrestart:
         Debug("cache_dir_sync", "Dir %s not dirty", vol->hash_text.get());
         goto Ldone;
       }
+      // aggWrite() stops filling the agg buffer while this waits, so at
+      // most the write in flight and the buffer filled before it are waited for.
       if (vol->is_io_in_progress() || vol->agg_buf_pos) {
         Debug("cache_dir_sync", "Dir %s: waiting for agg buffer", vol->hash_text.get());
         vol->dir_sync_waiting = 1;
@@ -1093,25 +1183,24 @@ Lrestart:
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
       CHECK_DIR(d);
-      memcpy(buf, vol->raw_dir, dirlen);
+      copy_segments(vol, vol->header->sync_serial & 1);
       vol->dir_sync_in_progress = 1;
     }
     size_t B = vol->header->sync_serial & 1;
     off_t start = vol->skip + (B ? dirlen : 0);
+    off_t o;
+    int l;
 
     if (!writepos) {
-      // write header
-      aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
-      writepos += headerlen;
-    } else if (writepos < (off_t)dirlen - headerlen) {
-      // write part of body
-      int l = SYNC_MAX_WRITE;
-      if (writepos + l > (off_t)dirlen - headerlen)
-        l = dirlen - headerlen - writepos;
-      aio_write(vol->fd, buf + writepos, l, start + writepos);
-      writepos += l;
+      // write header, along with the segment freelists
+      aio_write(vol->fd, buf, vol_headerlen(vol), start);
+      writepos += vol_headerlen(vol);
+    } else if (writepos < (off_t)dirlen - headerlen && next_segments(vol, &o, &l)) {
+      // write the next run of changed segments
+      aio_write(vol->fd, buf + o, l, start + o);
+      writepos = o + l;
     } else if (writepos < (off_t)dirlen) {
-      ink_assert(writepos == (off_t)dirlen - headerlen);
+      writepos = dirlen - headerlen;
       // write footer
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
@@ -425,7 +425,8 @@ CacheHostRecord::Init(CacheType typ)
   num_cachevols = 0;
   CacheVol *cachep = cp_list.head;
   for (; cachep; cachep = cachep->link.next) {
-    if (cachep->scheme == type) {
+    // the fast tier only holds copies promoted from the other volumes
+    if (cachep->scheme == type && cachep->vol_number != cache_config_tier_volume) {
       Debug("cache_hosting", "Host Record: %p, Volume: %d, size: %" PRId64, this, cachep->vol_number, (int64_t)cachep->size);
       cp[num_cachevols] = cachep;
       num_cachevols++;
@@ -629,6 +630,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
   CacheType scheme = CACHE_NONE_TYPE;
   int size = 0;
   int in_percent = 0;
+  int admission = 0;
   const char *matcher_name = "[CacheVolition]";
 
   memset(volume_seen, 0, sizeof(volume_seen));
@@ -666,6 +668,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
         }
         configp->scheme = scheme;
         configp->size = size;
+        configp->admission = admission;
         configp->cachep = NULL;
         cp_queue.enqueue(configp);
         num_volumes++;
@@ -733,6 +736,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
         volume_seen[volume_number] = 1;
         while (ParseRules::is_digit(*tmp))
           tmp++;
+        admission = 0;
         state = PAIR_ONE;
         break;
 
@@ -784,6 +788,25 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           in_percent = 0;
         state = DONE;
         break;
+
+      case DONE:
+        // optional, overrides proxy.config.cache.admission.enabled
+        if (strcasecmp(tmp, "admission")) {
+          state = INK_ERROR;
+          break;
+        }
+        tmp += 10; // size of string admission including null
+
+        if (!strcasecmp(tmp, "true")) {
+          tmp += 4;
+          admission = 1;
+        } else if (!strcasecmp(tmp, "false")) {
+          tmp += 5;
+          admission = -1;
+        } else {
+          state = INK_ERROR;
+        }
+        break;
       }
 
       if (state == INK_ERROR || *tmp) {
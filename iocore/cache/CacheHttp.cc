@@ -161,6 +161,25 @@ CacheHTTPInfoVector::print(char *buffer, size_t buf_size, bool temps)
   }
 }
 
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+int
+CacheHTTPInfoVector::find_variant(CacheHTTPInfo *info)
+{
+  uint64_t vary_key, variant_key, alt_vary_key, alt_variant_key;
+
+  if (!HttpTransactCache::calculate_variant_key(info->request_get(), info->response_get(), &vary_key, &variant_key))
+    return -1;
+  for (int i = 0; i < xcount; i++) {
+    CacheHTTPInfo *alt = &data[i].alternate;
+    if (HttpTransactCache::calculate_variant_key(alt->request_get(), alt->response_get(), &alt_vary_key, &alt_variant_key) &&
+        alt_vary_key == vary_key && alt_variant_key == variant_key)
+      return i;
+  }
+  return -1;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -311,6 +330,16 @@ CacheHTTPInfoVector::print(char * /* buffer ATS_UNUSED */, size_t /* buf_size AT
   ink_assert(0);
 }
 
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+int
+CacheHTTPInfoVector::find_variant(CacheHTTPInfo * /* info ATS_UNUSED */)
+{
+  ink_assert(0);
+  return -1;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
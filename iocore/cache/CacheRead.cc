@@ -103,20 +103,31 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   ink_assert(caches[type] == this);
 
   Vol *vol = key_to_vol(key, hostname, host_len);
+  Vol *home = NULL;
   Dir result, *last_collision = NULL;
   ProxyMutex *mutex = cont->mutex;
   OpenDirEntry *od = NULL;
   CacheVC *c = NULL;
 
+  if (Vol *tier = cacheTier.promoted_vol(key)) {
+    home = vol;
+    vol = tier;
+  }
+
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
-    if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
+    if (!lock.is_locked() || (od = vol->open_read(key)) ||
+        (home ? cacheTier.probe(key, vol, &result) : dir_probe(key, vol, &result, &last_collision))) {
       c = new_CacheVC(cont);
       c->first_key = c->key = c->earliest_key = *key;
       c->vol = vol;
+      c->tier_home = home;
       c->vio.op = VIO::READ;
       c->base_stat = cache_read_active_stat;
       CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+      if (home) {
+        CACHE_INCREMENT_DYN_STAT(cache_tier_read_stat);
+      }
       c->request.copy_shallow(request);
       c->frag_type = CACHE_FRAG_TYPE_HTTP;
       c->params = params;
@@ -145,6 +156,8 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
     }
   }
 Lmiss:
+  if (home) // the fast tier copy is gone and forgotten, try the home volume
+    return open_read(cont, key, request, params, type, hostname, host_len);
   CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
   cont->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NO_DOC);
   return ACTION_RESULT_DONE;
@@ -222,6 +235,9 @@ CacheVC::openReadChooseWriter(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSE
     for (w = (CacheVC *)od->writers.head; w; w = (CacheVC *)w->opendir_link.next) {
       if (w->start_time > start_time || w->closed < 0)
         continue;
+      // a partial writer does not write the object in order
+      if (w->f.partial || (w->alternate.valid() && w->alternate.is_partial()))
+        continue;
       if (!w->closed && !cache_config_read_while_writer) {
         return -err;
       }
@@ -309,13 +325,15 @@ CacheVC::openReadFromWriter(int event, Event *e)
 #ifndef READ_WHILE_WRITER
   return openReadFromWriterFailure(CACHE_EVENT_OPEN_READ_FAILED, (Event *)-err);
 #else
+  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  if (!lock.is_locked())
+    VC_SCHED_LOCK_RETRY();
+  cancel_writer_wait();
   if (_action.cancelled) {
+    MUTEX_RELEASE(lock);
     od = NULL; // only open for read so no need to close
     return free_CacheVC(this);
   }
-  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
-  if (!lock.is_locked())
-    VC_SCHED_LOCK_RETRY();
   od = vol->open_read(&first_key); // recheck in case the lock failed
   if (!od) {
     MUTEX_RELEASE(lock);
@@ -527,6 +545,7 @@ CacheVC::openReadClose(int event, Event * /* e ATS_UNUSED */)
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked())
     VC_SCHED_LOCK_RETRY();
+  cancel_writer_wait();
   if (f.hit_evacuate && dir_valid(vol, &first_dir) && closed > 0) {
     if (f.single_fragment)
       vol->force_evacuate_head(&first_dir, dir_pinned(&first_dir));
@@ -552,6 +571,7 @@ CacheVC::openReadReadDone(int event, Event *e)
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
     if (!lock.is_locked())
       VC_SCHED_LOCK_RETRY();
+    cancel_writer_wait();
     if (event == AIO_EVENT_DONE && !io.ok()) {
       dir_delete(&earliest_key, vol, &earliest_dir);
       goto Lerror;
@@ -604,6 +624,12 @@ CacheVC::openReadReadDone(int event, Event *e)
   }
 Lerror:
   char tmpstring[100];
+#ifdef HTTP_CACHE
+  if (f.partial) {
+    DDebug("cache_partial", "%p: fragment %d of partial %s is gone", this, fragment + 1, earliest_key.toHexStr(tmpstring));
+    return calluser(VC_EVENT_ERROR);
+  }
+#endif
   Warning("Document %s truncated", earliest_key.toHexStr(tmpstring));
   return calluser(VC_EVENT_ERROR);
 Ldone:
@@ -626,6 +652,25 @@ CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   int64_t ntodo = vio.ntodo();
   int64_t bytes = doc->len - doc_pos;
   IOBufferBlock *b = NULL;
+#ifdef HTTP_CACHE
+  if (f.partial_seek) {
+    // nothing of a partial object has been read, go straight to the
+    // fragment holding the first byte wanted
+    if (ntodo <= 0)
+      return EVENT_CONT;
+    if (seek_to >= doc_len) {
+      vio.ndone = doc_len;
+      return calluser(VC_EVENT_EOS);
+    }
+    int target = alternate.get_frag_index(seek_to);
+    key = earliest_key;
+    for (fragment = 0; fragment < target; fragment++)
+      next_CacheKey(&key, &key);
+    --fragment; // LreadMain counts the fragment read
+    f.partial_seek = 0;
+    goto Lread;
+  }
+#endif
   if (seek_to) { // handle do_io_pread
     if (seek_to >= doc_len) {
       vio.ndone = doc_len;
@@ -740,6 +785,7 @@ Lread : {
     SET_HANDLER(&CacheVC::openReadMain);
     VC_SCHED_LOCK_RETRY();
   }
+  cancel_writer_wait();
   if (dir_probe(&key, vol, &dir, &last_collision)) {
     SET_HANDLER(&CacheVC::openReadReadDone);
     int ret = do_read_call(&key);
@@ -763,12 +809,21 @@ Lread : {
     SET_HANDLER(&CacheVC::openReadMain);
     VC_SCHED_WRITER_RETRY();
   }
+#ifdef HTTP_CACHE
+  if (f.partial) {
+    // only some fragments of a partial object are stored
+    DDebug("cache_partial", "%p: partial %X missing fragment %d", this, first_key.slice32(1), fragment + 1);
+    goto Lerror;
+  }
+#endif
   if (is_action_tag_set("cache"))
     ink_release_assert(false);
   Warning("Document %X truncated at %d of %d, missing fragment %X", first_key.slice32(1), (int)vio.ndone, (int)doc_len,
           key.slice32(1));
   // remove the directory entry
   dir_delete(&earliest_key, vol, &earliest_dir);
+  if (tier_home)
+    cacheTier.forget(&first_key);
 }
 Lerror:
   return calluser(VC_EVENT_ERROR);
@@ -850,7 +905,8 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
 // read has detected that alternate does not exist in the cache.
 // rewrite the vector.
 #ifdef HTTP_CACHE
-    if (!f.read_from_writer_called && frag_type == CACHE_FRAG_TYPE_HTTP) {
+    // the fast tier copy is never rewritten, its home volume has the object
+    if (!f.read_from_writer_called && frag_type == CACHE_FRAG_TYPE_HTTP && !tier_home) {
       // don't want any writers while we are evacuating the vector
       if (!vol->open_write(this, false, 1)) {
         Doc *doc1 = (Doc *)first_buf->data();
@@ -907,6 +963,8 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
     if (od)
       vol->close_write(this);
   }
+  if (tier_home)
+    return tierReadFallback();
   CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
   _action.continuation->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NO_DOC);
   return free_CacheVC(this);
@@ -1103,6 +1161,29 @@ CacheVC::openReadStartHead(int event, Event *e)
 #endif
               );
     }
+#ifdef HTTP_CACHE
+    if (frag_type == CACHE_FRAG_TYPE_HTTP && alternate.is_partial()) {
+      // there is no earliest fragment to check, the fragments of a partial
+      // object are looked up when the reader seeks.
+      f.partial = 1;
+      f.partial_seek = 1;
+      earliest_key = key;
+      dir_clear(&earliest_dir);
+      first_buf = buf;
+      doc_pos = doc->len;
+      if (!request.valid() || !request.get_single_range(doc_len, &range_start, &range_end))
+        goto Lsuccess;
+      fragment = alternate.get_frag_index(range_start);
+      for (int i = 0; i < fragment; i++)
+        next_CacheKey(&key, &key);
+      last_collision = NULL;
+      buf = new_IOBufferData(iobuffer_size_to_index(CACHE_BLOCK_SIZE, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+      goto Lverify;
+    }
+    if (cacheTier.enabled() && !tier_home && frag_type == CACHE_FRAG_TYPE_HTTP)
+      cacheTier.hit(this);
+#endif
+
     // the first fragment might have been gc'ed. Make sure the first
     // fragment is there before returning CACHE_EVENT_OPEN_READ
     if (!f.single_fragment)
@@ -1121,6 +1202,17 @@ CacheVC::openReadStartHead(int event, Event *e)
     goto Lsuccess;
 
   Lread:
+    if (tier_home) {
+      // a promoted object has exactly one vector in the fast tier
+      if (!buf && cacheTier.probe(&key, vol, &dir)) {
+        first_dir = dir;
+        int ret = do_read_call(&key);
+        if (ret == EVENT_RETURN)
+          goto Lcallreturn;
+        return ret;
+      }
+      goto Ldone;
+    }
     // check for collision
     // INKqa07684 - Cache::lookup returns CACHE_EVENT_OPEN_READ_FAILED.
     // don't want to go through this BS of reading from a writer if
@@ -1146,6 +1238,8 @@ CacheVC::openReadStartHead(int event, Event *e)
     }
   }
 Ldone:
+  if (tier_home && err != ECACHE_ALT_MISS)
+    return tierReadFallback();
   if (!f.lookup) {
     CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
     _action.continuation->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-err);
@@ -1170,4 +1264,88 @@ Learliest:
   last_collision = NULL;
   SET_HANDLER(&CacheVC::openReadStartEarliest);
   return openReadStartEarliest(event, e);
+#ifdef HTTP_CACHE
+Lverify:
+  SET_HANDLER(&CacheVC::openReadVerifyRange);
+  return openReadVerifyRange(event, e);
+#endif
+}
+
+#ifdef HTTP_CACHE
+/*
+   The directory only hints at which fragments of a partial alternate are
+   stored: a tag can match a fragment of another object, and the fragments
+   are not evacuated, so the write cursor overwrites them as it wraps. Before
+   the open completes, check the Doc key of each fragment of the range in the
+   request, reading just the Doc header, so that is_range_cached() does not
+   promise a range a reader then fails to read.
+   - fragment, key. The fragment being checked.
+   - last_collision. The directory entry whose Doc header is in buf, if any.
+   */
+int
+CacheVC::openReadVerifyRange(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  set_io_not_in_progress();
+  if (_action.cancelled)
+    return free_CacheVC(this);
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked())
+      VC_SCHED_LOCK_RETRY();
+    int last = alternate.get_frag_index(range_end);
+    for (;;) {
+      if (last_collision) {
+        Doc *doc = (Doc *)buf->data();
+        if (io.ok() && dir_valid(vol, &dir) && doc->magic == DOC_MAGIC && doc->key == key) {
+          if (fragment == last) {
+            f.partial_range = 1;
+            break;
+          }
+          ++fragment;
+          next_CacheKey(&key, &key);
+          last_collision = NULL;
+        } else if (dir_offset(&dir) != dir_offset(last_collision)) {
+          last_collision = NULL; // overwritten
+        }
+      }
+      if (!dir_probe(&key, vol, &dir, &last_collision)) {
+        DDebug("cache_partial", "%p: partial %X fragment %d not stored", this, first_key.slice32(1), fragment);
+        break;
+      }
+      if (dir_agg_buf_valid(vol, &dir)) {
+        off_t o = vol_offset(vol, &dir);
+        if (o < vol->header->agg_pos)
+          memcpy(buf->data(), vol->agg_write_buffer + (o - vol->header->write_pos), sizeof(Doc));
+        else
+          memcpy(buf->data(), vol->agg_buffer + (o - vol->header->agg_pos), sizeof(Doc));
+        io.aiocb.aio_nbytes = sizeof(Doc);
+        io.aio_result = sizeof(Doc);
+        continue;
+      }
+      io.aiocb.aio_fildes = vol->fd;
+      io.aiocb.aio_offset = vol_offset(vol, &dir);
+      io.aiocb.aio_nbytes = CACHE_BLOCK_SIZE;
+      io.aiocb.aio_buf = buf->data();
+      io.action = this;
+      io.thread = mutex->thread_holding->tt == DEDICATED ? AIO_CALLBACK_THREAD_ANY : mutex->thread_holding;
+      ink_assert(ink_aio_read(&io) >= 0);
+      return EVENT_CONT;
+    }
+  }
+  DDebug("cache_partial", "%p: partial %X bytes %" PRId64 "-%" PRId64 " %s", this, first_key.slice32(1), range_start, range_end,
+         f.partial_range ? "stored" : "not stored");
+  buf = first_buf;
+  last_collision = NULL;
+  SET_HANDLER(&CacheVC::openReadMain);
+  return callcont(CACHE_EVENT_OPEN_READ);
 }
+
+bool
+CacheVC::is_range_cached(int64_t start, int64_t end)
+{
+  if (!f.partial)
+    return true;
+  return f.partial_range && start >= range_start && end <= range_end;
+}
+#endif
@@ -392,6 +392,182 @@ EXCLUSIVE_REGRESSION_TEST(cache)(RegressionTest *t, int /* atype ATS_UNUSED */,
   return;
 }
 
+#ifdef HTTP_CACHE
+// The fragment size of objects written by the partial range test
+static int64_t
+partial_test_frag_size()
+{
+  return cache_config_target_fragment_size - sizeofDoc;
+}
+
+// A GET of url, for bytes first to last if last is not negative
+static void
+partial_test_request(HTTPHdr *request, const char *url, int64_t first, int64_t last)
+{
+  char buf[1024];
+  const char *s = buf;
+  HTTPParser parser;
+
+  if (last >= 0)
+    snprintf(buf, sizeof(buf), "GET %s HTTP/1.1\r\nRange: bytes=%" PRId64 "-%" PRId64 "\r\n\r\n", url, first, last);
+  else
+    snprintf(buf, sizeof(buf), "GET %s HTTP/1.1\r\n\r\n", url);
+  http_parser_init(&parser);
+  request->create(HTTP_TYPE_REQUEST);
+  request->parse_req(&parser, &s, s + strlen(s), true);
+  http_parser_clear(&parser);
+}
+
+// The key of fragment i of the partial object being read by vc
+static CacheKey
+partial_test_frag_key(CacheVConnection *vc, int i)
+{
+  CacheKey key = ((CacheVC *)vc)->earliest_key;
+
+  while (i-- > 0)
+    next_CacheKey(&key, &key);
+  return key;
+}
+
+/*
+   A partially cached object of 4 fragments with the first 2 stored. A range
+   is only cached if the Doc of each of its fragments is, a directory entry
+   of a missing fragment which points at another Doc (a tag collision) must
+   not make it look cached.
+   */
+EXCLUSIVE_REGRESSION_TEST(cache_partial_range)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+
+  EThread *thread = this_ethread();
+  int64_t frag = partial_test_frag_size();
+
+  CACHE_SM(t, partial_write_test,
+           {
+             partial_test_request(&request, urlstr, 0, nbytes - 1);
+             Cache::generate_key(&http_key, request.url_get());
+             cacheProcessor.open_write(this, 0, &http_key, false, &request, NULL);
+           } HTTPHdr request;
+           HttpCacheKey http_key; ~CacheTestSM__partial_write_test() { request.destroy(); } int open_write_callout() {
+             HTTPHdr response;
+             HTTPParser parser;
+             char buf[256];
+             const char *s = buf;
+
+             snprintf(buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: %" PRId64 "\r\nETag: \"partial\"\r\n\r\n", total_size);
+             http_parser_init(&parser);
+             response.create(HTTP_TYPE_RESPONSE);
+             response.parse_resp(&parser, &s, s + strlen(s), true);
+             http_parser_clear(&parser);
+             info.create();
+             info.request_set(&request);
+             info.response_set(&response);
+             response.destroy();
+             cache_vc->set_http_info(&info);
+             if (!cache_vc->set_partial_write(0, total_size))
+               return -1;
+             cvio = cache_vc->do_io_write(this, nbytes, buffer_reader);
+             return 1;
+           });
+  partial_write_test.expect_initial_event = CACHE_EVENT_OPEN_WRITE;
+  partial_write_test.expect_event = VC_EVENT_WRITE_COMPLETE;
+  partial_write_test.total_size = 4 * frag;
+  partial_write_test.nbytes = 2 * frag;
+  rand_CacheKey(&partial_write_test.key, thread->mutex);
+  snprintf(partial_write_test.urlstr, sizeof(partial_write_test.urlstr), "http://127.0.0.1/cache_partial_range/%" PRIx64,
+           partial_write_test.key.slice64(0));
+
+  // the range of fragment 0 is cached, then fragment 2 gets the directory
+  // entry of fragment 1
+  CACHE_SM(t, partial_read_test,
+           {
+             partial_test_request(&request, urlstr, 0, partial_test_frag_size() - 1);
+             Cache::generate_key(&http_key, request.url_get());
+             cacheProcessor.open_read(this, &http_key, false, &request, &params);
+           } HTTPHdr request;
+           HttpCacheKey http_key; ~CacheTestSM__partial_read_test() { request.destroy(); } int open_read_callout() {
+             int64_t frag = partial_test_frag_size();
+             CacheKey key1 = partial_test_frag_key(cache_vc, 1);
+             CacheKey key2 = partial_test_frag_key(cache_vc, 2);
+             Vol *vol = ((CacheVC *)cache_vc)->vol;
+             Dir dir;
+             Dir *last_collision = NULL;
+
+             if (!cache_vc->is_range_cached(0, frag - 1) || cache_vc->is_range_cached(0, 2 * frag - 1)) {
+               rprintf(t, "cache_partial_range: wrong range cached\n");
+               return -1;
+             }
+             {
+               SCOPED_MUTEX_LOCK(lock, vol->mutex, this_ethread());
+               if (!dir_probe(&key1, vol, &dir, &last_collision)) {
+                 rprintf(t, "cache_partial_range: fragment 1 not stored\n");
+                 return -1;
+               }
+               dir_insert(&key2, vol, &dir);
+             }
+             cvio = cache_vc->do_io_pread(this, nbytes, buffer, 0);
+             return 1;
+           });
+  partial_read_test.expect_initial_event = CACHE_EVENT_OPEN_READ;
+  partial_read_test.expect_event = VC_EVENT_READ_COMPLETE;
+  partial_read_test.nbytes = 100;
+  partial_read_test.key = partial_write_test.key;
+  memcpy(partial_read_test.urlstr, partial_write_test.urlstr, sizeof(partial_read_test.urlstr));
+
+  // the directory has an entry for fragment 2, but its Doc is fragment 1
+  CACHE_SM(t, partial_collision_test,
+           {
+             partial_test_request(&request, urlstr, 2 * partial_test_frag_size(), 3 * partial_test_frag_size() - 1);
+             Cache::generate_key(&http_key, request.url_get());
+             cacheProcessor.open_read(this, &http_key, false, &request, &params);
+           } HTTPHdr request;
+           HttpCacheKey http_key; ~CacheTestSM__partial_collision_test() { request.destroy(); } int open_read_callout() {
+             int64_t frag = partial_test_frag_size();
+             CacheKey key2 = partial_test_frag_key(cache_vc, 2);
+             Vol *vol = ((CacheVC *)cache_vc)->vol;
+             Dir dir;
+             Dir *last_collision = NULL;
+             bool probed;
+
+             {
+               SCOPED_MUTEX_LOCK(lock, vol->mutex, this_ethread());
+               probed = dir_probe(&key2, vol, &dir, &last_collision);
+               if (probed)
+                 dir_delete(&key2, vol, &dir);
+             }
+             if (!probed || cache_vc->is_range_cached(2 * frag, 3 * frag - 1)) {
+               rprintf(t, "cache_partial_range: a tag collision is cached\n");
+               return -1;
+             }
+             cvio = cache_vc->do_io_pread(this, nbytes, buffer, 0);
+             return 1;
+           });
+  partial_collision_test.expect_initial_event = CACHE_EVENT_OPEN_READ;
+  partial_collision_test.expect_event = VC_EVENT_READ_COMPLETE;
+  partial_collision_test.nbytes = 100;
+  partial_collision_test.key = partial_write_test.key;
+  memcpy(partial_collision_test.urlstr, partial_write_test.urlstr, sizeof(partial_collision_test.urlstr));
+
+  CACHE_SM(t, partial_remove_test,
+           {
+             partial_test_request(&request, urlstr, 0, -1);
+             Cache::generate_key(&http_key, request.url_get());
+             cacheProcessor.remove(this, &http_key, false);
+           } HTTPHdr request;
+           HttpCacheKey http_key; ~CacheTestSM__partial_remove_test() { request.destroy(); });
+  partial_remove_test.expect_event = CACHE_EVENT_REMOVE;
+  memcpy(partial_remove_test.urlstr, partial_write_test.urlstr, sizeof(partial_remove_test.urlstr));
+
+  r_sequential(t, partial_write_test.clone(), partial_read_test.clone(), partial_collision_test.clone(),
+               partial_remove_test.clone(), NULL_PTR)
+    ->run(pstatus);
+}
+#endif
+
 void
 force_link_CacheTest()
 {
@@ -631,3 +807,112 @@ REGRESSION_TEST(ram_cache)(RegressionTest *t, int level, int *pstatus)
       *pstatus = REGRESSION_TEST_FAILED;
   }
 }
+
+// A fast tier index without any volumes, enough for the promotion decision.
+static void
+test_tier_init(CacheTier *tier)
+{
+  tier->sets_per_bucket = 1;
+  tier->index_sets = VOL_HASH_TABLE_SIZE;
+  tier->index = (CacheTierEntry *)ats_calloc(tier->index_sets * CACHE_TIER_INDEX_WAYS, sizeof(CacheTierEntry));
+  tier->hits_size = 4;
+  tier->hits = (uint8_t *)ats_calloc(tier->hits_size, 1);
+}
+
+static void
+test_tier_free(CacheTier *tier)
+{
+  ats_free((void *)tier->index);
+  ats_free(tier->hits);
+}
+
+// The key with the given hits slot.
+static CacheKey
+test_tier_key(uint32_t id, uint32_t slot)
+{
+  CacheKey key;
+
+  key.u32[0] = id;
+  key.u32[1] = 0;
+  key.u32[2] = id << DIR_TAG_WIDTH;
+  key.u32[3] = slot;
+  return key;
+}
+
+REGRESSION_TEST(cache_tier_promotion)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  int saved_hits = cache_config_tier_promote_hits;
+  int64_t saved_max_size = cache_config_tier_promote_max_size;
+  CacheTier tier;
+  CacheKey key = test_tier_key(1, 3);
+  Dir dir;
+  bool ok = true;
+
+  test_tier_init(&tier);
+  cache_config_tier_promote_hits = 3;
+  cache_config_tier_promote_max_size = 1 << 20;
+
+  // promoted on the third hit, then counted again from zero
+  ok = ok && !tier.count_hit(&key, 1000) && !tier.count_hit(&key, 1000);
+  ok = ok && tier.count_hit(&key, 1000) && !tier.count_hit(&key, 1000);
+  if (!ok)
+    rprintf(t, "cache_tier_promotion: not promoted on hit %d\n", cache_config_tier_promote_hits);
+
+  // never promoted if too large
+  for (int i = 0; i < 5; i++) {
+    if (tier.count_hit(&key, 2 << 20)) {
+      rprintf(t, "cache_tier_promotion: promoted an object over promote_max_size\n");
+      ok = false;
+    }
+  }
+
+  // nor if already promoted
+  memset((void *)&dir, 0, sizeof(dir));
+  tier.insert(&key, NULL, &dir);
+  for (int i = 0; i < 5; i++) {
+    if (tier.count_hit(&key, 1000)) {
+      rprintf(t, "cache_tier_promotion: promoted an object already in the fast tier\n");
+      ok = false;
+    }
+  }
+
+  cache_config_tier_promote_hits = saved_hits;
+  cache_config_tier_promote_max_size = saved_max_size;
+  test_tier_free(&tier);
+  *pstatus = ok ? REGRESSION_TEST_PASSED : REGRESSION_TEST_FAILED;
+}
+
+REGRESSION_TEST(cache_tier_decay)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  int saved_hits = cache_config_tier_promote_hits;
+  CacheTier tier;
+  CacheKey k = test_tier_key(1, 1), l = test_tier_key(2, 2);
+  bool ok = true;
+
+  test_tier_init(&tier);
+  cache_config_tier_promote_hits = 1000; // never promote
+
+  // hits 0 to 8 count k, and hit 8 ages its slot
+  for (int i = 0; i < 9; i++)
+    tier.count_hit(&k, 1000);
+  if (tier.hits[1] != 4) {
+    rprintf(t, "cache_tier_decay: count %d after 9 hits, expected 4\n", tier.hits[1]);
+    ok = false;
+  }
+  // the other slots are aged before k's is again, at hit 40
+  for (int i = 9; i < 40; i++)
+    tier.count_hit(&l, 1000);
+  if (tier.hits[1] != 4) {
+    rprintf(t, "cache_tier_decay: count %d aged early\n", tier.hits[1]);
+    ok = false;
+  }
+  tier.count_hit(&l, 1000);
+  if (tier.hits[1] != 2) {
+    rprintf(t, "cache_tier_decay: count %d after 41 hits, expected 2\n", tier.hits[1]);
+    ok = false;
+  }
+
+  cache_config_tier_promote_hits = saved_hits;
+  test_tier_free(&tier);
+  *pstatus = ok ? REGRESSION_TEST_PASSED : REGRESSION_TEST_FAILED;
+}
@@ -0,0 +1,437 @@
+/** @file
+
+  Fast tier of the cache, hot objects promoted out of their home volume
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+CacheTier cacheTier;
+
+static inline uint64_t
+tier_fingerprint(const CacheKey *key)
+{
+  return key->slice64(0) | 1;
+}
+
+// Same bucket as Cache::key_to_vol, so a set never spans two stripes.
+static inline uint32_t
+tier_bucket(const CacheKey *key)
+{
+  return (key->slice32(2) >> DIR_TAG_WIDTH) % VOL_HASH_TABLE_SIZE;
+}
+
+void
+CacheTier::init(Cache *cache)
+{
+  extern Queue<CacheVol> cp_list;
+  CacheVol *cp = cp_list.head;
+
+  if (!cache_config_tier_volume)
+    return;
+  for (; cp; cp = cp->link.next) {
+    if (cp->vol_number == cache_config_tier_volume)
+      break;
+  }
+  if (!cp || cp->scheme != cache->scheme || !cp->num_vols) {
+    Warning("cache tier volume %d is not an http volume, the fast tier is disabled", cache_config_tier_volume);
+    return;
+  }
+
+  CacheHostRecord *rec = new CacheHostRecord;
+  rec->type = cache->scheme;
+  rec->num_cachevols = 1;
+  rec->cp = (CacheVol **)ats_malloc(sizeof(CacheVol *));
+  rec->cp[0] = cp;
+  rec->num_vols = cp->num_vols;
+  rec->vols = (Vol **)ats_malloc(cp->num_vols * sizeof(Vol *));
+  memcpy(rec->vols, cp->vols, cp->num_vols * sizeof(Vol *));
+  build_vol_hash_table(rec);
+
+  sets_per_bucket = cache_config_tier_index_size / CACHE_TIER_INDEX_WAYS / VOL_HASH_TABLE_SIZE;
+  if (sets_per_bucket < 1)
+    sets_per_bucket = 1;
+  index_sets = sets_per_bucket * VOL_HASH_TABLE_SIZE;
+  index = (CacheTierEntry *)ats_malloc(index_sets * CACHE_TIER_INDEX_WAYS * sizeof(CacheTierEntry));
+  memset((void *)index, 0, index_sets * CACHE_TIER_INDEX_WAYS * sizeof(CacheTierEntry));
+  hits_size = index_sets * CACHE_TIER_INDEX_WAYS;
+  hits = (uint8_t *)ats_malloc(hits_size);
+  memset(hits, 0, hits_size);
+
+  Note("cache tier: volume %d, %d stripes, %" PRId64 " index entries", cp->vol_number, cp->num_vols,
+       index_sets * CACHE_TIER_INDEX_WAYS);
+  host_rec = rec;
+}
+
+// The stripes of the fast tier changed (a disk failed), which moves keys
+// between stripes. Forget everything rather than read a directory entry of
+// one stripe with the lock of another.
+void
+CacheTier::rebuild()
+{
+  if (!host_rec)
+    return;
+  build_vol_hash_table(host_rec);
+  for (int64_t i = 0; i < index_sets * CACHE_TIER_INDEX_WAYS; i++)
+    index[i].fingerprint = 0;
+}
+
+// The fast tier stripe for a key, whether or not it has been promoted.
+Vol *
+CacheTier::key_to_vol(const CacheKey *key)
+{
+  unsigned short *hash_table = host_rec->vol_hash_table;
+
+  if (!hash_table) // every fast tier disk has failed
+    return NULL;
+  Vol *vol = host_rec->vols[hash_table[tier_bucket(key)]];
+  return DISK_BAD(vol->disk) ? NULL : vol;
+}
+
+CacheTierEntry *
+CacheTier::find(const CacheKey *key)
+{
+  CacheTierEntry *set = index + (tier_bucket(key) * sets_per_bucket + key->slice32(1) % sets_per_bucket) * CACHE_TIER_INDEX_WAYS;
+  uint64_t fp = tier_fingerprint(key);
+
+  for (int i = 0; i < CACHE_TIER_INDEX_WAYS; i++) {
+    if (set[i].fingerprint == fp)
+      return &set[i];
+  }
+  return NULL;
+}
+
+// Lock free hint, the fast tier stripe to read from if the key is promoted.
+Vol *
+CacheTier::promoted_vol(const CacheKey *key)
+{
+  if (!host_rec || !find(key))
+    return NULL;
+  return key_to_vol(key);
+}
+
+// The vector of a promoted object, with the lock of its fast tier stripe held.
+bool
+CacheTier::probe(const CacheKey *key, Vol *vol, Dir *result)
+{
+  CacheTierEntry *e = find(key);
+
+  if (!e)
+    return false;
+  if (!dir_valid(vol, &e->dir)) {
+    // overwritten as the fast tier wrapped
+    ink_atomic_cas(&e->fingerprint, tier_fingerprint(key), (uint64_t)0);
+    return false;
+  }
+  *result = e->dir;
+  return true;
+}
+
+void
+CacheTier::insert(const CacheKey *key, Vol *vol, Dir *dir)
+{
+  CacheTierEntry *set = index + (tier_bucket(key) * sets_per_bucket + key->slice32(1) % sets_per_bucket) * CACHE_TIER_INDEX_WAYS;
+  CacheTierEntry *e = find(key);
+
+  // prefer a free entry, then one overwritten in the fast tier
+  for (int i = 0; !e && i < CACHE_TIER_INDEX_WAYS; i++) {
+    if (!set[i].fingerprint)
+      e = &set[i];
+  }
+  for (int i = 0; !e && i < CACHE_TIER_INDEX_WAYS; i++) {
+    if (!dir_valid(vol, &set[i].dir))
+      e = &set[i];
+  }
+  if (!e)
+    e = &set[key->slice32(3) % CACHE_TIER_INDEX_WAYS];
+  e->dir = *dir;
+  e->fingerprint = tier_fingerprint(key);
+}
+
+void
+CacheTier::forget(const CacheKey *key)
+{
+  CacheTierEntry *e;
+
+  if (host_rec && (e = find(key)))
+    ink_atomic_cas(&e->fingerprint, tier_fingerprint(key), (uint64_t)0);
+}
+
+// A read of an HTTP object from its home volume, with the home volume lock
+// held and the vector in reader->dir.
+void
+CacheTier::hit(CacheVC *reader)
+{
+  if (count_hit(&reader->first_key, reader->doc_len))
+    promote(reader);
+}
+
+// Count a read of an object from its home volume, true if it is now hot
+// enough to be promoted. The counts are approximate, a count changed under
+// another home volume lock at the same time may lose a hit.
+bool
+CacheTier::count_hit(const CacheKey *key, uint64_t doc_len)
+{
+  uint8_t *h = &hits[key->slice32(3) % hits_size];
+  int64_t n = ink_atomic_increment(&hits_seen, (int64_t)1);
+
+  if (*h < 255)
+    ++*h;
+  // age the counts a step at a time so they follow recent popularity
+  if (n % CACHE_TIER_DECAY_HITS == 0)
+    hits[(n / CACHE_TIER_DECAY_HITS) % hits_size] >>= 1;
+  if (*h < cache_config_tier_promote_hits || find(key))
+    return false;
+  if (cache_config_tier_promote_max_size && doc_len > (uint64_t)cache_config_tier_promote_max_size)
+    return false;
+  *h = 0;
+  return true;
+}
+
+void
+CacheTier::promote(CacheVC *reader)
+{
+  Vol *home = reader->vol;
+  Vol *vol = key_to_vol(&reader->first_key);
+
+  // 4.2.0 vectors are fixed up as they are read, based on the stripe version
+  if (!vol || vol == home || (home->header->version.ink_major == 23 && home->header->version.ink_minor == 0))
+    return;
+  if (ink_atomic_increment(&promotions, 1) >= CACHE_TIER_MAX_PROMOTIONS) {
+    ink_atomic_increment(&promotions, -1);
+    return;
+  }
+
+  // The promoter shares the lock of the home volume, like an evacuator.
+  CacheVC *c = new_CacheVC(home);
+  ProxyMutex *mutex = home->mutex;
+  c->vol = vol;
+  c->tier_home = home;
+  c->first_key = c->key = reader->first_key;
+  c->first_dir = c->dir = reader->dir;
+  c->frag_type = CACHE_FRAG_TYPE_HTTP;
+  c->base_stat = cache_tier_promote_active_stat;
+  CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+  SET_CONTINUATION_HANDLER(c, &CacheVC::tierPromoteRead);
+  eventProcessor.schedule_imm(c, ET_CALL);
+}
+
+/*
+  The promoter copies the Docs of an object from its home volume (tier_home)
+  to the fast tier (vol) verbatim, the fragments of every alternate first and
+  the vector last. The handlers other than tierPromoteCopyDone run with the
+  home volume lock held.
+*/
+static int
+tier_promote_free(CacheVC *c)
+{
+  ProxyMutex *mutex = c->mutex;
+  Vol *vol = c->vol;
+
+  if (!c->closed) {
+    CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_FAILURE);
+  }
+  ink_atomic_increment(&cacheTier.promotions, -1);
+  return free_CacheVC(c);
+}
+
+int
+CacheVC::tierPromoteRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  // not on disk yet
+  if (dir_agg_buf_valid(tier_home, &dir))
+    return tier_promote_free(this);
+  io.aiocb.aio_fildes = tier_home->fd;
+  io.aiocb.aio_offset = vol_offset(tier_home, &dir);
+  io.aiocb.aio_nbytes = dir_approx_size(&dir);
+  if ((off_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > (off_t)(tier_home->skip + tier_home->len))
+    io.aiocb.aio_nbytes = tier_home->skip + tier_home->len - io.aiocb.aio_offset;
+  buf = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  io.aiocb.aio_buf = buf->data();
+  io.action = this;
+  io.thread = AIO_CALLBACK_THREAD_ANY;
+  SET_HANDLER(&CacheVC::tierPromoteReadDone);
+  ink_assert(ink_aio_read(&io) >= 0);
+  return EVENT_CONT;
+}
+
+int
+CacheVC::tierPromoteReadDone(int event, Event *e)
+{
+  Doc *doc = (Doc *)buf->data();
+
+  cancel_trigger();
+  set_io_not_in_progress();
+  if (!io.ok() || doc->magic != DOC_MAGIC || doc->doc_type != CACHE_FRAG_TYPE_HTTP)
+    return tier_promote_free(this);
+  if (!first_buf) {
+    // the vector, the home directory entry has not moved since the hit read it
+    if (!(doc->first_key == first_key) || !doc->hlen)
+      return tier_promote_free(this);
+    first_buf = buf;
+    earliest_key = doc->key;
+
+    // the vector is copied as read from disk, unmarshal a copy of it
+    Ptr<IOBufferData> hdr(new_IOBufferData(iobuffer_size_to_index(doc->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+    Doc *hdoc = (Doc *)hdr->data();
+    memcpy((char *)hdoc, (char *)doc, doc->len);
+    char *p = hdoc->hdr();
+    int len = hdoc->hlen;
+    while (len > 0) {
+      int r = HTTPInfo::unmarshal(p, len, hdr._ptr());
+      if (r < 0)
+        return tier_promote_free(this);
+      len -= r;
+      p += r;
+    }
+    if (vector.get_handles(hdoc->hdr(), hdoc->hlen, hdr._ptr()) != hdoc->hlen || !vector.count())
+      return tier_promote_free(this);
+
+    uint64_t total = 0;
+    for (int i = 0; i < vector.count(); i++)
+      total += vector.get(i)->object_size_get();
+    if (cache_config_tier_promote_max_size && total > (uint64_t)cache_config_tier_promote_max_size)
+      return tier_promote_free(this);
+    alternate_index = -1;
+    SET_HANDLER(&CacheVC::tierPromoteNext);
+    return handleEvent(EVENT_IMMEDIATE, 0);
+  }
+  if (!(doc->key == key)) {
+    // collision
+    if (dir_probe(&key, tier_home, &dir, &last_collision))
+      return tierPromoteRead(event, e);
+    return tier_promote_free(this);
+  }
+  doc_pos += doc->data_len();
+  SET_HANDLER(&CacheVC::tierPromoteCopy);
+  return handleEvent(EVENT_IMMEDIATE, 0);
+}
+
+int
+CacheVC::tierPromoteCopy(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked())
+      VC_SCHED_LOCK_RETRY();
+    // promotions are the first thing to go when the fast tier falls behind
+    if (vol->agg_todo_size > cache_config_agg_write_backlog)
+      return tier_promote_free(this);
+
+    Doc *doc = (Doc *)buf->data();
+    // copied like an evacuated Doc, agg_copy keeps the flags of the home entry
+    overwrite_dir = dir;
+    agg_len = vol->round_to_approx_size(doc->len);
+    f.evacuator = 1;
+    CACHE_SUM_DYN_STAT(cache_tier_promote_bytes_stat, doc->len);
+    SET_HANDLER(&CacheVC::tierPromoteCopyDone);
+    vol->agg_todo_size += agg_len;
+    vol->agg.enqueue(this);
+    // this may already be running again when aggWrite returns
+    vol->aggWrite(EVENT_NONE, 0);
+  }
+  return EVENT_CONT;
+}
+
+// Called by aggWrite with the fast tier lock held once the Doc is in the
+// aggregation buffer, dir has been moved to its new location.
+int
+CacheVC::tierPromoteCopyDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  dir_insert(&key, vol, &dir);
+  SET_HANDLER(&CacheVC::tierPromoteNext);
+  eventProcessor.schedule_imm(this, ET_CALL);
+  return EVENT_CONT;
+}
+
+int
+CacheVC::tierPromoteNext(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  if (alternate_index >= vector.count()) // the vector has been copied
+    goto Lpublish;
+  if (alternate_index >= 0 && (uint64_t)doc_pos < doc_len) {
+    // next fragment
+    next_CacheKey(&key, &((Doc *)buf->data())->key);
+    last_collision = NULL;
+    if (dir_probe(&key, tier_home, &dir, &last_collision))
+      return tierPromoteRead(EVENT_IMMEDIATE, 0);
+    return tier_promote_free(this);
+  }
+  while (++alternate_index < vector.count()) {
+    CacheHTTPInfo *alt = vector.get(alternate_index);
+    alt->object_key_get(&key);
+    if (key == earliest_key) // resident in the vector
+      continue;
+    doc_pos = 0;
+    doc_len = alt->object_size_get();
+    last_collision = NULL;
+    if (dir_probe(&key, tier_home, &dir, &last_collision))
+      return tierPromoteRead(EVENT_IMMEDIATE, 0);
+    return tier_promote_free(this);
+  }
+  // every fragment is in the fast tier, now the vector
+  key = first_key;
+  dir = first_dir;
+  buf = first_buf;
+  SET_HANDLER(&CacheVC::tierPromoteCopy);
+  return handleEvent(EVENT_IMMEDIATE, 0);
+
+Lpublish : {
+  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  if (!lock.is_locked())
+    VC_SCHED_LOCK_RETRY();
+  // publish only if the home copy is still the one that was copied
+  if (tier_home->open_read(&first_key))
+    return tier_promote_free(this);
+  Dir d, *lc = NULL;
+  while (dir_probe(&first_key, tier_home, &d, &lc)) {
+    if (dir_offset(&d) == dir_offset(&first_dir)) {
+      cacheTier.insert(&first_key, vol, &dir);
+      closed = 1;
+      break;
+    }
+  }
+  return tier_promote_free(this);
+}
+}
+
+// A read routed to the fast tier found the copy gone or damaged, forget it
+// and start over on the home volume.
+int
+CacheVC::tierReadFallback()
+{
+  cacheTier.forget(&first_key);
+  CACHE_INCREMENT_DYN_STAT(cache_tier_read_fallback_stat);
+  CACHE_DECREMENT_DYN_STAT(base_stat + CACHE_STAT_ACTIVE);
+  vol = tier_home;
+  tier_home = NULL;
+  CACHE_INCREMENT_DYN_STAT(base_stat + CACHE_STAT_ACTIVE);
+  key = earliest_key = first_key;
+  buf = NULL;
+  first_buf = NULL;
+  last_collision = NULL;
+  vector.clear();
+  SET_HANDLER(&CacheVC::openReadStartHead);
+  return handleEvent(EVENT_IMMEDIATE, 0);
+}
@@ -185,6 +185,7 @@ CacheVC::scanObject(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
       goto Lnext_vol;
     io.aiocb.aio_nbytes = SCAN_BUF_SIZE;
     io.aiocb.aio_buf = buf->data();
+    io.aiocb.aio_reqprio = AIO_BACKGROUND_PRIORITY;
     io.action = this;
     io.thread = AIO_CALLBACK_THREAD_ANY;
     Debug("cache_scan_truss", "read %p:scanObject", this);
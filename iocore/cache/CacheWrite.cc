@@ -92,18 +92,32 @@ CacheVC::updateVector(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
       if (update_key == od->single_doc_key && (total_len || !vec))
         od->move_resident_alt = 0;
     }
+    if (vec && alternate_index < 0) {
+      // a response for the same variant as a stored alternate supersedes it
+      // rather than adding to the vector every later update has to rewrite
+      int old_index = write_vector->find_variant(&alternate);
+      if (old_index >= 0) {
+        Debug("cache_update", "replacing alternate index %d of the same variant", old_index);
+        if (od->move_resident_alt && get_alternate_index(write_vector, od->single_doc_key) == old_index)
+          od->move_resident_alt = 0;
+        write_vector->remove(old_index, true);
+      }
+    }
     if (cache_config_http_max_alts > 1 && write_vector->count() >= cache_config_http_max_alts && alternate_index < 0) {
       if (od->move_resident_alt && get_alternate_index(write_vector, od->single_doc_key) == 0)
         od->move_resident_alt = 0;
       write_vector->remove(0, true);
     }
     if (vec) {
-      /* preserve fragment offset data from old info. This method is
-         called iff the update is a header only update so the fragment
-         data should remain valid.
+      /* preserve fragment offset data from old info, only valid if the
+         update is a header only update. Otherwise the new body has its own
+         fragment table.
       */
-      if (alternate_index >= 0)
-        alternate.copy_frag_offsets_from(write_vector->get(alternate_index));
+      if (alternate_index >= 0 && !total_len) {
+        CacheHTTPInfo *old = write_vector->get(alternate_index);
+        alternate.copy_frag_offsets_from(old);
+        alternate.set_partial(old->is_partial());
+      }
       alternate_index = write_vector->insert(&alternate, alternate_index);
     }
 
@@ -209,9 +223,7 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
     vol->agg.push(this);
   else
     vol->agg.enqueue(this);
-  if (!vol->is_io_in_progress())
-    return vol->aggWrite(event, this);
-  return EVENT_CONT;
+  return vol->aggWrite(event, this);
 }
 
 static char *
@@ -321,7 +333,6 @@ Vol::aggWriteDone(int event, Event *e)
     ink_assert(header->write_pos == header->agg_pos);
     if (header->write_pos + EVACUATION_SIZE > scan_pos)
       periodic_scan();
-    agg_buf_pos = 0;
     header->write_serial++;
   } else {
     // delete all the directory entries that we inserted
@@ -333,13 +344,15 @@ Vol::aggWriteDone(int event, Event *e)
           (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
     Dir del_dir;
     dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = (Doc *)(agg_buffer + done);
+    for (int done = 0; done < (int)io.aiocb.aio_nbytes;) {
+      Doc *doc = (Doc *)(agg_write_buffer + done);
       dir_set_offset(&del_dir, header->write_pos + done);
       dir_delete(&doc->key, this, &del_dir);
       done += round_to_approx_size(doc->len);
     }
-    agg_buf_pos = 0;
+    // the buffer filled behind this write has been placed after it,
+    // skip over the failed range so those fragments stay where they are
+    header->write_pos = header->agg_pos;
   }
   set_io_not_in_progress();
   // callback ready sync CacheVCs
@@ -356,7 +369,7 @@ Vol::aggWriteDone(int event, Event *e)
     dir_sync_waiting = 0;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, 0);
   }
-  if (agg.head || sync.head)
+  if (agg.head || sync.head || agg_buf_pos)
     return aggWrite(event, e);
   return EVENT_CONT;
 }
@@ -715,7 +728,7 @@ static int
 agg_copy(char *p, CacheVC *vc)
 {
   Vol *vol = vc->vol;
-  off_t o = vol->header->write_pos + vol->agg_buf_pos;
+  off_t o = vol->header->agg_pos + vol->agg_buf_pos;
 
   if (!vc->f.evacuator) {
     Doc *doc = (Doc *)p;
@@ -942,22 +955,22 @@ Vol::agg_wrap()
 int
 Vol::aggWrite(int event, void * /* e ATS_UNUSED */)
 {
-  ink_assert(!is_io_in_progress());
-
   Que(CacheVC, link) tocall;
   CacheVC *c;
+  off_t end;
 
   cancel_trigger();
 
 Lagain:
-  // calculate length of aggregated write
-  for (c = (CacheVC *)agg.head; c;) {
+  // calculate length of aggregated write, unless a directory sync waits for
+  // the write in flight: the buffer filled behind it would keep it waiting.
+  for (c = dir_sync_waiting && is_io_in_progress() ? NULL : (CacheVC *)agg.head; c;) {
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
     ink_assert(writelen <= AGG_SIZE);
-    if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len))
+    if (agg_buf_pos + writelen > AGG_SIZE || header->agg_pos + agg_buf_pos + writelen > (skip + len))
       break;
-    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
+    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->agg_pos + agg_buf_pos, c->first_key.slice32(0));
     int wrotelen = agg_copy(agg_buffer + agg_buf_pos, c);
     ink_assert(writelen == wrotelen);
     agg_todo_size -= writelen;
@@ -976,6 +989,11 @@ Lagain:
     c = n;
   }
 
+  // keep filling while the previous aggregation write (or an evacuation
+  // read) is in flight, the buffer goes out when that completes.
+  if (is_io_in_progress())
+    goto Lwait;
+
   // if we got nothing...
   if (!agg_buf_pos) {
     if (!agg.head && !sync.head) // nothing to get
@@ -1002,7 +1020,7 @@ Lagain:
   }
 
   // evacuate space
-  off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
+  end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
   if (evac_range(header->write_pos, end, !header->phase) < 0)
     goto Lwait;
   if (end > skip + len)
@@ -1035,6 +1053,10 @@ Lagain:
   io.aiocb.aio_buf = agg_buffer;
   io.aiocb.aio_nbytes = agg_buf_pos;
   io.action = this;
+  // swap buffers, the next aggregation fills the other one
+  agg_buffer = agg_write_buffer;
+  agg_write_buffer = (char *)io.aiocb.aio_buf;
+  agg_buf_pos = 0;
   /*
     Callback on AIO thread so that we can issue a new write ASAP
     as all writes are serialized in the volume.  This is not necessary
@@ -1069,7 +1091,12 @@ CacheVC::openWriteCloseDir(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED *
       VC_SCHED_LOCK_RETRY();
     }
     vol->close_write(this);
-    if (closed < 0 && fragment)
+    // the fragments of a partial object are not tied to earliest_dir
+    if (closed < 0 && fragment
+#ifdef HTTP_CACHE
+        && !f.partial
+#endif
+        )
       dir_delete(&earliest_key, vol, &earliest_dir);
   }
   if (is_debug_tag_set("cache_update")) {
@@ -1220,6 +1247,8 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
     fragment++;
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
+    if (od)
+      od->wake_readers();
     blocks = iobufferblock_skip(blocks, &offset, &length, write_len);
     next_CacheKey(&key, &key);
     if (length) {
@@ -1248,6 +1277,18 @@ CacheVC::openWriteClose(int event, Event *e)
     if (!io.ok())
       return openWriteCloseDir(event, e);
   }
+#ifdef HTTP_CACHE
+  if (f.partial) {
+    // the fragment being accumulated is incomplete and is dropped, the
+    // vector is written only if some fragment was stored
+    if (closed < 0 || !f.partial_stored) {
+      closed = -1;
+      return openWriteCloseDir(event, e);
+    }
+    f.data_done = 1;
+    return openWriteCloseHead(event, e);
+  }
+#endif
   if (closed > 0
 #ifdef HTTP_CACHE
       || f.allow_empty_doc
@@ -1316,6 +1357,8 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     ++fragment;
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
+    if (od)
+      od->wake_readers();
     DDebug("cache_insert", "WriteDone: %X, %X, %d", key.slice32(0), first_key.slice32(0), write_len);
     blocks = iobufferblock_skip(blocks, &offset, &length, write_len);
     next_CacheKey(&key, &key);
@@ -1400,6 +1443,151 @@ Lagain:
   return do_write_lock_call();
 }
 
+#ifdef HTTP_CACHE
+/*
+   Partial writes store only the whole fragments of an object that fall in
+   the data written. The fragment table of the alternate is built up front
+   (or is that of the partial alternate being filled in) so that the key of
+   every fragment is known, the bytes in front of the first whole fragment
+   and after the last one are dropped.
+   - seek_to. Object offset of the first byte written to the VC.
+   - write_pos. Object offset of the fragment being accumulated.
+   */
+bool
+CacheVC::set_partial_write(int64_t aoffset, int64_t size)
+{
+  ink_assert(vio.op == VIO::WRITE && !total_len && !fragment && !length);
+  if (frag_type != CACHE_FRAG_TYPE_HTTP || !alternate.valid() || aoffset < 0 || aoffset >= size)
+    return false;
+  if (f.update) {
+    // filling in a partial alternate, its fragments keep their keys
+    if ((int64_t)update_len != size)
+      return false;
+    earliest_key = update_key;
+  } else {
+    ink_assert(!alternate.get_frag_offset_count());
+    for (int64_t pos = target_fragment_size(); pos < size; pos += target_fragment_size())
+      alternate.push_frag_offset(pos);
+  }
+  HTTPInfo::FragOffset *frags = alternate.get_frag_table();
+  int nfrags = alternate.get_frag_offset_count();
+  if (size - (int64_t)(nfrags ? frags[nfrags - 1] : 0) > MAX_FRAG_SIZE)
+    return false;
+  alternate.object_size_set(size);
+  alternate.set_partial(true);
+  total_len = size;
+  seek_to = aoffset;
+
+  // the first fragment that is wholly written, if aoffset is in the last
+  // one there is none and everything is skipped
+  fragment = alternate.get_whole_frag_index(aoffset);
+  if (fragment > nfrags)
+    write_pos = size;
+  else
+    write_pos = fragment ? frags[fragment - 1] : 0;
+  key = earliest_key;
+  for (int i = 0; i < fragment; i++)
+    next_CacheKey(&key, &key);
+  f.partial = 1;
+  DDebug("cache_partial", "%p: partial write of %" PRId64 " bytes @ %" PRId64 ", first fragment %d @ %" PRId64, this, size,
+         aoffset, fragment, (int64_t)write_pos);
+  SET_HANDLER(&CacheVC::openWritePartialMain);
+  return true;
+}
+
+int
+CacheVC::openWritePartialWriteDone(int event, Event *e)
+{
+  cancel_trigger();
+  if (event == AIO_EVENT_DONE)
+    set_io_not_in_progress();
+  else if (is_io_in_progress())
+    return EVENT_CONT;
+  if (!io.ok()) {
+    if (closed) {
+      closed = -1;
+      return die();
+    }
+    SET_HANDLER(&CacheVC::openWritePartialMain);
+    return calluser(VC_EVENT_ERROR);
+  }
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked())
+      VC_LOCK_RETRY_EVENT();
+    dir_insert(&key, vol, &dir);
+    DDebug("cache_partial", "%p: stored fragment %d @ %" PRId64 ", %d bytes", this, fragment, (int64_t)write_pos, write_len);
+    f.partial_stored = 1;
+    ++fragment;
+    write_pos += write_len;
+    blocks = iobufferblock_skip(blocks, &offset, &length, write_len);
+    next_CacheKey(&key, &key);
+  }
+  if (closed)
+    return die();
+  SET_HANDLER(&CacheVC::openWritePartialMain);
+  return openWritePartialMain(event, e);
+}
+
+int
+CacheVC::openWritePartialMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  int called_user = 0;
+  ink_assert(!is_io_in_progress());
+Lagain:
+  if (!vio.buffer.writer()) {
+    if (calluser(VC_EVENT_WRITE_READY) == EVENT_DONE)
+      return EVENT_DONE;
+    if (!vio.buffer.writer())
+      return EVENT_CONT;
+  }
+  int64_t avail = vio.buffer.reader()->read_avail();
+  if (avail > vio.ntodo())
+    avail = vio.ntodo();
+  int64_t pos = seek_to + vio.ndone;
+  if (pos < (int64_t)write_pos && avail > 0) {
+    // in front of the first whole fragment
+    int64_t skip = write_pos - pos;
+    if (skip > avail)
+      skip = avail;
+    vio.buffer.reader()->consume(skip);
+    vio.ndone += skip;
+    avail -= skip;
+  }
+  if (avail > 0 && (int64_t)write_pos < (int64_t)total_len) {
+    int64_t frag_end = fragment < alternate.get_frag_offset_count() ? alternate.get_frag_table()[fragment] : total_len;
+    int64_t towrite = frag_end - write_pos - length;
+    if (towrite > avail)
+      towrite = avail;
+    if (!blocks && towrite) {
+      blocks = vio.buffer.reader()->block;
+      offset = vio.buffer.reader()->start_offset;
+    }
+    vio.buffer.reader()->consume(towrite);
+    vio.ndone += towrite;
+    length += towrite;
+    if ((int64_t)(write_pos + length) == frag_end) {
+      write_len = length;
+      SET_HANDLER(&CacheVC::openWritePartialWriteDone);
+      return do_write_lock_call();
+    }
+  }
+  if (vio.ntodo() <= 0) {
+    if (calluser(VC_EVENT_WRITE_COMPLETE) == EVENT_DONE)
+      return EVENT_DONE;
+    return EVENT_CONT;
+  }
+  if (!called_user) {
+    called_user = 1;
+    if (calluser(VC_EVENT_WRITE_READY) == EVENT_DONE)
+      return EVENT_DONE;
+    goto Lagain;
+  }
+  return EVENT_CONT;
+}
+#endif
+
 // begin overwrite
 int
 CacheVC::openWriteOverwrite(int event, Event *e)
@@ -99,6 +99,11 @@ struct CacheProcessor : public Processor {
                      CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP);
   Action *remove(Continuation *cont, const HttpCacheKey *key, bool cluster_cache_local,
                  CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP);
+  /** Count a miss of @a key and check whether a new object of @a size bytes
+      should be written, see proxy.config.cache.admission.enabled.
+      @return @c false if the object was not requested often enough yet.
+  */
+  bool admit(const HttpCacheKey *key, int64_t size, CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP);
 #endif
   Action *link(Continuation *cont, CacheKey *from, CacheKey *to, bool cluster_cache_local,
                CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP, char *hostname = 0, int host_len = 0);
@@ -223,6 +228,33 @@ struct CacheVConnection : public VConnection {
   */
   virtual bool is_pread_capable() = 0;
 
+  /** Store only the fragments of a @a size byte object that fall in the data
+      written, which starts at byte @a offset of the object. Must be called
+      after @c set_http_info and before the first write.
+      @return @c false if the VC cannot store partial objects.
+  */
+  virtual bool
+  set_partial_write(int64_t offset, int64_t size)
+  {
+    (void)offset;
+    (void)size;
+    return false;
+  }
+
+  /** Test if bytes @a start to @a end (inclusive) of the object being read
+      are in the cache. A cache VC reading a complete object always returns
+      @c true. For a partially cached object only bytes of the single range
+      of the Range header of the lookup request can be, their fragments are
+      checked on disk when the object is opened.
+  */
+  virtual bool
+  is_range_cached(int64_t start, int64_t end)
+  {
+    (void)start;
+    (void)end;
+    return false;
+  }
+
   CacheVConnection();
 };
 
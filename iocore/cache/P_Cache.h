@@ -41,6 +41,8 @@
 #include "P_CacheDir.h"
 #include "P_RamCache.h"
 #include "P_CacheVol.h"
+#include "P_CacheTier.h"
+#include "P_CacheAdmission.h"
 #include "P_CacheInternal.h"
 #include "P_CacheHosting.h"
 #include "P_CacheHttp.h"
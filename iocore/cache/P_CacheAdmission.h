@@ -0,0 +1,59 @@
+/** @file
+
+  Frequency based admission of new objects to the cache
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef _P_CACHE_ADMISSION_H__
+#define _P_CACHE_ADMISSION_H__
+
+struct Cache;
+struct Vol;
+
+#define CACHE_ADMISSION_DEPTH 4
+
+/**
+  Every cacheable miss is written to the cyclic log, so objects requested only
+  once push out objects that would have been hit again. The admission filter
+  counts the misses of each key in a count-min sketch and lets a new object be
+  written only once it was missed proxy.config.cache.admission.min_hits times
+  recently. Counters are halved after as many misses as a row has counters so
+  the counts follow recent popularity.
+
+  The sketch is shared by all volumes, whether a volume is filtered is set by
+  proxy.config.cache.admission.enabled and the admission option of
+  volume.config. Counters are updated without a lock, a lost update only
+  delays the admission of an object.
+*/
+struct CacheAdmission {
+  uint8_t *counters; // CACHE_ADMISSION_DEPTH rows of width counters
+  int64_t width;
+  volatile int64_t samples;
+
+  void init(Cache *cache);
+  bool filtered(Vol *vol) const;
+  bool admit(const CacheKey *key, Vol *vol, int64_t size);
+
+  CacheAdmission() : counters(NULL), width(0), samples(0) {}
+};
+
+extern CacheAdmission cacheAdmission;
+
+#endif /* _P_CACHE_ADMISSION_H__ */
@@ -28,7 +28,6 @@
 #include "P_CacheHttp.h"
 
 struct Vol;
-struct InterimCacheVol;
 struct CacheVC;
 
 /*
@@ -222,7 +221,7 @@ struct FreeDir {
 LINK_FORWARD_DECLARATION(CacheVC, opendir_link) // forward declaration
 struct OpenDirEntry {
   DLL<CacheVC, Link_CacheVC_opendir_link> writers; // list of all the current writers
-  DLL<CacheVC, Link_CacheVC_opendir_link> readers; // list of all the current readers - not used
+  DLL<CacheVC, Link_CacheVC_opendir_link> readers; // readers waiting for a writer to store more
   CacheHTTPInfoVector vector;                      // Vector for the http document. Each writer
                                                    // maintains a pointer to this vector and
                                                    // writes it down to disk.
@@ -240,6 +239,7 @@ struct OpenDirEntry {
   LINK(OpenDirEntry, link);
 
   int wait(CacheVC *c, int msec);
+  void wake_readers();
 
   bool
   has_multiple_writers()
@@ -249,15 +249,11 @@ struct OpenDirEntry {
 };
 
 struct OpenDir : public Continuation {
-  Queue<CacheVC, Link_CacheVC_opendir_link> delayed_readers;
   DLL<OpenDirEntry> bucket[OPEN_DIR_BUCKETS];
 
   int open_write(CacheVC *c, int allow_if_writers, int max_writers);
   int close_write(CacheVC *c);
   OpenDirEntry *open_read(const CryptoHash *key);
-  int signal_readers(int event, Event *e);
-
-  OpenDir();
 };
 
 struct CacheSync : public Continuation {
@@ -266,14 +262,20 @@ struct CacheSync : public Continuation {
   size_t buflen;
   bool buf_huge;
   off_t writepos;
+  uint64_t *segments; // segments of the directory copy being written
+  int segments_len;
+  bool write_error;
   AIOCallbackInternal io;
   Event *trigger;
   ink_hrtime start_time;
   int mainEvent(int event, Event *e);
   void aio_write(int fd, char *b, int n, off_t o);
+  void copy_segments(Vol *vol, int copy);
+  bool next_segments(Vol *vol, off_t *o, int *l);
 
   CacheSync()
-    : Continuation(new_ProxyMutex()), vol_idx(0), buf(0), buflen(0), buf_huge(false), writepos(0), trigger(0), start_time(0)
+    : Continuation(new_ProxyMutex()), vol_idx(0), buf(0), buflen(0), buf_huge(false), writepos(0), segments(0), segments_len(0),
+      write_error(false), trigger(0), start_time(0)
   {
     SET_HANDLER(&CacheSync::mainEvent);
   }
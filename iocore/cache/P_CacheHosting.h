@@ -177,6 +177,7 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   int percent;
+  int admission; // 1 or -1 to turn the admission filter on or off, 0 to follow the global setting
   CacheVol *cachep;
   LINK(ConfigVol, link);
 };
@@ -76,6 +76,9 @@ struct CacheHTTPInfoVector {
   }
   void print(char *buffer, size_t buf_size, bool temps = true);
 
+  /// Index of the alternate stored for the same variant as @a info, -1 if none.
+  int find_variant(CacheHTTPInfo *info);
+
   int marshal_length();
   int marshal(char *buf, int length);
   uint32_t get_handles(const char *buf, int length, RefCountObj *block_ptr = NULL);
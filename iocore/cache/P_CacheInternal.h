@@ -91,15 +91,21 @@ struct EvacuationBlock;
 
 #define CONT_SCHED_LOCK_RETRY(_c) _c->mutex->thread_holding->schedule_in_local(_c, HRTIME_MSECONDS(cache_config_mutex_retry_delay))
 
-#define VC_SCHED_WRITER_RETRY()                                           \
-  do {                                                                    \
-    ink_assert(!trigger);                                                 \
-    writer_lock_retry++;                                                  \
-    ink_hrtime _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay); \
-    if (writer_lock_retry > 2)                                            \
-      _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay) * 2;      \
-    trigger = mutex->thread_holding->schedule_in_local(this, _t);         \
-    return EVENT_CONT;                                                    \
+// Wait for the writer of the object, called with the vol lock held. The
+// reader is woken as soon as the writer stores a fragment or closes, the
+// delay only matters if the reader's lock is busy at that moment.
+#define VC_SCHED_WRITER_RETRY()                                                       \
+  do {                                                                                \
+    ink_assert(!trigger);                                                             \
+    writer_lock_retry++;                                                              \
+    int _msec = cache_read_while_writer_retry_delay;                                  \
+    if (writer_lock_retry > 2)                                                        \
+      _msec *= 2;                                                                     \
+    OpenDirEntry *_od = vol->open_read(&first_key);                                   \
+    if (_od)                                                                          \
+      return _od->wait(this, _msec);                                                  \
+    trigger = mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(_msec)); \
+    return EVENT_CONT;                                                                \
   } while (0)
 
 
@@ -153,6 +159,16 @@ enum {
   cache_directory_sync_count_stat,
   cache_directory_sync_time_stat,
   cache_directory_sync_bytes_stat,
+  cache_tier_promote_active_stat,
+  cache_tier_promote_success_stat,
+  cache_tier_promote_failure_stat,
+  cache_tier_promote_bytes_stat,
+  cache_tier_read_stat,
+  cache_tier_read_fallback_stat,
+  cache_admission_admitted_stat,
+  cache_admission_admitted_bytes_stat,
+  cache_admission_rejected_stat,
+  cache_admission_rejected_bytes_stat,
   cache_stat_count
 };
 
@@ -203,6 +219,7 @@ extern int cache_config_select_alternate;
 extern int cache_config_max_doc_size;
 extern int cache_config_min_average_object_size;
 extern int cache_config_agg_write_backlog;
+extern int cache_config_init_reads;
 extern int cache_config_enable_checksum;
 extern int cache_config_alt_rewrite_max_size;
 extern int cache_config_read_while_writer;
@@ -218,6 +235,13 @@ extern int cache_config_target_fragment_size;
 extern int cache_config_mutex_retry_delay;
 extern int cache_read_while_writer_retry_delay;
 extern int cache_config_read_while_writer_max_retries;
+extern int cache_config_tier_volume;
+extern int cache_config_tier_promote_hits;
+extern int64_t cache_config_tier_promote_max_size;
+extern int64_t cache_config_tier_index_size;
+extern int cache_config_admission_enabled;
+extern int cache_config_admission_min_hits;
+extern int64_t cache_config_admission_sketch_size;
 
 // CacheVC
 struct CacheVC : public CacheVConnection {
@@ -306,6 +330,7 @@ struct CacheVC : public CacheVConnection {
   int openReadStartEarliest(int event, Event *e);
 #ifdef HTTP_CACHE
   int openReadVecWrite(int event, Event *e);
+  int openReadVerifyRange(int event, Event *e);
 #endif
   int openReadStartHead(int event, Event *e);
   int openReadFromWriter(int event, Event *e);
@@ -320,6 +345,8 @@ struct CacheVC : public CacheVConnection {
   int openWriteClose(int event, Event *e);
   int openWriteRemoveVector(int event, Event *e);
   int openWriteWriteDone(int event, Event *e);
+  int openWritePartialWriteDone(int event, Event *e);
+  int openWritePartialMain(int event, Event *e);
   int openWriteOverwrite(int event, Event *e);
   int openWriteMain(int event, Event *e);
   int openWriteStartDone(int event, Event *e);
@@ -340,6 +367,13 @@ struct CacheVC : public CacheVConnection {
   int scanOpenWrite(int event, Event *e);
   int scanRemoveDone(int event, Event *e);
 
+  int tierPromoteRead(int event, Event *e);
+  int tierPromoteReadDone(int event, Event *e);
+  int tierPromoteCopy(int event, Event *e);
+  int tierPromoteCopyDone(int event, Event *e);
+  int tierPromoteNext(int event, Event *e);
+  int tierReadFallback();
+
   int
   is_io_in_progress()
   {
@@ -359,6 +393,7 @@ struct CacheVC : public CacheVConnection {
   int evacuateReadHead(int event, Event *e);
 
   void cancel_trigger();
+  void cancel_writer_wait();
   virtual int64_t get_object_size();
 #ifdef HTTP_CACHE
   virtual void set_http_info(CacheHTTPInfo *info);
@@ -372,6 +407,8 @@ struct CacheVC : public CacheVConnection {
       @return Length of header data used for alternates.
    */
   virtual uint32_t load_http_info(CacheHTTPInfoVector *info, struct Doc *doc, RefCountObj *block_ptr = NULL);
+  virtual bool set_partial_write(int64_t offset, int64_t size);
+  virtual bool is_range_cached(int64_t start, int64_t end);
 #endif
   virtual bool is_pread_capable();
   virtual bool set_pin_in_cache(time_t time_pin);
@@ -443,6 +480,7 @@ struct CacheVC : public CacheVConnection {
   uint32_t agg_len;      // for communicating with aggWrite
   uint32_t write_serial; // serial of the final write for SYNC
   Vol *vol;
+  Vol *tier_home; // home volume of an object read from or promoted to the fast tier
   Dir *last_collision;
   Event *trigger;
   CacheKey *read_key;
@@ -461,9 +499,12 @@ struct CacheVC : public CacheVConnection {
   uint64_t total_len;    // total length written and available to write
   uint64_t doc_len;      // total_length (of the selected alternate for HTTP)
   uint64_t update_len;
+  int64_t range_start; // bytes of a partial alternate checked when opened
+  int64_t range_end;
   int fragment;
   int scan_msec_delay;
   CacheVC *write_vc;
+  OpenDirEntry *wait_od; // the readers list this is waiting on, under the vol lock
   char *hostname;
   int host_len;
   int header_to_write_len;
@@ -494,6 +535,10 @@ struct CacheVC : public CacheVConnection {
       unsigned int compressed_in_ram : 1; // compressed state in ram cache
 #ifdef HTTP_CACHE
       unsigned int allow_empty_doc : 1; // used for cache empty http document
+      unsigned int partial : 1;         // alternate with only some fragments stored
+      unsigned int partial_seek : 1;    // read of a partial alternate, no fragment read yet
+      unsigned int partial_stored : 1;  // write of a partial alternate, a fragment was stored
+      unsigned int partial_range : 1;   // read of a partial alternate, range_start to range_end is stored
 #endif
     } f;
   };
@@ -578,6 +623,7 @@ free_CacheVC(CacheVC *cont)
     cont->trigger->cancel();
   ink_assert(!cont->is_io_in_progress());
   ink_assert(!cont->od);
+  ink_assert(!cont->wait_od);
   /* calling cont->io.action = NULL causes compile problem on 2.6 solaris
      release build....wierd??? For now, null out continuation and mutex
      of the action separately */
@@ -674,6 +720,17 @@ CacheVC::cancel_trigger()
   }
 }
 
+// Stop waiting for the writer, called with the vol lock held by a reader
+// that was woken by its timeout or is going away.
+TS_INLINE void
+CacheVC::cancel_writer_wait()
+{
+  if (wait_od) {
+    wait_od->readers.remove(this);
+    wait_od = NULL;
+  }
+}
+
 TS_INLINE int
 CacheVC::die()
 {
@@ -780,6 +837,8 @@ Vol::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
     return ECACHE_WRITE_FAIL;
   }
   if (open_dir.open_write(cont, allow_if_writers, max_writers)) {
+    // the fast tier copy is about to go stale
+    cacheTier.forget(&cont->first_key);
 #ifdef CACHE_STAT_PAGES
     ink_assert(cont->mutex->thread_holding == this_ethread());
     ink_assert(!cont->stat_link.next && !cont->stat_link.prev);
@@ -0,0 +1,101 @@
+/** @file
+
+  Fast tier of the cache, hot objects promoted out of their home volume
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#ifndef _P_CACHE_TIER_H__
+#define _P_CACHE_TIER_H__
+
+struct Cache;
+struct CacheHostRecord;
+struct CacheVC;
+struct Vol;
+
+// objects being copied into the fast tier at any one time
+#define CACHE_TIER_MAX_PROMOTIONS 16
+#define CACHE_TIER_INDEX_WAYS 4
+// one hit count is halved every this many hits, so each is halved once in
+// hits_size * CACHE_TIER_DECAY_HITS hits
+#define CACHE_TIER_DECAY_HITS 8
+
+struct CacheTierEntry {
+  volatile uint64_t fingerprint; // of the first key, 0 if free
+  Dir dir;                       // of the vector in the fast tier
+};
+
+/**
+  The fast tier is the volume named by proxy.config.cache.tier.volume. It is
+  left out of the hashing of objects to volumes, instead HTTP objects read
+  often enough from their home volume are copied to it in the background, to
+  the stripe selected by hashing the key over the fast tier alone.
+
+  The index remembers the objects with a complete copy in the fast tier and
+  where the copied vector is. The home copy is never removed, so losing an
+  index entry (restart, a full set, a failed device) only sends reads of the
+  object back to its home volume. An entry is dropped whenever the home
+  volume opens the object for write, with the home volume lock held, and is
+  added with both volume locks held after checking that the home vector did
+  not change while it was copied.
+
+  Fingerprints may be tested without a lock. All keys of an index set hash to
+  the same fast tier stripe and the directory entries of a set are only read
+  and written with that stripe's lock held.
+*/
+struct CacheTier {
+  CacheHostRecord *host_rec; // the fast tier stripes, NULL if there is no fast tier
+  CacheTierEntry *index;
+  int64_t index_sets;
+  int64_t sets_per_bucket;
+  uint8_t *hits; // approximate recent reads from the home volume
+  int64_t hits_size;
+  volatile int64_t hits_seen; // also the position of the decay over hits
+  volatile int promotions;
+
+  void init(Cache *cache);
+  void rebuild();
+
+  bool
+  enabled() const
+  {
+    return host_rec != NULL;
+  }
+
+  Vol *key_to_vol(const CacheKey *key);
+  Vol *promoted_vol(const CacheKey *key);
+  bool probe(const CacheKey *key, Vol *vol, Dir *result);
+  void insert(const CacheKey *key, Vol *vol, Dir *dir);
+  void forget(const CacheKey *key);
+  void hit(CacheVC *reader);
+  bool count_hit(const CacheKey *key, uint64_t doc_len);
+
+  CacheTier()
+    : host_rec(NULL), index(NULL), index_sets(0), sets_per_bucket(0), hits(NULL), hits_size(0), hits_seen(0), promotions(0)
+  {
+  }
+
+private:
+  CacheTierEntry *find(const CacheKey *key);
+  void promote(CacheVC *reader);
+};
+
+extern CacheTier cacheTier;
+
+#endif /* _P_CACHE_TIER_H__ */
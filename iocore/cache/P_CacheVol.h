@@ -51,6 +51,7 @@
 #define LOOKASIDE_SIZE 256
 #define EVACUATION_BUCKET_SIZE (2 * EVACUATION_SIZE) // 16MB
 #define RECOVERY_SIZE EVACUATION_SIZE                // 8MB
+#define VOL_MAX_INIT_READS 16                        // most concurrent reads per directory/recovery read
 #define AIO_NOT_IN_PROGRESS 0
 #define AIO_AGG_WRITE_IN_PROGRESS -1
 #define AUTO_SIZE_RAM_CACHE -1                             // 1-1 with directory size
@@ -132,6 +133,7 @@ struct Vol : public Continuation {
 
   char *raw_dir;
   Dir *dir;
+  uint64_t *dir_dirty[2]; // segments changed since directory copy A/B was last written
   VolHeaderFooter *header;
   VolHeaderFooter *footer;
   int segments;
@@ -149,7 +151,8 @@ struct Vol : public Continuation {
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer;
+  char *agg_buffer;       // being filled, starts at header->agg_pos
+  char *agg_write_buffer; // being written, [header->write_pos, header->agg_pos)
   int agg_todo_size;
   int agg_buf_pos;
 
@@ -206,6 +209,8 @@ struct Vol : public Continuation {
   int handle_recover_from_data(int event, void *data);
   int handle_recover_write_dir(int event, void *data);
   int handle_header_read(int event, void *data);
+  int handle_init_read(int event, void *data);
+  void init_read();
 
 
   int dir_init_done(int event, void *data);
@@ -258,12 +263,21 @@ struct Vol : public Continuation {
       dir_sync_in_progress(0), writing_end_marker(0)
   {
     open_dir.mutex = mutex;
+    dir_dirty[0] = dir_dirty[1] = NULL;
     agg_buffer = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
     memset(agg_buffer, 0, AGG_SIZE);
+    agg_write_buffer = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
+    memset(agg_write_buffer, 0, AGG_SIZE);
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() { ats_memalign_free(agg_buffer); }
+  ~Vol()
+  {
+    ats_memalign_free(agg_buffer);
+    ats_memalign_free(agg_write_buffer);
+    ats_free(dir_dirty[0]);
+    ats_free(dir_dirty[1]);
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -277,13 +291,14 @@ struct CacheVol {
   int scheme;
   off_t size;
   int num_vols;
+  int admission; // from volume.config, see ConfigVol
   Vol **vols;
   DiskVol **disk_vols;
   LINK(CacheVol, link);
   // per volume stats
   RecRawStatBlock *vol_rsb;
 
-  CacheVol() : vol_number(-1), scheme(0), size(0), num_vols(0), vols(NULL), disk_vols(0), vol_rsb(0) {}
+  CacheVol() : vol_number(-1), scheme(0), size(0), num_vols(0), admission(0), vols(NULL), disk_vols(0), vol_rsb(0) {}
 };
 
 // Note : hdr() needs to be 8 byte aligned.
@@ -363,7 +378,7 @@ vol_out_of_phase_write_valid(Vol *d, Dir *e)
 TS_INLINE int
 vol_in_phase_valid(Vol *d, Dir *e)
 {
-  return (dir_offset(e) - 1 < ((d->header->write_pos + d->agg_buf_pos - d->start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 < ((d->header->agg_pos + d->agg_buf_pos - d->start) / CACHE_BLOCK_SIZE));
 }
 
 TS_INLINE off_t
@@ -390,10 +405,20 @@ vol_dir_segment(Vol *d, int s)
   return (Dir *)(((char *)d->dir) + (s * d->buckets) * DIR_DEPTH * SIZEOF_DIR);
 }
 
+// a segment changed, both directory copies have to write it out again
+TS_INLINE void
+vol_dir_segment_dirty(Vol *d, int s)
+{
+  d->dir_dirty[0][s >> 6] |= (uint64_t)1 << (s & 63);
+  d->dir_dirty[1][s >> 6] |= (uint64_t)1 << (s & 63);
+}
+
+// the fragment is still in memory, either in the aggregation write in flight
+// or in the buffer being filled behind it
 TS_INLINE int
 vol_in_phase_agg_buf_valid(Vol *d, Dir *e)
 {
-  return (vol_offset(d, e) >= d->header->write_pos && vol_offset(d, e) < (d->header->write_pos + d->agg_buf_pos));
+  return (vol_offset(d, e) >= d->header->write_pos && vol_offset(d, e) < (d->header->agg_pos + d->agg_buf_pos));
 }
 // length of the partition not including the offset of location 0.
 TS_INLINE off_t
@@ -23,6 +23,7 @@
 
 #include "P_DNS.h" /* MAGIC_EDITING_TAG */
 #include <ts/ink_inet.h>
+#include <ts/HashFNV.h>
 
 #ifdef SPLIT_DNS
 #include "I_SplitDNS.h"
@@ -192,10 +193,16 @@ DNSProcessor::start(int, size_t stacksize)
   REC_ReadConfigStringAlloc(dns_resolv_conf, "proxy.config.dns.resolv_conf");
   REC_EstablishStaticConfigInt32(dns_thread, "proxy.config.dns.dedicated_thread");
 
+  if (dns_thread > MAX_DNS_HANDLERS) {
+    Warning("proxy.config.dns.dedicated_thread is %d, limiting to %d DNS threads", dns_thread, MAX_DNS_HANDLERS);
+    dns_thread = MAX_DNS_HANDLERS;
+  }
+
   if (dns_thread > 0) {
-    // TODO: Hmmm, should we just get a single thread some other way?
-    ET_DNS = eventProcessor.spawn_event_threads(1, "ET_DNS", stacksize);
-    initialize_thread_for_net(eventProcessor.eventthread[ET_DNS][0]);
+    ET_DNS = eventProcessor.spawn_event_threads(dns_thread, "ET_DNS", stacksize);
+    for (int i = 0; i < dns_thread; ++i) {
+      initialize_thread_for_net(eventProcessor.eventthread[ET_DNS][i]);
+    }
   } else {
     // Initialize the first event thread for DNS.
     ET_DNS = ET_CALL;
@@ -210,18 +217,28 @@ DNSProcessor::start(int, size_t stacksize)
   }
 
   // Setup the default DNSHandler, it's used both by normal DNS, and SplitDNS (for PTR lookups etc.)
+  // With several dedicated threads, each one gets its own handler and queries are spread across them.
   dns_init();
-  open();
+  if (dns_thread > 1) {
+    for (int i = 0; i < dns_thread; ++i) {
+      open(NULL, eventProcessor.eventthread[ET_DNS][i]);
+    }
+  } else {
+    open();
+  }
 
   return 0;
 }
 
 void
-DNSProcessor::open(sockaddr const *target)
+DNSProcessor::open(sockaddr const *target, EThread *t)
 {
   DNSHandler *h = new DNSHandler;
 
-  h->mutex = thread->mutex;
+  if (!t)
+    t = thread;
+  h->thread = t;
+  h->mutex = t->mutex;
   h->m_res = &l_res;
   ats_ip_copy(&h->local_ipv4.sa, &local_ipv4.sa);
   ats_ip_copy(&h->local_ipv6.sa, &local_ipv6.sa);
@@ -231,11 +248,25 @@ DNSProcessor::open(sockaddr const *target)
   else
     ats_ip_invalidate(&h->ip); // marked to use default.
 
-  if (!dns_handler_initialized)
+  if (!handler)
     handler = h;
+  if (n_handlers < MAX_DNS_HANDLERS)
+    handlers[n_handlers++] = h;
 
   SET_CONTINUATION_HANDLER(h, &DNSHandler::startEvent);
-  thread->schedule_imm(h);
+  t->schedule_imm(h);
+}
+
+DNSHandler *
+DNSProcessor::select_handler(const char *qname, int len)
+{
+  if (n_handlers <= 1)
+    return handler;
+
+  ATSHash32FNV1a hash;
+  hash.update(qname, len);
+  hash.final();
+  return handlers[hash.get() % n_handlers];
 }
 
 //
@@ -347,8 +378,9 @@ ink_dn_expand(const u_char *msg, const u_char *eom, const u_char *comp_dn, u_cha
   return ::dn_expand((unsigned char *)msg, (unsigned char *)eom, (unsigned char *)comp_dn, (char *)exp_dn, length);
 }
 
-DNSProcessor::DNSProcessor() : thread(NULL), handler(NULL)
+DNSProcessor::DNSProcessor() : thread(NULL), handler(NULL), n_handlers(0)
 {
+  ink_zero(handlers);
   ink_zero(l_res);
   ink_zero(local_ipv6);
   ink_zero(local_ipv4);
@@ -371,20 +403,6 @@ DNSEntry::init(const char *x, int len, int qtype_arg, Continuation *acont, DNSPr
   action = acont;
   submit_thread = acont->mutex->thread_holding;
 
-#ifdef SPLIT_DNS
-  if (SplitDNSConfig::gsplit_dns_enabled) {
-    dnsH = opt.handler ? opt.handler : dnsProcessor.handler;
-  } else {
-    dnsH = dnsProcessor.handler;
-  }
-#else
-  dnsH = dnsProcessor.handler;
-#endif // SPLIT_DNS
-
-  dnsH->txn_lookup_timeout = opt.timeout;
-
-  mutex = dnsH->mutex;
-
   if (is_addr_query(qtype) || qtype == T_SRV) {
     if (len) {
       len = len > (MAXDNAME - 1) ? (MAXDNAME - 1) : len;
@@ -405,6 +423,20 @@ DNSEntry::init(const char *x, int len, int qtype_arg, Continuation *acont, DNSPr
       ink_assert(!"T_PTR query to DNS must be IP address.");
   }
 
+#ifdef SPLIT_DNS
+  if (SplitDNSConfig::gsplit_dns_enabled && opt.handler) {
+    dnsH = opt.handler;
+  } else {
+    dnsH = dnsProcessor.select_handler(qname, strlen(qname));
+  }
+#else
+  dnsH = dnsProcessor.select_handler(qname, strlen(qname));
+#endif // SPLIT_DNS
+
+  dnsH->txn_lookup_timeout = opt.timeout;
+
+  mutex = dnsH->mutex;
+
   SET_HANDLER((DNSEntryHandler)&DNSEntry::mainEvent);
 }
 
@@ -417,7 +449,7 @@ void
 DNSHandler::open_con(sockaddr const *target, bool failed, int icon)
 {
   ip_port_text_buffer ip_text;
-  PollDescriptor *pd = get_PollDescriptor(dnsProcessor.thread);
+  PollDescriptor *pd = get_PollDescriptor(thread ? thread : dnsProcessor.thread);
 
   if (!icon && target) {
     ats_ip_copy(&ip, target);
@@ -484,10 +516,10 @@ DNSHandler::startEvent(int /* event ATS_UNUSED */, Event *e)
 
   this->validate_ip();
 
-  if (!dns_handler_initialized) {
+  if (!n_con) {
     //
-    // If we are THE handler, open connection and configure for
-    // periodic execution.
+    // If we are a default handler, open connection and configure for
+    // periodic execution. There is one of these per DNS thread.
     //
     dns_handler_initialized = 1;
     SET_HANDLER(&DNSHandler::mainEvent);
@@ -723,27 +755,91 @@ good_rcode(char *buff)
 }
 
 
+/**
+  Handle a single response read from @a dnsc into @a buf.
+
+  @return false if the response was discarded and @a buf may be reused.
+*/
+bool
+DNSHandler::recv_one(DNSConnection *dnsc, HostEnt *buf, int res, IpEndpoint const &from_ip)
+{
+  ip_text_buffer ipbuff1, ipbuff2;
+
+  // verify that this response came from the correct server
+  if (!ats_ip_addr_eq(&dnsc->ip.sa, &from_ip.sa)) {
+    Warning("unexpected DNS response from %s (expected %s)", ats_ip_ntop(&from_ip.sa, ipbuff1, sizeof ipbuff1),
+            ats_ip_ntop(&dnsc->ip.sa, ipbuff2, sizeof ipbuff2));
+    return false;
+  }
+  buf->packet_size = res;
+  Debug("dns", "received packet size = %d", res);
+  if (dns_ns_rr) {
+    Debug("dns", "round-robin: nameserver %d DNS response code = %d", dnsc->num, get_rcode(buf));
+    if (good_rcode(buf->buf)) {
+      received_one(dnsc->num);
+      if (ns_down[dnsc->num]) {
+        Warning("connection to DNS server %s restored", ats_ip_ntop(&m_res->nsaddr_list[dnsc->num].sa, ipbuff1, sizeof ipbuff1));
+        ns_down[dnsc->num] = 0;
+      }
+    }
+  } else {
+    if (!dnsc->num) {
+      Debug("dns", "primary DNS response code = %d", get_rcode(buf));
+      if (good_rcode(buf->buf)) {
+        if (name_server)
+          recover();
+        else
+          received_one(name_server);
+      }
+    }
+  }
+  Ptr<HostEnt> protect_hostent = make_ptr(buf);
+  if (dns_process(this, buf, res)) {
+    if (dnsc->num == name_server)
+      received_one(name_server);
+  }
+  return true;
+}
+
 void
 DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
   DNSConnection *dnsc = NULL;
-  ip_text_buffer ipbuff1, ipbuff2;
 
   while ((dnsc = (DNSConnection *)triggered.dequeue())) {
     while (1) {
-      IpEndpoint from_ip;
-      socklen_t from_length = sizeof(from_ip);
+      IpEndpoint from_ip[DNS_RECV_BATCH];
 
-      if (!hostent_cache)
-        hostent_cache = dnsBufAllocator.alloc();
-      HostEnt *buf = hostent_cache;
+      for (int i = 0; i < DNS_RECV_BATCH; ++i) {
+        if (!hostent_cache[i])
+          hostent_cache[i] = dnsBufAllocator.alloc();
+      }
 
-      int res = socketManager.recvfrom(dnsc->fd, buf->buf, MAX_DNS_PACKET_LEN, 0, &from_ip.sa, &from_length);
+#if HAVE_RECVMMSG
+      // Drain up to DNS_RECV_BATCH responses with a single system call.
+      struct mmsghdr msgs[DNS_RECV_BATCH];
+      struct iovec iov[DNS_RECV_BATCH];
+
+      memset(msgs, 0, sizeof(msgs));
+      for (int i = 0; i < DNS_RECV_BATCH; ++i) {
+        iov[i].iov_base = hostent_cache[i]->buf;
+        iov[i].iov_len = MAX_DNS_PACKET_LEN;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &from_ip[i].sa;
+        msgs[i].msg_hdr.msg_namelen = sizeof(from_ip[i]);
+      }
 
-      if (res == -EAGAIN)
+      int nmsgs = socketManager.recvmmsg(dnsc->fd, msgs, DNS_RECV_BATCH, 0);
+#else
+      socklen_t from_length = sizeof(from_ip[0]);
+      int nmsgs = socketManager.recvfrom(dnsc->fd, hostent_cache[0]->buf, MAX_DNS_PACKET_LEN, 0, &from_ip[0].sa, &from_length);
+#endif
+
+      if (nmsgs == -EAGAIN)
         break;
-      if (res <= 0) {
-        Debug("dns", "named error: %d", res);
+      if (nmsgs <= 0) {
+        Debug("dns", "named error: %d", nmsgs);
         if (dns_ns_rr)
           rr_failure(dnsc->num);
         else if (dnsc->num == name_server)
@@ -751,41 +847,17 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         break;
       }
 
-      // verify that this response came from the correct server
-      if (!ats_ip_addr_eq(&dnsc->ip.sa, &from_ip.sa)) {
-        Warning("unexpected DNS response from %s (expected %s)", ats_ip_ntop(&from_ip.sa, ipbuff1, sizeof ipbuff1),
-                ats_ip_ntop(&dnsc->ip.sa, ipbuff2, sizeof ipbuff2));
-        continue;
-      }
-      hostent_cache = 0;
-      buf->packet_size = res;
-      Debug("dns", "received packet size = %d", res);
-      if (dns_ns_rr) {
-        Debug("dns", "round-robin: nameserver %d DNS response code = %d", dnsc->num, get_rcode(buf));
-        if (good_rcode(buf->buf)) {
-          received_one(dnsc->num);
-          if (ns_down[dnsc->num]) {
-            Warning("connection to DNS server %s restored",
-                    ats_ip_ntop(&m_res->nsaddr_list[dnsc->num].sa, ipbuff1, sizeof ipbuff1));
-            ns_down[dnsc->num] = 0;
-          }
-        }
-      } else {
-        if (!dnsc->num) {
-          Debug("dns", "primary DNS response code = %d", get_rcode(buf));
-          if (good_rcode(buf->buf)) {
-            if (name_server)
-              recover();
-            else
-              received_one(name_server);
-          }
-        }
-      }
-      Ptr<HostEnt> protect_hostent = make_ptr(buf);
-      if (dns_process(this, buf, res)) {
-        if (dnsc->num == name_server)
-          received_one(name_server);
+#if HAVE_RECVMMSG
+      for (int i = 0; i < nmsgs; ++i) {
+        HostEnt *buf = hostent_cache[i];
+        if (recv_one(dnsc, buf, msgs[i].msg_len, from_ip[i]))
+          hostent_cache[i] = NULL;
       }
+#else
+      HostEnt *buf = hostent_cache[0];
+      if (recv_one(dnsc, buf, nmsgs, from_ip[0]))
+        hostent_cache[0] = NULL;
+#endif
     }
   }
 }
@@ -1102,7 +1174,7 @@ DNSProcessor::getby(const char *x, int len, int type, Continuation *cont, Option
   e->init(x, len, type, cont, opt);
   MUTEX_TRY_LOCK(lock, e->mutex, this_ethread());
   if (!lock.is_locked())
-    thread->schedule_imm(e);
+    (e->dnsH->thread ? e->dnsH->thread : thread)->schedule_imm(e);
   else
     e->handleEvent(EVENT_IMMEDIATE, 0);
   return &e->action;
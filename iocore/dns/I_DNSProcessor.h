@@ -32,6 +32,7 @@
 #define DNS_HOSTBUF_SIZE 8192
 #define DOMAIN_SERVICE_PORT 53
 #define DEFAULT_DOMAIN_NAME_SERVER 0 // use the default server
+#define MAX_DNS_HANDLERS 32          // max resolver threads (proxy.config.dns.dedicated_thread)
 
 
 /**
@@ -121,8 +122,9 @@ struct DNSProcessor : public Processor {
   int start(int no_of_extra_dns_threads = 0, size_t stacksize = DEFAULT_STACKSIZE);
 
   // Open/close a link to a 'named' (done in start())
+  // The handler runs on @a t, or on the first DNS thread if not given.
   //
-  void open(sockaddr const *ns = 0);
+  void open(sockaddr const *ns = 0, EThread *t = 0);
 
   DNSProcessor();
 
@@ -130,6 +132,9 @@ struct DNSProcessor : public Processor {
   //
   EThread *thread;
   DNSHandler *handler;
+  /// Default handlers, one per DNS thread. Each owns its own sockets and query id space.
+  DNSHandler *handlers[MAX_DNS_HANDLERS];
+  int n_handlers;
   ts_imp_res_state l_res;
   IpEndpoint local_ipv6;
   IpEndpoint local_ipv4;
@@ -143,6 +148,12 @@ struct DNSProcessor : public Processor {
    */
   Action *getby(const char *x, int len, int type, Continuation *cont, Options const &opt);
 
+  /** Pick the default handler for a query.
+      Queries for the same name always map to the same handler so that
+      duplicate requests are still collapsed.
+   */
+  DNSHandler *select_handler(const char *qname, int len);
+
   void dns_init();
 };
 
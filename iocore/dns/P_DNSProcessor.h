@@ -45,6 +45,12 @@
 #define DEFAULT_DNS_SEARCH 1
 #define FAILOVER_SOON_RETRY 5
 #define NO_NAMESERVER_SELECTED -1
+// how many responses to pull off a nameserver socket per recvmmsg() call
+#if HAVE_RECVMMSG
+#define DNS_RECV_BATCH 16
+#else
+#define DNS_RECV_BATCH 1
+#endif
 
 //
 // Config
@@ -200,7 +206,8 @@ struct DNSHandler : public Continuation {
   int in_flight;
   int name_server;
   int in_write_dns;
-  HostEnt *hostent_cache;
+  HostEnt *hostent_cache[DNS_RECV_BATCH];
+  EThread *thread; ///< Thread owning the connections, NULL means the first DNS thread.
 
   int ns_down[MAX_NAMED];
   int failover_number[MAX_NAMED];
@@ -252,6 +259,7 @@ struct DNSHandler : public Continuation {
   }
 
   void recv_dns(int event, Event *e);
+  bool recv_one(DNSConnection *dnsc, HostEnt *buf, int len, IpEndpoint const &from_ip);
   int startEvent(int event, Event *e);
   int startEvent_sdns(int event, Event *e);
   int mainEvent(int event, Event *e);
@@ -317,9 +325,10 @@ struct DNSServer {
 
 TS_INLINE
 DNSHandler::DNSHandler()
-  : Continuation(NULL), n_con(0), in_flight(0), name_server(0), in_write_dns(0), hostent_cache(0), last_primary_retry(0),
+  : Continuation(NULL), n_con(0), in_flight(0), name_server(0), in_write_dns(0), thread(NULL), last_primary_retry(0),
     last_primary_reopen(0), m_res(0), txn_lookup_timeout(0), generator((uint32_t)((uintptr_t)time(NULL) ^ (uintptr_t) this))
 {
+  memset(hostent_cache, 0, sizeof(hostent_cache));
   ats_ip_invalidate(&ip);
   for (int i = 0; i < MAX_NAMED; i++) {
     ifd[i] = -1;
@@ -30,6 +30,33 @@
 
 #include "P_EventSystem.h"
 
+static RecRawStatBlock *iobuffer_rsb;
+
+// Two stats per size class, the bytes allocated for it and the bytes in use.
+static int
+iobuffer_stat_sync(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
+{
+  const InkFreeList *fl = ioBufAllocator[id / 2].freelist();
+
+  RecSetRawStatSum(rsb, id, (int64_t)(id % 2 ? fl->used : fl->allocated) * fl->type_size);
+  return RecRawStatSyncSum(name, data_type, data, rsb, id);
+}
+
+static void
+register_iobuffer_stats()
+{
+  iobuffer_rsb = RecAllocateRawStatBlock(DEFAULT_BUFFER_SIZES * 2);
+
+  for (int i = 0; i < DEFAULT_BUFFER_SIZES; i++) {
+    char name[64];
+
+    snprintf(name, sizeof(name), "proxy.process.iobuffer.%" PRId64 ".allocated", (int64_t)BUFFER_SIZE_FOR_INDEX(i));
+    RecRegisterRawStat(iobuffer_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i * 2, iobuffer_stat_sync);
+    snprintf(name, sizeof(name), "proxy.process.iobuffer.%" PRId64 ".in_use", (int64_t)BUFFER_SIZE_FOR_INDEX(i));
+    RecRegisterRawStat(iobuffer_rsb, RECT_PROCESS, name, RECD_INT, RECP_NON_PERSISTENT, i * 2 + 1, iobuffer_stat_sync);
+  }
+}
+
 void
 ink_event_system_init(ModuleVersion v)
 {
@@ -50,4 +77,5 @@ ink_event_system_init(ModuleVersion v)
   if (default_large_iobuffer_size > max_iobuffer_size)
     default_large_iobuffer_size = max_iobuffer_size;
   init_buffer_allocators();
+  register_iobuffer_stats();
 }
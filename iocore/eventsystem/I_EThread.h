@@ -310,6 +310,7 @@ public:
   void process_event(Event *e, int calling_code);
   void free_event(Event *e);
   void (*signal_hook)(EThread *);
+  volatile int signal_pending; ///< A wakeup has been posted to signal_hook and not yet consumed.
 
 #if HAVE_EVENTFD
   int evfd;
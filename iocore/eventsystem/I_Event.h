@@ -212,6 +212,7 @@ public:
   unsigned int immediate : 1;
   unsigned int globally_allocated : 1;
   unsigned int in_heap : 4;
+  unsigned int in_slot : 8;
   int callback_event;
 
   ink_hrtime timeout_at;
@@ -1128,6 +1128,23 @@ public:
     water_mark = 0;
   }
 
+  /**
+    Frees the blocks of a buffer with no data left on it, keeping its
+    readers and size_index. The next write_avail() allocates a new block,
+    so an idle buffer costs no block memory until it is written again.
+
+  */
+  void
+  release_blocks()
+  {
+    ink_assert(max_read_avail() == 0);
+    _writer = NULL;
+    for (int j = 0; j < MAX_MIOBUFFER_READERS; j++)
+      if (readers[j].allocated()) {
+        readers[j].reset();
+      }
+  }
+
   void
   realloc(int64_t i)
   {
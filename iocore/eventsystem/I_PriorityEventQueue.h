@@ -28,63 +28,72 @@
 #include "I_Event.h"
 
 
-// <5ms, 10, 20, 40, 80, 160, 320, 640, 1280, 2560, 5120
-#define N_PQ_LIST 10
-#define PQ_BUCKET_TIME(_i) (HRTIME_MSECONDS(5) << (_i))
+// Hierarchical timing wheel. Level 0 has one slot per tick, each higher
+// level has a slot per revolution of the level below it:
+//   level 0: 256 x 5ms    (1.28s)
+//   level 1:  64 x 1.28s  (81.9s)
+//   level 2:  64 x 81.9s  (87.4m)
+//   level 3:  64 x 87.4m  (3.9d)
+// and anything further out sits on an overflow list. Slots are indexed by
+// absolute tick, so insert and cancel are O(1) and an event is only touched
+// again when its slot cascades down a level.
+#define PQ_TICK HRTIME_MSECONDS(5)
+#define PQ_L0_BITS 8
+#define PQ_LN_BITS 6
+#define PQ_LEVELS 4
+#define PQ_OVERFLOW PQ_LEVELS      // in_heap value for events on the overflow list
+#define PQ_READY (PQ_LEVELS + 1)   // in_heap value for events on the ready list
+#define PQ_L0_SLOTS (1 << PQ_L0_BITS)
+#define PQ_LN_SLOTS (1 << PQ_LN_BITS)
+#define PQ_LEVEL_SHIFT(_l) ((_l) ? PQ_L0_BITS + ((_l)-1) * PQ_LN_BITS : 0)
+#define PQ_LEVEL_SLOTS(_l) ((_l) ? PQ_LN_SLOTS : PQ_L0_SLOTS)
 
 class EThread;
 
 struct PriorityEventQueue {
-  Que(Event, link) after[N_PQ_LIST];
+  Que(Event, link) ready;
+  Que(Event, link) wheel0[PQ_L0_SLOTS];
+  Que(Event, link) wheel[PQ_LEVELS - 1][PQ_LN_SLOTS];
+  Que(Event, link) overflow;
+  uint64_t occupied[PQ_L0_SLOTS / 64]; ///< Non-empty level 0 slots.
+  uint32_t n_upper;                    ///< Events above level 0, including overflow.
   ink_hrtime last_check_time;
-  uint32_t last_check_buckets;
+  uint64_t cur_tick; ///< Last tick expired by check_ready().
+
+  Que(Event, link) &
+  slot(int level, uint32_t i)
+  {
+    return level ? wheel[level - 1][i] : wheel0[i];
+  }
 
   void
   enqueue(Event *e, ink_hrtime now)
   {
-    ink_hrtime t = e->timeout_at - now;
-    int i = 0;
-    // equivalent but faster
-    if (t <= PQ_BUCKET_TIME(3)) {
-      if (t <= PQ_BUCKET_TIME(1)) {
-        if (t <= PQ_BUCKET_TIME(0)) {
-          i = 0;
-        } else {
-          i = 1;
-        }
-      } else {
-        if (t <= PQ_BUCKET_TIME(2)) {
-          i = 2;
-        } else {
-          i = 3;
-        }
-      }
-    } else {
-      if (t <= PQ_BUCKET_TIME(7)) {
-        if (t <= PQ_BUCKET_TIME(5)) {
-          if (t <= PQ_BUCKET_TIME(4)) {
-            i = 4;
-          } else {
-            i = 5;
-          }
-        } else {
-          if (t <= PQ_BUCKET_TIME(6)) {
-            i = 6;
-          } else {
-            i = 7;
-          }
-        }
-      } else {
-        if (t <= PQ_BUCKET_TIME(8)) {
-          i = 8;
-        } else {
-          i = 9;
-        }
+    uint64_t et = e->timeout_at / PQ_TICK;
+
+    e->in_the_priority_queue = 1;
+    if (e->timeout_at <= now || et <= cur_tick) {
+      e->in_heap = PQ_READY;
+      ready.enqueue(e);
+      return;
+    }
+    for (int l = 0; l < PQ_LEVELS; l++) {
+      int shift = PQ_LEVEL_SHIFT(l);
+      if ((et >> shift) - (cur_tick >> shift) < (uint64_t)PQ_LEVEL_SLOTS(l)) {
+        uint32_t i = (uint32_t)(et >> shift) & (PQ_LEVEL_SLOTS(l) - 1);
+        e->in_heap = l;
+        e->in_slot = i;
+        slot(l, i).enqueue(e);
+        if (l)
+          ++n_upper;
+        else
+          occupied[i >> 6] |= 1ULL << (i & 63);
+        return;
       }
     }
-    e->in_the_priority_queue = 1;
-    e->in_heap = i;
-    after[i].enqueue(e);
+    e->in_heap = PQ_OVERFLOW;
+    overflow.enqueue(e);
+    ++n_upper;
   }
 
   void
@@ -92,14 +101,26 @@ struct PriorityEventQueue {
   {
     ink_assert(e->in_the_priority_queue);
     e->in_the_priority_queue = 0;
-    after[e->in_heap].remove(e);
+    if (e->in_heap == PQ_READY) {
+      ready.remove(e);
+    } else if (e->in_heap == PQ_OVERFLOW) {
+      overflow.remove(e);
+      --n_upper;
+    } else {
+      Que(Event, link) &q = slot(e->in_heap, e->in_slot);
+      q.remove(e);
+      if (e->in_heap)
+        --n_upper;
+      else if (!q.head)
+        occupied[e->in_slot >> 6] &= ~(1ULL << (e->in_slot & 63));
+    }
   }
 
   Event *
   dequeue_ready(ink_hrtime t)
   {
     (void)t;
-    Event *e = after[0].dequeue();
+    Event *e = ready.dequeue();
     if (e) {
       ink_assert(e->in_the_priority_queue);
       e->in_the_priority_queue = 0;
@@ -109,17 +130,12 @@ struct PriorityEventQueue {
 
   void check_ready(ink_hrtime now, EThread *t);
 
-  ink_hrtime
-  earliest_timeout()
-  {
-    for (int i = 0; i < N_PQ_LIST; i++) {
-      if (after[i].head)
-        return last_check_time + (PQ_BUCKET_TIME(i) / 2);
-    }
-    return last_check_time + HRTIME_FOREVER;
-  }
+  ink_hrtime earliest_timeout();
 
   PriorityEventQueue();
+
+private:
+  void cascade(Que(Event, link) & q, ink_hrtime now, EThread *t);
 };
 
 #endif
@@ -29,6 +29,8 @@
   (2). In case the queue is empty, dequeue() sleeps for a specified
        amount of time, or until a new element is inserted, whichever
        is earlier
+  (3). Enqueue is lock free. The mutex and condition variable are only
+       touched when the consumer is actually blocked in dequeue_timed().
 
 
  ****************************************************************************/
@@ -50,6 +52,8 @@ struct ProtectedQueue {
   ink_mutex lock;
   ink_cond might_have_data;
   Que(Event, link) localQueue;
+  volatile int waiting; ///< Consumer is blocked, or about to block, on might_have_data.
+  int spin;             ///< Polls of al before blocking, adapted to how quickly events arrive.
 
   ProtectedQueue();
 };
@@ -65,6 +65,10 @@ struct SocketManager {
 
   int recv(int s, void *buf, int len, int flags);
   int recvfrom(int fd, void *buf, int size, int flags, struct sockaddr *addr, socklen_t *addrlen);
+#if HAVE_RECVMMSG
+  // result is the number of messages or -errno
+  int recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags);
+#endif
 
   int64_t write(int fd, void *buf, int len, void *pOLP = NULL);
   int64_t writev(int fd, struct iovec *vector, size_t count);
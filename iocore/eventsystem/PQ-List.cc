@@ -23,41 +23,84 @@
 
 #include "P_EventSystem.h"
 
-PriorityEventQueue::PriorityEventQueue()
+PriorityEventQueue::PriorityEventQueue() : n_upper(0)
 {
+  memset(occupied, 0, sizeof(occupied));
   last_check_time = ink_get_based_hrtime_internal();
-  last_check_buckets = last_check_time / PQ_BUCKET_TIME(0);
+  cur_tick = last_check_time / PQ_TICK;
+}
+
+// Re-file the events of a higher level slot which has come due.
+void
+PriorityEventQueue::cascade(Que(Event, link) & q, ink_hrtime now, EThread *t)
+{
+  Event *e;
+  Que(Event, link) todo = q;
+
+  q.clear();
+  while ((e = todo.dequeue()) != NULL) {
+    --n_upper;
+    if (e->cancelled) {
+      e->in_the_priority_queue = 0;
+      e->cancelled = 0;
+      EVENT_FREE(e, eventAllocator, t);
+    } else {
+      enqueue(e, now);
+    }
+  }
 }
 
 void
 PriorityEventQueue::check_ready(ink_hrtime now, EThread *t)
 {
-  int i, j, k = 0;
-  uint32_t check_buckets = (uint32_t)(now / PQ_BUCKET_TIME(0));
-  uint32_t todo_buckets = check_buckets ^ last_check_buckets;
+  uint64_t now_tick = now / PQ_TICK;
+
   last_check_time = now;
-  last_check_buckets = check_buckets;
-  todo_buckets &= ((1 << (N_PQ_LIST - 1)) - 1);
-  while (todo_buckets) {
-    k++;
-    todo_buckets >>= 1;
-  }
-  for (i = 1; i <= k; i++) {
-    Event *e;
-    Que(Event, link) q = after[i];
-    after[i].clear();
-    while ((e = q.dequeue()) != NULL) {
-      if (e->cancelled) {
-        e->in_the_priority_queue = 0;
-        e->cancelled = 0;
-        EVENT_FREE(e, eventAllocator, t);
-      } else {
-        ink_hrtime tt = e->timeout_at - now;
-        for (j = i; j > 0 && tt <= PQ_BUCKET_TIME(j - 1);)
-          j--;
-        e->in_heap = j;
-        after[j].enqueue(e);
+  while (cur_tick < now_tick) {
+    ++cur_tick;
+    if (n_upper) {
+      if (!(cur_tick & ((1ULL << PQ_LEVEL_SHIFT(PQ_LEVELS)) - 1)))
+        cascade(overflow, now, t);
+      for (int l = PQ_LEVELS - 1; l > 0; l--) {
+        if (!(cur_tick & ((1ULL << PQ_LEVEL_SHIFT(l)) - 1)))
+          cascade(slot(l, (uint32_t)(cur_tick >> PQ_LEVEL_SHIFT(l)) & (PQ_LN_SLOTS - 1)), now, t);
       }
     }
+
+    uint32_t i = (uint32_t)cur_tick & (PQ_L0_SLOTS - 1);
+    if (occupied[i >> 6] & (1ULL << (i & 63))) {
+      for (Event *e = wheel0[i].head; e; e = e->link.next)
+        e->in_heap = PQ_READY;
+      ready.append(wheel0[i]);
+      wheel0[i].clear();
+      occupied[i >> 6] &= ~(1ULL << (i & 63));
+    }
   }
 }
+
+ink_hrtime
+PriorityEventQueue::earliest_timeout()
+{
+  if (ready.head)
+    return last_check_time;
+
+  // Events on higher levels can't fire before the next cascade.
+  uint64_t next_tick = n_upper ? ((cur_tick >> PQ_L0_BITS) + 1) << PQ_L0_BITS : 0;
+
+  // Find the next occupied level 0 slot, skipping empty 64 slot words.
+  for (uint32_t d = 1; d < PQ_L0_SLOTS;) {
+    uint32_t i = (uint32_t)(cur_tick + d) & (PQ_L0_SLOTS - 1);
+    uint64_t w = occupied[i >> 6] >> (i & 63);
+    if (w) {
+      d += __builtin_ctzll(w);
+      if (d < PQ_L0_SLOTS && (!next_tick || cur_tick + d < next_tick))
+        next_tick = cur_tick + d;
+      break;
+    }
+    d += 64 - (i & 63);
+  }
+
+  if (next_tick)
+    return (ink_hrtime)next_tick * PQ_TICK;
+  return last_check_time + HRTIME_FOREVER;
+}
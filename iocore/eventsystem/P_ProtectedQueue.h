@@ -34,7 +34,7 @@
 
 
 TS_INLINE
-ProtectedQueue::ProtectedQueue()
+ProtectedQueue::ProtectedQueue() : waiting(0), spin(0)
 {
   Event e;
   ink_mutex_init(&lock, "ProtectedQueue");
@@ -45,6 +45,11 @@ ProtectedQueue::ProtectedQueue()
 TS_INLINE void
 ProtectedQueue::signal()
 {
+  // Only a consumer blocked in dequeue_timed() needs the condition
+  // variable. The push onto al is a full barrier, so either we see
+  // waiting set here or the consumer sees the event before it blocks.
+  if (!waiting)
+    return;
   // Need to get the lock before you can signal the thread
   ink_mutex_acquire(&lock);
   ink_cond_signal(&might_have_data);
@@ -54,6 +59,8 @@ ProtectedQueue::signal()
 TS_INLINE int
 ProtectedQueue::try_signal()
 {
+  if (!waiting)
+    return 1;
   // Need to get the lock before you can signal the thread
   if (ink_mutex_try_acquire(&lock)) {
     ink_cond_signal(&might_have_data);
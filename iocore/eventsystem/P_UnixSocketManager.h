@@ -196,6 +196,20 @@ SocketManager::recvfrom(int fd, void *buf, int size, int flags, struct sockaddr
   return r;
 }
 
+#if HAVE_RECVMMSG
+TS_INLINE int
+SocketManager::recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags)
+{
+  int r;
+  do {
+    r = ::recvmmsg(fd, msgvec, vlen, flags, NULL);
+    if (unlikely(r < 0))
+      r = -errno;
+  } while (r == -EINTR);
+  return r;
+}
+#endif
+
 TS_INLINE int64_t
 SocketManager::write(int fd, void *buf, int size, void * /* pOLP ATS_UNUSED */)
 {
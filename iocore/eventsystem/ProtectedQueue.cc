@@ -44,6 +44,25 @@
 
 extern ClassAllocator<Event> eventAllocator;
 
+// Before blocking on the condition variable, dequeue_timed() polls the
+// queue for up to this many iterations. The actual count adapts: it grows
+// when events tend to arrive right after the thread goes to sleep and
+// decays when spinning does not pay off.
+#define MAX_SPIN_BEFORE_SLEEP 2048
+#define MIN_SPIN_BEFORE_SLEEP 16
+// A wakeup within this long of blocking means spinning would have caught it.
+#define SPIN_WORTHWHILE_PERIOD HRTIME_USECONDS(50)
+
+static inline void
+cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__("pause");
+#else
+  __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
 void
 ProtectedQueue::enqueue(Event *e, bool fast_signal)
 {
@@ -142,13 +161,29 @@ ProtectedQueue::dequeue_timed(ink_hrtime cur_time, ink_hrtime timeout, bool slee
 {
   (void)cur_time;
   Event *e;
-  if (sleep) {
-    ink_mutex_acquire(&lock);
-    if (INK_ATOMICLIST_EMPTY(al)) {
-      timespec ts = ink_hrtime_to_timespec(timeout);
-      ink_cond_timedwait(&might_have_data, &lock, &ts);
+  if (sleep && INK_ATOMICLIST_EMPTY(al)) {
+    int i = 0;
+    while (i < spin && INK_ATOMICLIST_EMPTY(al)) {
+      cpu_relax();
+      ++i;
+    }
+    if (i < spin) {
+      // Spinning caught an event, keep doing it.
+      spin = MIN(spin * 2, MAX_SPIN_BEFORE_SLEEP);
+    } else {
+      spin /= 2;
+      ink_mutex_acquire(&lock);
+      ink_atomic_swap(&waiting, 1);
+      if (INK_ATOMICLIST_EMPTY(al)) {
+        ink_hrtime start = ink_get_hrtime_internal();
+        timespec ts = ink_hrtime_to_timespec(timeout);
+        ink_cond_timedwait(&might_have_data, &lock, &ts);
+        if (!INK_ATOMICLIST_EMPTY(al) && ink_get_hrtime_internal() - start < SPIN_WORTHWHILE_PERIOD)
+          spin = MAX(spin * 2, MIN_SPIN_BEFORE_SLEEP);
+      }
+      waiting = 0;
+      ink_mutex_release(&lock);
     }
-    ink_mutex_release(&lock);
   }
 
   e = (Event *)ink_atomiclist_popall(&al);
@@ -56,6 +56,58 @@ struct process_killer : public Continuation {
   }
 };
 
+// Load the timing wheel with a large number of connection style timeouts,
+// cancel half of them and expire the rest, checking that nothing fires
+// more than a tick away from its deadline.
+#define TEST_PQ_EVENTS 2000000
+#define TEST_PQ_RANGE_SECONDS 600
+
+static bool
+test_priority_queue()
+{
+  PriorityEventQueue *pq = new PriorityEventQueue;
+  Event **events = (Event **)ats_malloc(TEST_PQ_EVENTS * sizeof(Event *));
+  ink_hrtime now = pq->last_check_time;
+  ink_hrtime end = now + HRTIME_SECONDS(TEST_PQ_RANGE_SECONDS + 2);
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+  int fired = 0, bad = 0;
+
+  for (int i = 0; i < TEST_PQ_EVENTS; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    events[i] = eventAllocator.alloc();
+    events[i]->timeout_at = now + HRTIME_SECONDS(1) + (ink_hrtime)((seed >> 16) % HRTIME_SECONDS(TEST_PQ_RANGE_SECONDS));
+  }
+
+  ink_hrtime start = ink_get_hrtime_internal();
+  for (int i = 0; i < TEST_PQ_EVENTS; i++)
+    pq->enqueue(events[i], now);
+  ink_hrtime inserted = ink_get_hrtime_internal();
+  for (int i = 0; i < TEST_PQ_EVENTS; i += 2)
+    pq->remove(events[i]);
+  ink_hrtime removed = ink_get_hrtime_internal();
+  for (; now < end; now += PQ_TICK) {
+    Event *e;
+    pq->check_ready(now, NULL);
+    while ((e = pq->dequeue_ready(now))) {
+      if (e->timeout_at >= now + PQ_TICK || e->timeout_at < now - PQ_TICK)
+        ++bad;
+      ++fired;
+    }
+  }
+  ink_hrtime expired = ink_get_hrtime_internal();
+
+  printf("PriorityEventQueue: %d events, insert %.1f ns/event, cancel %.1f ns/event, expire %.1f ms total\n", TEST_PQ_EVENTS,
+         (double)(inserted - start) / TEST_PQ_EVENTS, (double)(removed - inserted) / (TEST_PQ_EVENTS / 2),
+         (double)(expired - removed) / HRTIME_MSECOND);
+  printf("PriorityEventQueue: fired %d of %d, %d outside their tick\n", fired, TEST_PQ_EVENTS / 2, bad);
+
+  for (int i = 0; i < TEST_PQ_EVENTS; i++)
+    eventAllocator.free(events[i]);
+  ats_free(events);
+  delete pq;
+  return fired == TEST_PQ_EVENTS / 2 && bad == 0;
+}
+
 int
 main(int /* argc ATS_UNUSED */, const char * /* argv ATS_UNUSED */ [])
 {
@@ -67,6 +119,8 @@ main(int /* argc ATS_UNUSED */, const char * /* argv ATS_UNUSED */ [])
   RecProcessInit(mode_type);
 
   ink_event_system_init(EVENT_SYSTEM_MODULE_VERSION);
+  if (!test_priority_queue())
+    exit(1);
   eventProcessor.start(TEST_THREADS, 1048576); // Hardcoded stacksize at 1MB
 
   alarm_printer *alrm = new alarm_printer(new_ProxyMutex());
@@ -151,11 +151,12 @@ add_http_filter(int fd ATS_UNUSED)
 }
 
 int
-Server::setup_fd_for_listen(bool non_blocking, int recv_bufsize, int send_bufsize, bool transparent)
+Server::setup_fd_for_listen(bool non_blocking, int recv_bufsize, int send_bufsize, bool transparent, uint32_t sockopt_flags)
 {
   int res = 0;
   int sockopt_flag_in = 0;
   REC_ReadConfigInteger(sockopt_flag_in, "proxy.config.net.sock_option_flag_in");
+  sockopt_flag_in |= sockopt_flags;
 
 #ifdef TCP_FASTOPEN
   int tfo_queue_length = 0;
@@ -238,6 +239,12 @@ Server::setup_fd_for_listen(bool non_blocking, int recv_bufsize, int send_bufsiz
     goto Lerror;
   }
 
+#ifdef SO_REUSEPORT
+  if (f_reuse_port && (res = safe_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, SOCKOPT_ON, sizeof(int))) < 0) {
+    goto Lerror;
+  }
+#endif
+
   if ((sockopt_flag_in & NetVCOptions::SOCK_OPT_NO_DELAY) &&
       (res = safe_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, SOCKOPT_ON, sizeof(int))) < 0) {
     goto Lerror;
@@ -254,6 +261,10 @@ Server::setup_fd_for_listen(bool non_blocking, int recv_bufsize, int send_bufsiz
       (res = safe_setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, (char *)&tfo_queue_length, sizeof(int)))) {
     goto Lerror;
   }
+#else
+  if (sockopt_flag_in & NetVCOptions::SOCK_OPT_TCP_FAST_OPEN) {
+    Warning("TCP Fast Open requested on port %d but it is not supported on this platform", ats_ip_port_host_order(&accept_addr));
+  }
 #endif
 
   if (transparent) {
@@ -298,7 +309,7 @@ Lerror:
 
 
 int
-Server::listen(bool non_blocking, int recv_bufsize, int send_bufsize, bool transparent)
+Server::listen(bool non_blocking, int recv_bufsize, int send_bufsize, bool transparent, uint32_t sockopt_flags)
 {
   ink_assert(fd == NO_FD);
   int res = 0;
@@ -315,7 +326,7 @@ Server::listen(bool non_blocking, int recv_bufsize, int send_bufsize, bool trans
     goto Lerror;
   }
 
-  res = setup_fd_for_listen(non_blocking, recv_bufsize, send_bufsize, transparent);
+  res = setup_fd_for_listen(non_blocking, recv_bufsize, send_bufsize, transparent, sockopt_flags);
   if (res < 0) {
     goto Lerror;
   }
@@ -135,6 +135,9 @@ register_net_stats()
   RecRegisterRawStat(net_rsb, RECT_PROCESS, "proxy.process.net.default_inactivity_timeout_applied", RECD_INT, RECP_NON_PERSISTENT,
                      (int)default_inactivity_timeout_stat, RecRawStatSyncSum);
   NET_CLEAR_DYN_STAT(default_inactivity_timeout_stat);
+
+  RecRegisterRawStat(net_rsb, RECT_PROCESS, "proxy.process.net.fastopen_out.attempts", RECD_INT, RECP_PERSISTENT,
+                     (int)net_fastopen_out_attempts_stat, RecRawStatSyncSum);
 }
 
 void
@@ -360,38 +360,51 @@ err:
   goto done;
 }
 
-void
-ocsp_update()
+static void
+ocsp_update_context(SSL_CTX *ctx)
 {
-  SSL_CTX *ctx;
   certinfo *cinf = NULL;
   OCSP_RESPONSE *resp = NULL;
   time_t current_time;
 
+  cinf = stapling_get_cert_info(ctx);
+  if (cinf) {
+    ink_mutex_acquire(&cinf->stapling_mutex);
+    current_time = time(NULL);
+    if (cinf->resp_derlen == 0 || cinf->is_expire || cinf->expire_time < current_time) {
+      ink_mutex_release(&cinf->stapling_mutex);
+      if (stapling_refresh_response(cinf, &resp)) {
+        Note("Success to refresh OCSP response for 1 certificate.");
+      } else {
+        Note("Fail to refresh OCSP response for 1 certificate.");
+      }
+    } else {
+      ink_mutex_release(&cinf->stapling_mutex);
+    }
+  }
+}
+
+void
+ocsp_update()
+{
   SSLCertificateConfig::scoped_config certLookup;
   const unsigned ctxCount = certLookup->count();
 
   for (unsigned i = 0; i < ctxCount; i++) {
     SSLCertContext *cc = certLookup->get(i);
     if (cc && cc->ctx) {
-      ctx = cc->ctx;
-      cinf = stapling_get_cert_info(ctx);
-      if (cinf) {
-        ink_mutex_acquire(&cinf->stapling_mutex);
-        current_time = time(NULL);
-        if (cinf->resp_derlen == 0 || cinf->is_expire || cinf->expire_time < current_time) {
-          ink_mutex_release(&cinf->stapling_mutex);
-          if (stapling_refresh_response(cinf, &resp)) {
-            Note("Success to refresh OCSP response for 1 certificate.");
-          } else {
-            Note("Fail to refresh OCSP response for 1 certificate.");
-          }
-        } else {
-          ink_mutex_release(&cinf->stapling_mutex);
-        }
-      }
+      ocsp_update_context(cc->ctx);
     }
   }
+
+  // Lazily loaded certificates are only refreshed while their context is built, the references
+  // keep them from being freed in the meantime.
+  Vec<SSL_CTX *> lazy_ctxs;
+  certLookup->acquireLazyContexts(lazy_ctxs);
+  for (unsigned i = 0; i < lazy_ctxs.length(); i++) {
+    ocsp_update_context(lazy_ctxs[i]);
+    SSL_CTX_free(lazy_ctxs[i]);
+  }
 }
 
 // RFC 6066 Section-8: Certificate Status Request
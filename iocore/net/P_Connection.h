@@ -168,6 +168,9 @@ struct Server : public Connection {
   /// If set, a kernel HTTP accept filter
   bool http_accept_filter;
 
+  /// If set, the listen socket may share its port with others (SO_REUSEPORT).
+  bool f_reuse_port;
+
   //
   // Use this call for the main proxy accept
   //
@@ -181,12 +184,14 @@ struct Server : public Connection {
   // converted into network byte order
   //
 
-  int listen(bool non_blocking = false, int recv_bufsize = 0, int send_bufsize = 0, bool transparent = false);
+  int listen(bool non_blocking = false, int recv_bufsize = 0, int send_bufsize = 0, bool transparent = false,
+             uint32_t sockopt_flags = 0);
   int setup_fd_for_listen(bool non_blocking = false, int recv_bufsize = 0, int send_bufsize = 0,
-                          bool transparent = false ///< Inbound transparent.
+                          bool transparent = false, ///< Inbound transparent.
+                          uint32_t sockopt_flags = 0 ///< Port NetVCOptions flags, added to sock_option_flag_in.
                           );
 
-  Server() : Connection(), f_inbound_transparent(false) { ink_zero(accept_addr); }
+  Server() : Connection(), f_inbound_transparent(false), f_reuse_port(false) { ink_zero(accept_addr); }
 };
 
 #endif /*_Connection_h*/
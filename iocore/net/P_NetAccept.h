@@ -92,6 +92,7 @@ struct NetAccept : public Continuation {
   uint32_t packet_mark;
   uint32_t packet_tos;
   EventType etype;
+  int listen_per_thread;        // 0 shared socket, 1 a socket per thread, 2 and steered by CPU
   UnixNetVConnection *epoll_vc; // only storage for epoll events
   EventIO ep;
 
@@ -104,6 +105,8 @@ struct NetAccept : public Continuation {
   virtual NetAccept *clone() const;
   // 0 == success
   int do_listen(bool non_blocking, bool transparent = false);
+  bool listen_reuse_port(bool transparent);
+  void steer_by_cpu(int n);
 
   int do_blocking_accept(EThread *t);
   virtual int acceptEvent(int event, void *e);
@@ -29,6 +29,7 @@
 
 struct SSLConfigParams;
 struct SSLContextStorage;
+struct SSLLazyContext;
 
 struct ssl_ticket_key_t {
   unsigned char key_name[16];
@@ -51,6 +52,7 @@ struct ssl_ticket_key_block {
     Instances of this class are stored on a list and then referenced via index in that list so that
     there is exactly one place we can find all the @c SSL_CTX instances exactly once.
 
+    Contexts of lazily loaded certificates have no @c SSL_CTX, only the @a lazy entry it is built from.
 */
 struct SSLCertContext {
   /** Special things to do instead of use a context.
@@ -62,15 +64,56 @@ struct SSLCertContext {
     OPT_TUNNEL ///< Just tunnel, don't terminate.
   };
 
-  SSLCertContext() : ctx(0), opt(OPT_NONE), keyblock(NULL) {}
-  explicit SSLCertContext(SSL_CTX *c) : ctx(c), opt(OPT_NONE), keyblock(NULL) {}
-  SSLCertContext(SSL_CTX *c, Option o) : ctx(c), opt(o), keyblock(NULL) {}
-  SSLCertContext(SSL_CTX *c, Option o, ssl_ticket_key_block *kb) : ctx(c), opt(o), keyblock(kb) {}
+  SSLCertContext() : ctx(0), opt(OPT_NONE), keyblock(NULL), lazy(NULL) {}
+  explicit SSLCertContext(SSL_CTX *c) : ctx(c), opt(OPT_NONE), keyblock(NULL), lazy(NULL) {}
+  SSLCertContext(SSL_CTX *c, Option o) : ctx(c), opt(o), keyblock(NULL), lazy(NULL) {}
+  SSLCertContext(SSL_CTX *c, Option o, ssl_ticket_key_block *kb) : ctx(c), opt(o), keyblock(kb), lazy(NULL) {}
+  SSLCertContext(SSLLazyContext *l, Option o) : ctx(0), opt(o), keyblock(NULL), lazy(l) {}
   void release();
 
   SSL_CTX *ctx;                   ///< openSSL context.
   Option opt;                     ///< Special handling option.
   ssl_ticket_key_block *keyblock; ///< session keys associated with this address
+  SSLLazyContext *lazy;           ///< builds the context on first use, owned by the lookup
+};
+
+// gather user provided settings from ssl_multicert.config in to a single struct
+struct ssl_user_config {
+  ssl_user_config() : session_ticket_enabled(1), opt(SSLCertContext::OPT_NONE) {}
+
+  int session_ticket_enabled; // ssl_ticket_enabled - session ticket enabled
+  ats_scoped_str addr;        // dest_ip - IPv[64] address to match
+  ats_scoped_str cert;        // ssl_cert_name - certificate
+  ats_scoped_str first_cert;  // the first certificate name when multiple cert files are in 'ssl_cert_name'
+  ats_scoped_str ca;          // ssl_ca_name - CA public certificate
+  ats_scoped_str key;         // ssl_key_name - Private key
+  ats_scoped_str
+    ticket_key_filename; // ticket_key_name - session key file. [key_name (16Byte) + HMAC_secret (16Byte) + AES_key (16Byte)]
+  ats_scoped_str dialog; // ssl_key_dialog - Private key dialog
+  SSLCertContext::Option opt;
+};
+
+/** An ssl_multicert line whose @c SSL_CTX is built by the first handshake that selects one of its names.
+
+    Only lines without a dest_ip are loaded lazily. At load time just the certificates are read, to
+    index their names, and the line settings are kept here. Every name of the line refers to the
+    same instance.
+
+    The context is built, selected and freed with @a mutex held, and connections take their own
+    reference with @c SSL_set_SSL_CTX so a context can be freed again as soon as it goes cold.
+*/
+struct SSLLazyContext {
+  explicit SSLLazyContext(ssl_user_config *s);
+  ~SSLLazyContext();
+
+  /// @return A new reference to the context if it is built, or @c NULL. The caller must @c SSL_CTX_free it.
+  SSL_CTX *acquire();
+
+  ats_scoped_obj<ssl_user_config> settings;
+  ink_mutex mutex;
+  SSL_CTX *ctx;             ///< @c NULL until built, and again once freed
+  volatile bool referenced; ///< selected since the clock hand last passed it
+  bool failed;              ///< building failed, don't retry until the next reload
 };
 
 struct SSLCertLookup : public ConfigInfo {
@@ -105,8 +148,27 @@ struct SSLCertLookup : public ConfigInfo {
   unsigned count() const;
   SSLCertContext *get(unsigned i) const;
 
+  /** Account for the newly built context of @a lazy.
+      If more than @a lazy_max contexts are now built, the coldest ones are freed again. A second
+      chance clock over the built contexts approximates least recently used.
+  */
+  void lazyContextBuilt(SSLLazyContext *lazy) const;
+
+  /// Add a reference to every built lazy context to @a ctxs. The caller must @c SSL_CTX_free them.
+  void acquireLazyContexts(Vec<SSL_CTX *> &ctxs) const;
+
+  Vec<SSLLazyContext *> lazy_contexts; ///< every lazily loaded line, freed with the lookup
+  unsigned lazy_max;                   ///< proxy.config.ssl.server.multicert.lazy_max_contexts
+
   SSLCertLookup();
   virtual ~SSLCertLookup();
+
+private:
+  // Building a context doesn't change what the lookup selects, so this is kept up to date through
+  // the const lookup that the handshakes share.
+  mutable ink_mutex lazy_mutex;            ///< held to change @a lazy_live
+  mutable Vec<SSLLazyContext *> lazy_live; ///< the lazy contexts that are built
+  mutable unsigned lazy_hand;              ///< clock hand over @a lazy_live
 };
 
 void ticket_block_free(void *ptr);
@@ -40,4 +40,9 @@ SSL_CTX *SSLInitClientContext(const struct SSLConfigParams *param);
 // Returns the index used to store our data on the SSL
 int get_ssl_client_data_index();
 
+class SSLNetVConnection;
+
+// Format the origin session cache key of a connection to an origin server into @a buf.
+const char *ssl_origin_session_key(const SSLNetVConnection *netvc, char *buf, size_t len);
+
 #endif /* IOCORE_NET_P_SSLCLIENTUTILS_H_ */
@@ -69,6 +69,8 @@ struct SSLConfigParams : public ConfigInfo {
   char *cipherSuite;
   char *client_cipherSuite;
   int configExitOnLoadError;
+  int ssl_ctx_lazy_load;
+  int ssl_ctx_lazy_max;
   int clientCertLevel;
   int verify_depth;
   int ssl_session_cache; // SSL_SESSION_CACHE_MODE
@@ -77,6 +79,8 @@ struct SSLConfigParams : public ConfigInfo {
   int ssl_session_cache_skip_on_contention;
   int ssl_session_cache_timeout;
   int ssl_session_cache_auto_clear;
+  int ssl_origin_session_cache;
+  int ssl_origin_session_cache_size;
 
   char *clientCertPath;
   char *clientKeyPath;
@@ -145,5 +149,6 @@ private:
 };
 
 extern SSLSessionCache *session_cache;
+extern SSLOriginSessionCache *origin_sess_cache;
 
 #endif
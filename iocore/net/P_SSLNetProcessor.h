@@ -63,6 +63,9 @@ public:
   SSL_CTX *client_ctx;
 
   static EventType ET_SSL;
+  /// Threads running offloaded server handshakes, only valid if handshake_offload is set.
+  static EventType ET_CRYPTO;
+  static bool handshake_offload;
 
   //
   // Private
@@ -102,6 +102,11 @@ public:
   {
     return sslClientConnection;
   };
+  virtual bool
+  getSSLHandShakeOffloaded()
+  {
+    return SSL_OFFLOAD_RUNNING == sslOffloadState;
+  };
   virtual void
   setSSLClientConnection(bool state)
   {
@@ -119,6 +124,7 @@ public:
   };
   int sslServerHandShakeEvent(int &err);
   int sslClientHandShakeEvent(int &err);
+  bool offloadHandshake();
   virtual void net_read_io(NetHandler *nh, EThread *lthread);
   virtual int64_t load_buffer_and_write(int64_t towrite, int64_t &wattempted, int64_t &total_written, MIOBufferAccessor &buf,
                                         int &needs);
@@ -332,6 +338,19 @@ private:
   IOBufferReader *reader;
   bool eosRcvd;
   bool sslTrace;
+
+  /// Offloading the private key operation of a server handshake, see offloadHandshake().
+  enum {
+    SSL_OFFLOAD_NONE,    ///< Not offloaded.
+    SSL_OFFLOAD_PENDING, ///< Paused in the certificate callback, to be offloaded.
+    SSL_OFFLOAD_RUNNING, ///< SSL_accept running on an ET_CRYPTO thread.
+    SSL_OFFLOAD_DONE,    ///< Back on the net thread, sslOffloadError is what SSL_accept returned.
+    SSL_OFFLOAD_USED     ///< Result consumed, the handshake goes on on the net thread.
+  } sslOffloadState;
+  int sslOffloadError; // ssl_error_t
+  int sslOffloadErrno;
+
+  friend struct SSLOffloadedAccept;
 };
 
 typedef int (SSLNetVConnection::*SSLNetVConnHandler)(int, void *);
@@ -66,6 +66,8 @@ enum SSL_Stats {
   ssl_user_agent_session_timeout_stat,
   ssl_total_handshake_time_stat,
   ssl_total_success_handshake_count_in_stat,
+  ssl_total_handshakes_offloaded_stat,
+  ssl_total_lazy_contexts_built_stat,
   ssl_total_tickets_created_stat,
   ssl_total_tickets_verified_stat,
   ssl_total_tickets_verified_old_key_stat, // verified with old key.
@@ -79,6 +81,10 @@ enum SSL_Stats {
   ssl_session_cache_eviction,
   ssl_session_cache_lock_contention,
   ssl_session_cache_new_session,
+  ssl_origin_session_cache_hit,
+  ssl_origin_session_cache_miss,
+  ssl_origin_session_cache_eviction,
+  ssl_origin_session_reused,
 
   /* error stats */
   ssl_error_want_write,
@@ -103,11 +109,22 @@ enum SSL_Stats {
 
 extern RecRawStatBlock *ssl_rsb;
 
+// session cache histograms, per thread so lookups share no cache line
+enum {
+  ssl_session_cache_probe_length_hist,
+  ssl_session_cache_bucket_occupancy_hist,
+
+  Ssl_Hist_Count
+};
+
+extern RecHistogramBlock *ssl_hist;
+
 /* Stats should only be accessed using these macros */
 #define SSL_INCREMENT_DYN_STAT(x) RecIncrRawStat(ssl_rsb, NULL, (int)x, 1)
 #define SSL_DECREMENT_DYN_STAT(x) RecIncrRawStat(ssl_rsb, NULL, (int)x, -1)
 #define SSL_SET_COUNT_DYN_STAT(x, count) RecSetRawStatCount(ssl_rsb, x, count)
 #define SSL_INCREMENT_DYN_STAT_EX(x, y) RecIncrRawStat(ssl_rsb, NULL, (int)x, y)
+#define SSL_HISTOGRAM_ADD(x, y) RecIncrHistogram(ssl_hist, NULL, (int)x, (int64_t)y)
 #define SSL_CLEAR_DYN_STAT(x)            \
   do {                                   \
     RecSetRawStatSum(ssl_rsb, (x), 0);   \
@@ -132,6 +132,8 @@ extern int http_accept_port_number;
 
 
 //#define INACTIVITY_TIMEOUT
+// connections read before their continuations are called back
+#define NET_READ_BATCH 32
 //
 // Configuration Parameter had to move here to share
 // between UnixNet and UnixUDPNet or SSLNet modules.
@@ -181,6 +183,8 @@ public:
   Event *trigger_event;
   QueM(UnixNetVConnection, NetState, read, ready_link) read_ready_list;
   QueM(UnixNetVConnection, NetState, write, ready_link) write_ready_list;
+  QueM(UnixNetVConnection, NetState, read, signal_link) read_signal_list; ///< Read, waiting for the end of the batch.
+  bool batch_reads;                                                        ///< Set while a batch of connections is read.
   Que(UnixNetVConnection, link) open_list;
   DList(UnixNetVConnection, cop_link) cop_list;
   ASLLM(UnixNetVConnection, NetState, read, enable_link) read_enable_list;
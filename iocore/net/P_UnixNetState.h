@@ -51,10 +51,12 @@ struct NetState {
   VIO vio;
   Link<UnixNetVConnection> ready_link;
   SLink<UnixNetVConnection> enable_link;
+  Link<UnixNetVConnection> signal_link;
   int in_enabled_list;
   int triggered;
+  int64_t signal_ndone; // vio.ndone of a read not signalled yet, 0 if none
 
-  NetState() : enabled(0), vio(VIO::NONE), in_enabled_list(0), triggered(0) {}
+  NetState() : enabled(0), vio(VIO::NONE), in_enabled_list(0), triggered(0), signal_ndone(0) {}
 };
 
 #endif
@@ -201,6 +201,11 @@ public:
   {
     return (false);
   }
+  virtual bool
+  getSSLHandShakeOffloaded()
+  {
+    return (false);
+  }
   virtual void
   setSSLClientConnection(bool state)
   {
@@ -230,6 +235,7 @@ public:
 
   LINK(UnixNetVConnection, cop_link);
   LINKM(UnixNetVConnection, read, ready_link)
+  LINKM(UnixNetVConnection, read, signal_link)
   SLINKM(UnixNetVConnection, read, enable_link)
   LINKM(UnixNetVConnection, write, ready_link)
   SLINKM(UnixNetVConnection, write, enable_link)
@@ -485,6 +491,7 @@ UnixNetVConnection::get_socket()
 // declarations for local use (within the net module)
 
 void close_UnixNetVConnection(UnixNetVConnection *vc, EThread *t);
+void read_signal_batched(NetHandler *nh, UnixNetVConnection *vc, EThread *thread);
 void write_to_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread);
 void write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread);
 
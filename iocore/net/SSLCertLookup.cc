@@ -29,7 +29,6 @@
 #include "I_EventSystem.h"
 #include "ts/I_Layout.h"
 #include "ts/Regex.h"
-#include "ts/Trie.h"
 #include "ts/TestBox.h"
 
 struct SSLAddressLookupKey {
@@ -104,25 +103,10 @@ public:
   }
 
 private:
-  /** A struct that can be stored a @c Trie.
-      It contains the index of the real certificate and the
-      linkage required by @c Trie.
+  /** Contexts stored by IP address, FQDN or wildcard.
+      A wildcard is stored without its leading '*', so a name is looked up by itself and then by
+      each of its domain suffixes in turn, starting with the longest.
   */
-  struct ContextRef {
-    ContextRef() : idx(-1) {}
-    explicit ContextRef(int n) : idx(n) {}
-    void
-    Print() const
-    {
-      Debug("ssl", "Item=%p SSL_CTX=#%d", this, idx);
-    }
-    int idx;                ///< Index in the context store.
-    LINK(ContextRef, link); ///< Require by @c Trie
-  };
-
-  /// Items tored by wildcard name
-  Trie<ContextRef> wildcards;
-  /// Contexts stored by IP address or FQDN
   InkHashTable *hostnames;
   /// List for cleanup.
   /// Exactly one pointer to each SSL context is stored here.
@@ -172,13 +156,93 @@ SSLCertContext::release()
   }
 }
 
-SSLCertLookup::SSLCertLookup() : ssl_storage(new SSLContextStorage()), ssl_default(NULL), is_valid(true)
+SSLLazyContext::SSLLazyContext(ssl_user_config *s) : settings(s), ctx(NULL), referenced(false), failed(false)
+{
+  ink_mutex_init(&mutex, "SSLLazyContext");
+}
+
+SSLLazyContext::~SSLLazyContext()
+{
+  if (ctx) {
+    SSL_CTX_free(ctx);
+  }
+  ink_mutex_destroy(&mutex);
+}
+
+SSL_CTX *
+SSLLazyContext::acquire()
+{
+  SSL_CTX *c;
+
+  ink_mutex_acquire(&mutex);
+  if ((c = ctx) != NULL) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    SSL_CTX_up_ref(c);
+#else
+    CRYPTO_add(&c->references, 1, CRYPTO_LOCK_SSL_CTX);
+#endif
+  }
+  ink_mutex_release(&mutex);
+  return c;
+}
+
+SSLCertLookup::SSLCertLookup()
+  : ssl_storage(new SSLContextStorage()), ssl_default(NULL), is_valid(true), lazy_max(0), lazy_hand(0)
 {
+  ink_mutex_init(&lazy_mutex, "SSLCertLookup");
 }
 
 SSLCertLookup::~SSLCertLookup()
 {
   delete this->ssl_storage;
+  for (unsigned i = 0; i < lazy_contexts.length(); ++i) {
+    delete lazy_contexts[i];
+  }
+  ink_mutex_destroy(&lazy_mutex);
+}
+
+void
+SSLCertLookup::lazyContextBuilt(SSLLazyContext *lazy) const
+{
+  ink_mutex_acquire(&lazy_mutex);
+  lazy_live.push_back(lazy);
+
+  // Contexts selected since the hand last passed get a second chance. One that is being selected
+  // right now is busy, so it is skipped too rather than waited for.
+  for (unsigned n = 2 * lazy_live.length(); lazy_max && lazy_live.length() > lazy_max && n > 0; --n) {
+    if (lazy_hand >= lazy_live.length()) {
+      lazy_hand = 0;
+    }
+
+    SSLLazyContext *victim = lazy_live[lazy_hand];
+    if (victim->referenced) {
+      victim->referenced = false;
+      ++lazy_hand;
+    } else if (ink_mutex_try_acquire(&victim->mutex)) {
+      Debug("ssl", "freeing the idle SSL_CTX %p of %s", victim->ctx, (const char *)victim->settings->cert);
+      SSL_CTX_free(victim->ctx);
+      victim->ctx = NULL;
+      ink_mutex_release(&victim->mutex);
+      lazy_live[lazy_hand] = lazy_live[lazy_live.length() - 1];
+      lazy_live.pop();
+    } else {
+      ++lazy_hand;
+    }
+  }
+  ink_mutex_release(&lazy_mutex);
+}
+
+void
+SSLCertLookup::acquireLazyContexts(Vec<SSL_CTX *> &ctxs) const
+{
+  ink_mutex_acquire(&lazy_mutex);
+  for (unsigned i = 0; i < lazy_live.length(); ++i) {
+    SSL_CTX *ctx = lazy_live[i]->acquire();
+    if (ctx) {
+      ctxs.push_back(ctx);
+    }
+  }
+  ink_mutex_release(&lazy_mutex);
 }
 
 SSLCertContext *
@@ -252,38 +316,7 @@ private:
   DFA regex;
 };
 
-static char *
-reverse_dns_name(const char *hostname, char(&reversed)[TS_MAX_HOST_NAME_LEN + 1])
-{
-  char *ptr = reversed + sizeof(reversed);
-  const char *part = hostname;
-
-  *(--ptr) = '\0'; // NUL-terminate
-
-  while (*part) {
-    ssize_t len = strcspn(part, ".");
-    ssize_t remain = ptr - reversed;
-
-    if (remain < (len + 1)) {
-      return NULL;
-    }
-
-    ptr -= len;
-    memcpy(ptr, part, len);
-
-    // Skip to the next domain component. This will take us to either a '.' or a NUL.
-    // If it's a '.' we need to skip over it.
-    part += len;
-    if (*part == '.') {
-      ++part;
-      *(--ptr) = '.';
-    }
-  }
-
-  return ptr;
-}
-
-SSLContextStorage::SSLContextStorage() : wildcards(), hostnames(ink_hash_table_create(InkHashTableKeyType_String))
+SSLContextStorage::SSLContextStorage() : hostnames(ink_hash_table_create(InkHashTableKeyType_String))
 {
 }
 
@@ -333,53 +366,22 @@ int
 SSLContextStorage::insert(const char *name, int idx)
 {
   ats_wildcard_matcher wildcard;
-  bool inserted = false;
+  const char *key = name;
+  InkHashTableValue value;
 
+  // A wildcard is indexed by its domain suffix, "*.foo.com" as ".foo.com", which lookup() tries
+  // after the exact name.
   if (wildcard.match(name)) {
-    // We turn wildcards into the reverse DNS form, then insert them into the trie
-    // so that we can do a longest match lookup.
-    char namebuf[TS_MAX_HOST_NAME_LEN + 1];
-    char *reversed;
-    ats_scoped_obj<ContextRef> ref;
-
-    reversed = reverse_dns_name(name + 1, namebuf);
-    if (!reversed) {
-      Error("wildcard name '%s' is too long", name);
-      return -1;
-    }
-
-    ref = new ContextRef(idx);
-    int ref_idx = (*ref).idx;
-    inserted = this->wildcards.Insert(reversed, ref, 0 /* rank */, -1 /* keylen */);
-    if (!inserted) {
-      ContextRef *found;
-
-      // We fail to insert, so the longest wildcard match search should return the full match value.
-      found = this->wildcards.Search(reversed);
-      // Fail even if we are reinserting the exact same value
-      // Otherwise we cannot detect and recover from a double insert
-      // into the references array
-      if (found != NULL) {
-        Warning("previously indexed wildcard certificate for '%s' as '%s', cannot index it with SSL_CTX #%d now", name, reversed,
-                idx);
-      }
-      idx = -1;
-    } else {
-      ref.release(); // it's the hands of the Trie now, forget it and move on.
-    }
+    key = name + 1;
+  }
 
-    Debug("ssl", "%s wildcard certificate for '%s' as '%s' with SSL_CTX %p [%d]", idx >= 0 ? "index" : "failed to index", name,
-          reversed, this->ctx_store[ref_idx].ctx, ref_idx);
+  if (ink_hash_table_lookup(this->hostnames, key, &value) && reinterpret_cast<InkHashTableValue>(idx) != value) {
+    Warning("previously indexed '%s' with SSL_CTX #%d, cannot index it with SSL_CTX #%d now", name,
+            static_cast<int>(reinterpret_cast<intptr_t>(value)), idx);
+    idx = -1;
   } else {
-    InkHashTableValue value;
-
-    if (ink_hash_table_lookup(this->hostnames, name, &value) && reinterpret_cast<InkHashTableValue>(idx) != value) {
-      Warning("previously indexed '%s' with SSL_CTX %p, cannot index it with SSL_CTX #%d now", name, value, idx);
-      idx = -1;
-    } else {
-      ink_hash_table_insert(this->hostnames, name, reinterpret_cast<void *>(static_cast<intptr_t>(idx)));
-      Debug("ssl", "indexed '%s' with SSL_CTX %p [%d]", name, this->ctx_store[idx].ctx, idx);
-    }
+    ink_hash_table_insert(this->hostnames, key, reinterpret_cast<void *>(static_cast<intptr_t>(idx)));
+    Debug("ssl", "indexed %s'%s' with SSL_CTX %p [%d]", key != name ? "wildcard " : "", name, this->ctx_store[idx].ctx, idx);
   }
   return idx;
 }
@@ -393,21 +395,11 @@ SSLContextStorage::lookup(const char *name) const
     return &(this->ctx_store[reinterpret_cast<intptr_t>(value)]);
   }
 
-  if (!this->wildcards.Empty()) {
-    char namebuf[TS_MAX_HOST_NAME_LEN + 1];
-    char *reversed;
-    ContextRef *ref;
-
-    reversed = reverse_dns_name(name, namebuf);
-    if (!reversed) {
-      Error("failed to reverse hostname name '%s' is too long", name);
-      return NULL;
-    }
-
-    Debug("ssl", "attempting wildcard match for %s", reversed);
-    ref = this->wildcards.Search(reversed);
-    if (ref) {
-      return &(this->ctx_store[ref->idx]);
+  // Then the longest wildcard match, a.b.foo.com tries *.b.foo.com, *.foo.com and *.com.
+  for (const char *suffix = strchr(name, '.'); suffix; suffix = strchr(suffix + 1, '.')) {
+    if (ink_hash_table_lookup(const_cast<InkHashTable *>(this->hostnames), suffix, &value)) {
+      Debug("ssl", "wildcard match for %s on '*%s'", name, suffix);
+      return &(this->ctx_store[reinterpret_cast<intptr_t>(value)]);
     }
   }
 
@@ -430,21 +422,23 @@ REGRESSION_TEST(SSLWildcardMatch)(RegressionTest *t, int /* atype ATS_UNUSED */,
   box.check(wildcard.match("") == false, "'' is not a wildcard");
 }
 
-REGRESSION_TEST(SSLReverseHostname)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+REGRESSION_TEST(SSLWildcardLookup)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
 {
   TestBox box(t, pstatus);
+  SSLContextStorage storage;
 
-  char reversed[TS_MAX_HOST_NAME_LEN + 1];
-
-#define _R(name) reverse_dns_name(name, reversed)
+  int exact = storage.insert("foo.com", SSLCertContext());
+  int wildcard = storage.insert("*.foo.com", SSLCertContext());
+  int longer = storage.insert("*.bar.foo.com", SSLCertContext());
 
   box = REGRESSION_TEST_PASSED;
 
-  box.check(strcmp(_R("foo.com"), "com.foo") == 0, "reversed foo.com");
-  box.check(strcmp(_R("bar.foo.com"), "com.foo.bar") == 0, "reversed bar.foo.com");
-  box.check(strcmp(_R("foo"), "foo") == 0, "reversed foo");
-
-#undef _R
+  box.check(storage.lookup("foo.com") == storage.get(exact), "exact match for foo.com");
+  box.check(storage.lookup("www.foo.com") == storage.get(wildcard), "wildcard match for www.foo.com");
+  box.check(storage.lookup("a.b.foo.com") == storage.get(wildcard), "wildcard match for a.b.foo.com");
+  box.check(storage.lookup("www.bar.foo.com") == storage.get(longer), "longest wildcard match for www.bar.foo.com");
+  box.check(storage.lookup("www.foobar.com") == NULL, "no match for www.foobar.com");
+  box.check(storage.lookup("foo") == NULL, "no match for foo");
 }
 
 #endif // TS_HAS_TESTS
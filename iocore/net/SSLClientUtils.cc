@@ -37,12 +37,40 @@ typedef SSL_METHOD *ink_ssl_method_t;
 
 static int ssl_client_data_index = 0;
 
+SSLOriginSessionCache *origin_sess_cache; // declared extern in P_SSLConfig.h
+
 int
 get_ssl_client_data_index()
 {
   return ssl_client_data_index;
 }
 
+const char *
+ssl_origin_session_key(const SSLNetVConnection *netvc, char *buf, size_t len)
+{
+  char addr[INET6_ADDRPORTSTRLEN];
+
+  snprintf(buf, len, "%s/%s", netvc->options.sni_servername ? netvc->options.sni_servername.get() : "",
+           ats_ip_nptop(&netvc->server_addr.sa, addr, sizeof(addr)));
+  return buf;
+}
+
+// Called for every session an origin server hands out, after the handshake and, with TLS 1.3, for
+// each ticket it sends later on.
+static int
+ssl_new_origin_session(SSL *ssl, SSL_SESSION *sess)
+{
+  SSLNetVConnection *netvc = static_cast<SSLNetVConnection *>(SSL_get_ex_data(ssl, ssl_client_data_index));
+  char key[SSL_ORIGIN_SESSION_KEY_SIZE];
+
+  if (netvc == NULL || origin_sess_cache == NULL) {
+    return 0;
+  }
+
+  origin_sess_cache->insertSession(ssl_origin_session_key(netvc, key, sizeof(key)), sess);
+  return 1; // the cache keeps the reference
+}
+
 int
 verify_callback(int preverify_ok, X509_STORE_CTX *ctx)
 {
@@ -174,6 +202,12 @@ SSLInitClientContext(const SSLConfigParams *params)
   // context there's no need for allocating - we can simply save a ptr to the NetVC
   ssl_client_data_index = SSL_get_ex_new_index(0, (void *)"NetVC index", NULL, NULL, NULL);
 
+  // Origin sessions are kept by origin, outside of OpenSSL's own cache which is keyed by session id.
+  if (params->ssl_origin_session_cache && origin_sess_cache) {
+    SSL_CTX_set_session_cache_mode(client_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(client_ctx, ssl_new_origin_session);
+  }
+
   if (SSLConfigParams::init_ssl_ctx_cb) {
     SSLConfigParams::init_ssl_ctx_cb(client_ctx, false);
   }
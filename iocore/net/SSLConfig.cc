@@ -80,7 +80,11 @@ SSLConfigParams::SSLConfigParams()
   ssl_session_cache_skip_on_contention = 0;
   ssl_session_cache_timeout = 0;
   ssl_session_cache_auto_clear = 1;
+  ssl_origin_session_cache = 0;
+  ssl_origin_session_cache_size = 10240;
   configExitOnLoadError = 0;
+  ssl_ctx_lazy_load = 0;
+  ssl_ctx_lazy_max = 0;
 }
 
 SSLConfigParams::~SSLConfigParams()
@@ -242,6 +246,8 @@ SSLConfigParams::initialize()
 
   configFilePath = RecConfigReadConfigPath("proxy.config.ssl.server.multicert.filename");
   REC_ReadConfigInteger(configExitOnLoadError, "proxy.config.ssl.server.multicert.exit_on_load_fail");
+  REC_ReadConfigInteger(ssl_ctx_lazy_load, "proxy.config.ssl.server.multicert.lazy_load");
+  REC_ReadConfigInteger(ssl_ctx_lazy_max, "proxy.config.ssl.server.multicert.lazy_max_contexts");
 
   REC_ReadConfigStringAlloc(ssl_server_private_key_path, "proxy.config.ssl.server.private_key.path");
   set_paths_helper(ssl_server_private_key_path, NULL, &serverKeyPathOnly, NULL);
@@ -269,6 +275,13 @@ SSLConfigParams::initialize()
     session_cache = new SSLSessionCache();
   }
 
+  // The client context only learns of new origin sessions if the cache exists when it is built, keep the first one.
+  REC_ReadConfigInteger(ssl_origin_session_cache, "proxy.config.ssl.origin_session_cache");
+  REC_ReadConfigInteger(ssl_origin_session_cache_size, "proxy.config.ssl.origin_session_cache.size");
+  if (ssl_origin_session_cache && origin_sess_cache == NULL) {
+    origin_sess_cache = new SSLOriginSessionCache(ssl_origin_session_cache_size);
+  }
+
   // SSL record size
   REC_EstablishStaticConfigInt32(ssl_maxrecord, "proxy.config.ssl.max_record_size");
 
@@ -52,20 +52,29 @@ SSLNetAccept::init_accept_per_thread(bool isTransparent)
   else
     SET_HANDLER((SSLNetAcceptHandler)&SSLNetAccept::acceptEvent);
   period = -HRTIME_MSECONDS(net_accept_period);
+  int own = 0;
   n = eventProcessor.n_threads_for_type[SSLNetProcessor::ET_SSL];
   for (i = 0; i < n; i++) {
-    if (i < n - 1)
+    if (i < n - 1) {
       a = clone();
-    else
+      if (listen_per_thread && a->listen_reuse_port(isTransparent))
+        ++own;
+    } else
       a = this;
     EThread *t = eventProcessor.eventthread[SSLNetProcessor::ET_SSL][i];
 
     PollDescriptor *pd = get_PollDescriptor(t);
-    if (ep.start(pd, this, EVENTIO_READ) < 0)
+    if (a->ep.start(pd, a, EVENTIO_READ) < 0)
       Debug("iocore_net", "error starting EventIO");
     a->mutex = get_NetHandler(t)->mutex;
     t->schedule_every(a, period, etype);
   }
+  if (listen_per_thread) {
+    if (own < n - 1)
+      Warning("%d of %d threads share a listen socket on port %d", n - own, n, ats_ip_port_host_order(&server.accept_addr));
+    else if (listen_per_thread > 1)
+      steer_by_cpu(n);
+  }
 }
 
 NetAccept *
@@ -34,6 +34,8 @@
 SSLNetProcessor ssl_NetProcessor;
 NetProcessor &sslNetProcessor = ssl_NetProcessor;
 EventType SSLNetProcessor::ET_SSL;
+EventType SSLNetProcessor::ET_CRYPTO;
+bool SSLNetProcessor::handshake_offload = false;
 
 #ifdef HAVE_OPENSSL_OCSP_STAPLING
 struct OCSPContinuation : public Continuation {
@@ -94,6 +96,14 @@ SSLNetProcessor::start(int number_of_ssl_threads, size_t stacksize)
   }
 #endif /* HAVE_OPENSSL_OCSP_STAPLING */
 
+#if TS_USE_CERT_CB
+  int crypto_threads = 0;
+  REC_ReadConfigInteger(crypto_threads, "proxy.config.ssl.handshake_offload_threads");
+  if (crypto_threads > 0) {
+    SSLNetProcessor::ET_CRYPTO = eventProcessor.spawn_event_threads(crypto_threads, "ET_CRYPTO", stacksize);
+    SSLNetProcessor::handshake_offload = true;
+  }
+#endif
 
   if (number_of_ssl_threads == -1) {
     // We've disabled ET_SSL threads, so we will mark all ET_NET threads as having
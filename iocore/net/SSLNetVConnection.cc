@@ -141,6 +141,54 @@ private:
 };
 }
 
+/**
+  Continues a server handshake paused by SSLNetVConnection::offloadHandshake()
+  on an ET_CRYPTO thread, then goes back to the thread of the VC to resume it.
+
+  The VC mutex is not held while the job waits for a crypto thread or for the
+  way back, so the VC may be closed meanwhile, by its handshake timeout for
+  instance. The net thread leaves the SSL object alone while the offload is
+  running and close_UnixNetVConnection() leaves such a VC open, with its
+  socket, for resumeEvent() to close once the crypto thread is done with it.
+*/
+struct SSLOffloadedAccept : public Continuation {
+  SSLNetVConnection *vc;
+
+  SSLOffloadedAccept(SSLNetVConnection *netvc) : Continuation(netvc->mutex), vc(netvc)
+  {
+    SET_HANDLER(&SSLOffloadedAccept::acceptEvent);
+  }
+
+  int
+  acceptEvent(int /* event ATS_UNUSED */, void * /* e ATS_UNUSED */)
+  {
+    vc->sslOffloadError = SSLAccept(vc->ssl);
+    vc->sslOffloadErrno = errno;
+
+    SET_HANDLER(&SSLOffloadedAccept::resumeEvent);
+    vc->thread->schedule_imm(this);
+    return EVENT_DONE;
+  }
+
+  int
+  resumeEvent(int /* event ATS_UNUSED */, void * /* e ATS_UNUSED */)
+  {
+    vc->sslOffloadState = SSLNetVConnection::SSL_OFFLOAD_DONE;
+    if (vc->closed) {
+      // Closed while offloaded, close it now unless the net handler is busy,
+      // the InactivityCop gets it then.
+      MUTEX_TRY_LOCK(lock, vc->nh->mutex, vc->thread);
+      if (lock.is_locked()) {
+        close_UnixNetVConnection(vc, vc->thread);
+      }
+    } else {
+      vc->reenable(vc->nh);
+    }
+    delete this;
+    return EVENT_DONE;
+  }
+};
+
 //
 // Private
 //
@@ -456,6 +504,11 @@ SSLNetVConnection::net_read_io(NetHandler *nh, EThread *lthread)
   if (!getSSLHandShakeComplete()) {
     int err;
 
+    if (sslOffloadState == SSL_OFFLOAD_RUNNING) {
+      // an ET_CRYPTO thread owns the SSL object, SSLOffloadedAccept reschedules the read
+      return;
+    }
+
     if (getSSLClientConnection()) {
       ret = sslStartHandShake(SSL_EVENT_CLIENT, err);
     } else {
@@ -568,7 +621,9 @@ SSLNetVConnection::net_read_io(NetHandler *nh, EThread *lthread)
     return;
   }
 
-  // If there is nothing to do or no space available, disable connection
+  // If there is nothing to do or no space available, disable connection.
+  // A parked buffer only gets a block once there is something to read.
+  bool parked = buf.writer()->empty();
   if (ntodo <= 0 || !buf.writer()->write_avail()) {
     read_disable(nh, this);
     return;
@@ -640,6 +695,9 @@ SSLNetVConnection::net_read_io(NetHandler *nh, EThread *lthread)
         writeReschedule(nh);
       return;
     }
+    if (parked && bytes == 0 && ret == SSL_READ_WOULD_BLOCK) {
+      buf.writer()->release_blocks();
+    }
     // reset the trigger and remove from the ready queue
     // we will need to be retriggered to read from this socket again
     read.triggered = 0;
@@ -856,7 +914,8 @@ SSLNetVConnection::SSLNetVConnection()
     sslHandShakeComplete(false), sslClientConnection(false), sslClientRenegotiationAbort(false), sslSessionCacheHit(false),
     handShakeBuffer(NULL), handShakeHolder(NULL), handShakeReader(NULL), handShakeBioStored(0),
     sslPreAcceptHookState(SSL_HOOKS_INIT), sslHandshakeHookState(HANDSHAKE_HOOKS_PRE), npnSet(NULL), npnEndpoint(NULL),
-    sessionAcceptPtr(NULL), iobuf(NULL), reader(NULL), eosRcvd(false), sslTrace(false)
+    sessionAcceptPtr(NULL), iobuf(NULL), reader(NULL), eosRcvd(false), sslTrace(false),
+    sslOffloadState(SSL_OFFLOAD_NONE), sslOffloadError(SSL_ERROR_NONE), sslOffloadErrno(0)
 {
 }
 
@@ -943,6 +1002,8 @@ SSLNetVConnection::free(EThread *t)
   if (SSL_HOOKS_ACTIVE == sslPreAcceptHookState) {
     Error("SSLNetVconnection freed with outstanding hook");
   }
+  ink_release_assert(SSL_OFFLOAD_RUNNING != sslOffloadState);
+  sslOffloadState = SSL_OFFLOAD_NONE;
   sslPreAcceptHookState = SSL_HOOKS_INIT;
   curHook = 0;
   hookOpRequested = TS_SSL_HOOK_OP_DEFAULT;
@@ -1028,6 +1089,15 @@ SSLNetVConnection::sslStartHandShake(int event, int &err)
   case SSL_EVENT_CLIENT:
     if (this->ssl == NULL) {
       this->ssl = make_ssl_connection(ssl_NetProcessor.client_ctx, this);
+      if (this->ssl != NULL && origin_sess_cache != NULL) {
+        char key[SSL_ORIGIN_SESSION_KEY_SIZE];
+
+        if (origin_sess_cache->resumeSession(ssl_origin_session_key(this, key, sizeof(key)), this->ssl)) {
+          SSL_INCREMENT_DYN_STAT(ssl_origin_session_cache_hit);
+        } else {
+          SSL_INCREMENT_DYN_STAT(ssl_origin_session_cache_miss);
+        }
+      }
     }
 
     if (this->ssl == NULL) {
@@ -1046,6 +1116,10 @@ SSLNetVConnection::sslStartHandShake(int event, int &err)
 int
 SSLNetVConnection::sslServerHandShakeEvent(int &err)
 {
+  if (SSL_OFFLOAD_RUNNING == sslOffloadState) {
+    return SSL_WAIT_FOR_HOOK;
+  }
+
   if (SSL_HOOKS_DONE != sslPreAcceptHookState) {
     // Get the first hook if we haven't started invoking yet.
     if (SSL_HOOKS_INIT == sslPreAcceptHookState) {
@@ -1094,20 +1168,37 @@ SSLNetVConnection::sslServerHandShakeEvent(int &err)
   }
 
   int retval = 1; // Initialze with a non-error value
+  ssl_error_t ssl_error;
 
-  // All the pre-accept hooks have completed, proceed with the actual accept.
-  if (BIO_eof(SSL_get_rbio(this->ssl))) { // No more data in the buffer
-    // Read from socket to fill in the BIO buffer with the
-    // raw handshake data before calling the ssl accept calls.
-    retval = this->read_raw_data();
-    if (retval == 0) {
-      // EOF, go away, we stopped in the handshake
-      SSLDebugVC(this, "SSL handshake error: EOF");
-      return EVENT_ERROR;
+  if (SSL_OFFLOAD_DONE == sslOffloadState) {
+    // Pick up where the ET_CRYPTO thread left the handshake.
+    sslOffloadState = SSL_OFFLOAD_USED;
+    ssl_error = sslOffloadError;
+    errno = sslOffloadErrno;
+  } else {
+    // All the pre-accept hooks have completed, proceed with the actual accept.
+    if (BIO_eof(SSL_get_rbio(this->ssl))) { // No more data in the buffer
+      // Read from socket to fill in the BIO buffer with the
+      // raw handshake data before calling the ssl accept calls.
+      retval = this->read_raw_data();
+      if (retval == 0) {
+        // EOF, go away, we stopped in the handshake
+        SSLDebugVC(this, "SSL handshake error: EOF");
+        return EVENT_ERROR;
+      }
+    }
+
+    ssl_error = SSLAccept(ssl);
+
+    if (ssl_error == SSL_ERROR_WANT_X509_LOOKUP && SSL_OFFLOAD_PENDING == sslOffloadState) {
+      SSLDebugVC(this, "SSL handshake: offloading the private key operation");
+      SSL_INCREMENT_DYN_STAT(ssl_total_handshakes_offloaded_stat);
+      sslOffloadState = SSL_OFFLOAD_RUNNING;
+      eventProcessor.schedule_imm(new SSLOffloadedAccept(this), SSLNetProcessor::ET_CRYPTO);
+      return SSL_WAIT_FOR_HOOK;
     }
   }
 
-  ssl_error_t ssl_error = SSLAccept(ssl);
   bool trace = getSSLTrace();
   Debug("ssl", "trace=%s", trace ? "TRUE" : "FALSE");
 
@@ -1299,6 +1390,9 @@ SSLNetVConnection::sslClientHandShakeEvent(int &err)
       }
     }
     SSL_INCREMENT_DYN_STAT(ssl_total_success_handshake_count_out_stat);
+    if (SSL_session_reused(ssl)) {
+      SSL_INCREMENT_DYN_STAT(ssl_origin_session_reused);
+    }
 
     TraceIn(trace, get_remote_addr(), get_remote_port(), "SSL client handshake completed successfully");
     // do we want to include cert info in trace?
@@ -1359,6 +1453,11 @@ SSLNetVConnection::sslClientHandShakeEvent(int &err)
     ERR_error_string_n(e, buf, sizeof(buf));
     TraceIn(trace, get_remote_addr(), get_remote_port(),
             "SSL client handshake ERROR_SSL: sslErr=%d, ERR_get_error=%ld (%s) errno=%d", ssl_error, e, buf, errno);
+    if (origin_sess_cache != NULL && SSL_get_session(ssl) != NULL) {
+      // Don't offer a session the origin may have choked on again.
+      char key[SSL_ORIGIN_SESSION_KEY_SIZE];
+      origin_sess_cache->removeSession(ssl_origin_session_key(this, key, sizeof(key)));
+    }
     return EVENT_ERROR;
   } break;
   }
@@ -1448,6 +1547,27 @@ SSLNetVConnection::reenable(NetHandler *nh)
 }
 
 
+/**
+  Called from the certificate callback once the certificate hooks ran, returns
+  true to pause the handshake so that it is continued on an ET_CRYPTO thread.
+  Only the first flight of a full server handshake is offloaded, it signs the
+  (EC)DHE key exchange. The private key decryption of a RSA key exchange comes
+  with the next flight and still happens on the net thread.
+*/
+bool
+SSLNetVConnection::offloadHandshake()
+{
+  if (!SSLNetProcessor::handshake_offload || getSSLClientConnection() || SSL_OFFLOAD_NONE != sslOffloadState ||
+      SSL_session_reused(ssl)) {
+    return false;
+  }
+
+  // The callback runs again when the handshake resumes, the hooks are done.
+  sslHandshakeHookState = HANDSHAKE_HOOKS_DONE;
+  sslOffloadState = SSL_OFFLOAD_PENDING;
+  return true;
+}
+
 bool
 SSLNetVConnection::sslContextSet(void *ctx)
 {
@@ -21,6 +21,7 @@
 
 #include "P_SSLConfig.h"
 #include "SSLSessionCache.h"
+#include "ts/HashFNV.h"
 #include <cstring>
 
 #define SSLSESSIONCACHE_STRINGIFY0(x) #x
@@ -101,6 +102,13 @@ SSLSessionCache::insertSession(const SSLSessionID &sid, SSL_SESSION *sess)
   bucket->insertSession(sid, sess);
 }
 
+// The hash of a free slot is 0.
+static inline uint64_t
+session_hash(const SSLSessionID &id)
+{
+  return id.hash() | 1;
+}
+
 void
 SSLSessionBucket::insertSession(const SSLSessionID &id, SSL_SESSION *sess)
 {
@@ -117,14 +125,10 @@ SSLSessionBucket::insertSession(const SSLSessionID &id, SSL_SESSION *sess)
     Debug("ssl.session_cache", "Inserting session '%s' to bucket %p.", buf, this);
   }
 
-  Ptr<IOBufferData> buf;
-  buf = new_IOBufferData(buffer_size_to_index(len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-  ink_release_assert(static_cast<size_t>(buf->block_size()) >= len);
-  unsigned char *loc = reinterpret_cast<unsigned char *>(buf->data());
+  unsigned char data[SSL_MAX_SESSION_SIZE];
+  unsigned char *loc = data;
   i2d_SSL_SESSION(sess, &loc);
 
-  ats_scoped_obj<SSLSession> ssl_session(new SSLSession(id, buf, len));
-
   MUTEX_TRY_LOCK(lock, mutex, this_ethread());
   if (!lock.is_locked()) {
     SSL_INCREMENT_DYN_STAT(ssl_session_cache_lock_contention);
@@ -134,13 +138,37 @@ SSLSessionBucket::insertSession(const SSLSessionID &id, SSL_SESSION *sess)
     lock.acquire(this_ethread());
   }
 
+  if (slots == NULL) {
+    // publish the table only once it is initialized
+    ink_atomic_cas(&slots, (SSLSessionSlot *)NULL, new SSLSessionSlot[nslots]);
+  }
+
   PRINT_BUCKET("insertSession before")
-  if (queue.size >= static_cast<int>(SSLConfigParams::session_cache_max_bucket_size)) {
-    removeOldestSession();
+
+  uint64_t hash = session_hash(id);
+  SSLSessionSlot *slot = findSlot(id, hash, true);
+
+  if (slot->hash == 0) {
+    ++used;
+  } else if (slot->hash != hash || !(slot->session_id == id)) {
+    if (is_debug_tag_set("ssl.session_cache")) {
+      char buf[slot->session_id.len * 2 + 1];
+      slot->session_id.toString(buf, sizeof(buf));
+      Debug("ssl.session_cache", "Removing session '%s' from bucket %p because it is the least recently used of its slots", buf,
+            this);
+    }
   }
 
   /* do the actual insert */
-  queue.enqueue(ssl_session.release());
+  ink_atomic_increment(&slot->version, 1);
+  slot->hash = hash;
+  slot->session_id = id;
+  slot->len_asn1_data = len;
+  memcpy(slot->asn1_data, data, len);
+  slot->last_used = Thread::get_hrtime();
+  ink_atomic_increment(&slot->version, 1);
+
+  SSL_HISTOGRAM_ADD(ssl_session_cache_bucket_occupancy_hist, used * 100 / nslots);
 
   PRINT_BUCKET("insertSession after")
 }
@@ -156,33 +184,73 @@ SSLSessionBucket::getSession(const SSLSessionID &id, SSL_SESSION **sess)
 
   Debug("ssl.session_cache", "Looking for session with id '%s' in bucket %p", buf, this);
 
-  MUTEX_TRY_LOCK(lock, mutex, this_ethread());
-  if (!lock.is_locked()) {
-    SSL_INCREMENT_DYN_STAT(ssl_session_cache_lock_contention);
-    if (SSLConfigParams::session_cache_skip_on_lock_contention)
-      return false;
-
-    lock.acquire(this_ethread());
-  }
-
-  PRINT_BUCKET("getSession")
-
-  // We work backwards because that's the most likely place we'll find our session...
-  SSLSession *node = queue.tail;
-  while (node) {
-    if (node->session_id == id) {
-      const unsigned char *loc = reinterpret_cast<const unsigned char *>(node->asn1_data->data());
-      *sess = d2i_SSL_SESSION(NULL, &loc, node->len_asn1_data);
-
+  SSLSessionSlot *table = slots;
+  uint64_t hash = session_hash(id);
+  int probes = std::min(nslots, SSL_SESSION_CACHE_PROBES);
+  int start = (hash >> 32) % nslots;
+  unsigned char data[SSL_MAX_SESSION_SIZE];
+
+  for (int i = 0; table && i < probes; i++) {
+    SSLSessionSlot *slot = &table[(start + i) % nslots];
+
+    for (int retry = 0; slot->hash == hash && retry < SSL_SESSION_CACHE_READ_RETRIES; retry++) {
+      uint32_t version = slot->version;
+      if (version & 1) {
+        continue;
+      }
+      __sync_synchronize(); // copy the slot after reading its version ...
+
+      bool match = slot->session_id == id;
+      size_t len = std::min(slot->len_asn1_data, sizeof(data));
+      if (match) {
+        memcpy(data, slot->asn1_data, len);
+      }
+
+      __sync_synchronize(); // ... and before reading it again
+      if (slot->version != version) {
+        continue;
+      }
+      if (!match) {
+        break;
+      }
+
+      slot->last_used = Thread::get_hrtime();
+      SSL_HISTOGRAM_ADD(ssl_session_cache_probe_length_hist, i + 1);
+
+      const unsigned char *loc = data;
+      *sess = d2i_SSL_SESSION(NULL, &loc, len);
       return true;
     }
-    node = node->link.prev;
   }
 
   Debug("ssl.session_cache", "Session with id '%s' not found in bucket %p.", buf, this);
   return false;
 }
 
+SSLSessionSlot *
+SSLSessionBucket::findSlot(const SSLSessionID &id, uint64_t hash, bool for_insert)
+{
+  // Caller must hold the bucket lock.
+  ink_assert(this_ethread() == mutex->thread_holding);
+
+  int probes = std::min(nslots, SSL_SESSION_CACHE_PROBES);
+  int start = (hash >> 32) % nslots;
+  SSLSessionSlot *victim = NULL;
+
+  for (int i = 0; slots && i < probes; i++) {
+    SSLSessionSlot *slot = &slots[(start + i) % nslots];
+
+    if (slot->hash == hash && slot->session_id == id) {
+      return slot;
+    }
+    // a free slot, otherwise the least recently used one
+    if (for_insert && (victim == NULL || (victim->hash != 0 && (slot->hash == 0 || slot->last_used < victim->last_used)))) {
+      victim = slot;
+    }
+  }
+  return victim;
+}
+
 void inline SSLSessionBucket::print(const char *ref_str) const
 {
   /* NOTE: This method assumes you're already holding the bucket lock */
@@ -191,56 +259,149 @@ void inline SSLSessionBucket::print(const char *ref_str) const
   }
 
   fprintf(stderr, "-------------- BUCKET %p (%s) ----------------\n", this, ref_str);
-  fprintf(stderr, "Current Size: %d, Max Size: %zd\n", queue.size, SSLConfigParams::session_cache_max_bucket_size);
-  fprintf(stderr, "Queue: \n");
+  fprintf(stderr, "Current Size: %d, Max Size: %d\n", used, nslots);
+  fprintf(stderr, "Slots: \n");
+
+  for (int i = 0; slots && i < nslots; i++) {
+    if (slots[i].hash) {
+      char s_buf[2 * slots[i].session_id.len + 1];
+      slots[i].session_id.toString(s_buf, sizeof(s_buf));
+      fprintf(stderr, "  %d: %s\n", i, s_buf);
+    }
+  }
+}
 
-  SSLSession *node = queue.head;
-  while (node) {
-    char s_buf[2 * node->session_id.len + 1];
-    node->session_id.toString(s_buf, sizeof(s_buf));
-    fprintf(stderr, "  %s\n", s_buf);
-    node = node->link.next;
+void
+SSLSessionBucket::removeSession(const SSLSessionID &id)
+{
+  SCOPED_MUTEX_LOCK(lock, mutex, this_ethread()); // We can't bail on contention here because this session MUST be removed.
+  SSLSessionSlot *slot = findSlot(id, session_hash(id), false);
+
+  if (slot) {
+    ink_atomic_increment(&slot->version, 1);
+    slot->hash = 0;
+    slot->len_asn1_data = 0;
+    ink_atomic_increment(&slot->version, 1);
+    --used;
   }
 }
 
-void inline SSLSessionBucket::removeOldestSession()
+/* Session Bucket */
+SSLSessionBucket::SSLSessionBucket()
+  : mutex(new_ProxyMutex()), slots(NULL), nslots(std::max(SSLConfigParams::session_cache_max_bucket_size, (size_t)1)), used(0)
 {
-  // Caller must hold the bucket lock.
-  ink_assert(this_ethread() == mutex->thread_holding);
+}
 
-  PRINT_BUCKET("removeOldestSession before")
-  while (queue.head && queue.size >= static_cast<int>(SSLConfigParams::session_cache_max_bucket_size)) {
-    SSLSession *old_head = queue.pop();
-    if (is_debug_tag_set("ssl.session_cache")) {
-      char buf[old_head->session_id.len * 2 + 1];
-      old_head->session_id.toString(buf, sizeof(buf));
-      Debug("ssl.session_cache", "Removing session '%s' from bucket %p because the bucket has size %d and max %zd", buf, this,
-            (queue.size + 1), SSLConfigParams::session_cache_max_bucket_size);
+SSLSessionBucket::~SSLSessionBucket()
+{
+  delete[] slots;
+}
+
+/* Origin Session Cache */
+SSLOriginSessionCache::SSLOriginSessionCache(size_t size)
+  : buckets(new Bucket[SSL_ORIGIN_SESSION_CACHE_BUCKETS]), bucket_size(std::max(size / SSL_ORIGIN_SESSION_CACHE_BUCKETS, (size_t)1))
+{
+  for (unsigned i = 0; i < SSL_ORIGIN_SESSION_CACHE_BUCKETS; i++) {
+    buckets[i].mutex = new_ProxyMutex();
+    buckets[i].count = 0;
+  }
+  Debug("ssl.origin_session_cache", "Created origin session cache %p with %d buckets of %zu sessions", this,
+        SSL_ORIGIN_SESSION_CACHE_BUCKETS, bucket_size);
+}
+
+SSLOriginSessionCache::~SSLOriginSessionCache()
+{
+  for (unsigned i = 0; i < SSL_ORIGIN_SESSION_CACHE_BUCKETS; i++) {
+    SSLOriginSession *entry;
+    while ((entry = buckets[i].sessions.pop())) {
+      SSL_SESSION_free(entry->session);
+      delete entry;
     }
-    delete old_head;
   }
-  PRINT_BUCKET("removeOldestSession after")
+  delete[] buckets;
 }
 
-void
-SSLSessionBucket::removeSession(const SSLSessionID &id)
+SSLOriginSessionCache::Bucket *
+SSLOriginSessionCache::getBucket(const char *key, uint64_t &hash) const
 {
-  SCOPED_MUTEX_LOCK(lock, mutex, this_ethread()); // We can't bail on contention here because this session MUST be removed.
-  SSLSession *node = queue.head;
-  while (node) {
-    if (node->session_id == id) {
-      queue.remove(node);
-      delete node;
-      return;
+  ATSHash64FNV1a h;
+
+  h.update(key, strlen(key));
+  h.final();
+  hash = h.get();
+  return &buckets[hash % SSL_ORIGIN_SESSION_CACHE_BUCKETS];
+}
+
+bool
+SSLOriginSessionCache::resumeSession(const char *key, SSL *ssl)
+{
+  uint64_t hash;
+  Bucket *bucket = getBucket(key, hash);
+  bool found = false;
+
+  SCOPED_MUTEX_LOCK(lock, bucket->mutex, this_ethread());
+  for (SSLOriginSession *entry = bucket->sessions.head; entry; entry = entry->link.next) {
+    if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+      // SSL_set_session() takes its own reference, the entry can be replaced or dropped right after.
+      found = SSL_set_session(ssl, entry->session);
+      break;
     }
   }
+
+  Debug("ssl.origin_session_cache", "%s session for '%s'", found ? "resuming" : "no", key);
+  return found;
 }
 
-/* Session Bucket */
-SSLSessionBucket::SSLSessionBucket() : mutex(new_ProxyMutex())
+void
+SSLOriginSessionCache::insertSession(const char *key, SSL_SESSION *sess)
 {
+  uint64_t hash;
+  Bucket *bucket = getBucket(key, hash);
+  SSLOriginSession *entry;
+
+  SCOPED_MUTEX_LOCK(lock, bucket->mutex, this_ethread());
+  for (entry = bucket->sessions.head; entry; entry = entry->link.next) {
+    if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+      bucket->sessions.remove(entry);
+      SSL_SESSION_free(entry->session);
+      break;
+    }
+  }
+
+  if (entry == NULL) {
+    if (bucket->count >= bucket_size) {
+      entry = bucket->sessions.tail;
+      bucket->sessions.remove(entry);
+      SSL_SESSION_free(entry->session);
+      SSL_INCREMENT_DYN_STAT(ssl_origin_session_cache_eviction);
+    } else {
+      entry = new SSLOriginSession;
+      ++bucket->count;
+    }
+    entry->hash = hash;
+    ink_strlcpy(entry->key, key, sizeof(entry->key));
+  }
+
+  entry->session = sess;
+  bucket->sessions.push(entry);
+  Debug("ssl.origin_session_cache", "stored session for '%s'", key);
 }
 
-SSLSessionBucket::~SSLSessionBucket()
+void
+SSLOriginSessionCache::removeSession(const char *key)
 {
+  uint64_t hash;
+  Bucket *bucket = getBucket(key, hash);
+
+  SCOPED_MUTEX_LOCK(lock, bucket->mutex, this_ethread());
+  for (SSLOriginSession *entry = bucket->sessions.head; entry; entry = entry->link.next) {
+    if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+      bucket->sessions.remove(entry);
+      --bucket->count;
+      SSL_SESSION_free(entry->session);
+      delete entry;
+      Debug("ssl.origin_session_cache", "removed session for '%s'", key);
+      break;
+    }
+  }
 }
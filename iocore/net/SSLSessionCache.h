@@ -39,6 +39,7 @@ struct SSLSessionID {
   char bytes[SSL_MAX_SSL_SESSION_ID_LENGTH];
   size_t len;
 
+  SSLSessionID() : len(0) {}
   SSLSessionID(const unsigned char *s, size_t l) : len(l)
   {
     ink_release_assert(l <= sizeof(bytes));
@@ -109,21 +110,34 @@ struct SSLSessionID {
   }
 };
 
-class SSLSession
-{
-public:
+// A session may be stored in this many slots of its bucket, starting at the one
+// its hash selects.
+#define SSL_SESSION_CACHE_PROBES 8
+// Times a lookup copies a slot again because it was changed during the copy.
+#define SSL_SESSION_CACHE_READ_RETRIES 4
+
+struct SSLSessionSlot {
+  volatile uint32_t version;     // odd while the slot is being written
+  volatile uint64_t hash;        // SSLSessionID::hash() of the session with bit 0 set, 0 if free
+  volatile ink_hrtime last_used; // for least recently used eviction
   SSLSessionID session_id;
-  Ptr<IOBufferData> asn1_data; /* this is the ASN1 representation of the SSL_CTX */
   size_t len_asn1_data;
+  unsigned char asn1_data[SSL_MAX_SESSION_SIZE]; /* this is the ASN1 representation of the SSL_SESSION */
 
-  SSLSession(const SSLSessionID &id, Ptr<IOBufferData> ssl_asn1_data, size_t len_asn1)
-    : session_id(id), asn1_data(ssl_asn1_data), len_asn1_data(len_asn1)
-  {
-  }
-
-  LINK(SSLSession, link);
+  SSLSessionSlot() : version(0), hash(0), last_used(0), len_asn1_data(0) {}
 };
 
+/**
+  A bucket is a table of session_cache_max_bucket_size slots. A session is
+  kept in one of the SSL_SESSION_CACHE_PROBES slots following the one selected
+  by its hash, replacing the least recently used of them when they are all
+  taken.
+
+  Inserts and removals hold the bucket mutex and bump the version of the slot
+  they change before and after writing it. Lookups take no lock, they copy a
+  slot and retry if its version changed or was odd meanwhile. The slots are
+  allocated on the first insert and freed with the bucket.
+*/
 class SSLSessionBucket
 {
 public:
@@ -136,10 +150,12 @@ public:
 private:
   /* these method must be used while hold the lock */
   void print(const char *) const;
-  void removeOldestSession();
+  SSLSessionSlot *findSlot(const SSLSessionID &, uint64_t hash, bool for_insert);
 
   Ptr<ProxyMutex> mutex;
-  CountQueue<SSLSession> queue;
+  SSLSessionSlot *volatile slots;
+  const int nslots;
+  int used; // slots holding a session
 };
 
 class SSLSessionCache
@@ -156,4 +172,50 @@ private:
   size_t nbuckets;
 };
 
+// Buckets of the origin session cache, each has its own lock.
+#define SSL_ORIGIN_SESSION_CACHE_BUCKETS 256
+// An SNI name and an origin address with its port.
+#define SSL_ORIGIN_SESSION_KEY_SIZE (TS_MAX_HOST_NAME_LEN + INET6_ADDRPORTSTRLEN + 2)
+
+struct SSLOriginSession {
+  uint64_t hash;
+  char key[SSL_ORIGIN_SESSION_KEY_SIZE];
+  SSL_SESSION *session;
+
+  LINK(SSLOriginSession, link);
+};
+
+/**
+  The sessions of connections to origin servers, by SNI name and origin
+  address, so a new connection to the same origin resumes the session of an
+  earlier one instead of doing a full handshake.
+
+  An origin has a single session, the one it sent last. A bucket keeps its
+  origins most recently stored first and drops the oldest when full.
+*/
+class SSLOriginSessionCache
+{
+public:
+  explicit SSLOriginSessionCache(size_t size);
+  ~SSLOriginSessionCache();
+
+  /// Set the session stored for @a key on @a ssl. @return @c true if there was one.
+  bool resumeSession(const char *key, SSL *ssl);
+  /// Store @a sess for @a key, taking over the caller's reference.
+  void insertSession(const char *key, SSL_SESSION *sess);
+  void removeSession(const char *key);
+
+private:
+  struct Bucket {
+    Ptr<ProxyMutex> mutex;
+    Queue<SSLOriginSession> sessions;
+    size_t count;
+  };
+
+  Bucket *getBucket(const char *key, uint64_t &hash) const;
+
+  Bucket *buckets;
+  size_t bucket_size;
+};
+
 #endif /* __SSLSESSIONCACHE_H__ */
@@ -90,22 +90,6 @@ typedef const SSL_METHOD *ink_ssl_method_t;
 typedef SSL_METHOD *ink_ssl_method_t;
 #endif
 
-// gather user provided settings from ssl_multicert.config in to a single struct
-struct ssl_user_config {
-  ssl_user_config() : session_ticket_enabled(1), opt(SSLCertContext::OPT_NONE) {}
-
-  int session_ticket_enabled; // ssl_ticket_enabled - session ticket enabled
-  ats_scoped_str addr;        // dest_ip - IPv[64] address to match
-  ats_scoped_str cert;        // ssl_cert_name - certificate
-  ats_scoped_str first_cert;  // the first certificate name when multiple cert files are in 'ssl_cert_name'
-  ats_scoped_str ca;          // ssl_ca_name - CA public certificate
-  ats_scoped_str key;         // ssl_key_name - Private key
-  ats_scoped_str
-    ticket_key_filename; // ticket_key_name - session key file. [key_name (16Byte) + HMAC_secret (16Byte) + AES_key (16Byte)]
-  ats_scoped_str dialog; // ssl_key_dialog - Private key dialog
-  SSLCertContext::Option opt;
-};
-
 SSLSessionCache *session_cache; // declared extern in P_SSLConfig.h
 
 // Check if the ticket_key callback #define is available, and if so, enable session tickets.
@@ -117,6 +101,10 @@ static void session_ticket_free(void *, void *, CRYPTO_EX_DATA *, int, long, voi
 static int ssl_callback_session_ticket(SSL *, unsigned char *, unsigned char *, EVP_CIPHER_CTX *, HMAC_CTX *, int);
 #endif /* SSL_CTX_set_tlsext_ticket_key_cb */
 
+#if TS_USE_TLS_SNI
+static SSL_CTX *ssl_lazy_context_select(const SSLCertLookup *lookup, SSLLazyContext *lazy);
+#endif
+
 #if HAVE_OPENSSL_SESSION_TICKETS
 static int ssl_session_ticket_index = -1;
 #endif
@@ -126,6 +114,7 @@ static ink_mutex *mutex_buf = NULL;
 static bool open_ssl_initialized = false;
 
 RecRawStatBlock *ssl_rsb = NULL;
+RecHistogramBlock *ssl_hist = NULL;
 static InkHashTable *ssl_cipher_name_table = NULL;
 
 /* Using pthread thread ID and mutex functions directly, instead of
@@ -275,6 +264,7 @@ int
 set_context_cert(SSL *ssl)
 {
   SSL_CTX *ctx = NULL;
+  SSL_CTX *lazy_ctx = NULL;
   SSLCertContext *cc = NULL;
   SSLCertificateConfig::scoped_config lookup;
   const char *servername = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
@@ -310,6 +300,9 @@ set_context_cert(SSL *ssl)
       retval = -1;
       goto done;
     }
+    if (cc && cc->lazy) {
+      ctx = lazy_ctx = ssl_lazy_context_select(lookup, cc->lazy);
+    }
   }
 
   // If there's no match on the server name, try to match on the peer address.
@@ -341,6 +334,9 @@ set_context_cert(SSL *ssl)
     goto done;
   }
 done:
+  if (lazy_ctx) {
+    SSL_CTX_free(lazy_ctx); // the connection holds its own reference now
+  }
   return retval;
 }
 
@@ -373,6 +369,8 @@ ssl_cert_callback(SSL *ssl, void * /*arg*/)
   // stop the accept processing
   if (!reenabled) {
     retval = -1; // Pause
+  } else if (netvc->offloadHandshake()) {
+    retval = -1; // Pause, resumed on an ET_CRYPTO thread
   }
 
   // Return 1 for success, 0 for error, or -1 to pause
@@ -781,6 +779,16 @@ SSLRecRawStatSyncCount(const char *name, RecDataT data_type, RecData *data, RecR
         timeouts += SSL_CTX_sess_timeouts(cc->ctx);
       }
     }
+
+    Vec<SSL_CTX *> lazy_ctxs;
+    certLookup->acquireLazyContexts(lazy_ctxs);
+    for (unsigned i = 0; i < lazy_ctxs.length(); i++) {
+      sessions += SSL_CTX_sess_accept_good(lazy_ctxs[i]);
+      hits += SSL_CTX_sess_hits(lazy_ctxs[i]);
+      misses += SSL_CTX_sess_misses(lazy_ctxs[i]);
+      timeouts += SSL_CTX_sess_timeouts(lazy_ctxs[i]);
+      SSL_CTX_free(lazy_ctxs[i]);
+    }
   }
 
   SSL_SET_COUNT_DYN_STAT(ssl_user_agent_sessions_stat, sessions);
@@ -869,6 +877,8 @@ SSLInitializeStatistics()
   // Allocate SSL statistics block.
   ssl_rsb = RecAllocateRawStatBlock((int)Ssl_Stat_Count);
   ink_assert(ssl_rsb != NULL);
+  ssl_hist = RecAllocateHistogramBlock((int)Ssl_Hist_Count);
+  ink_assert(ssl_hist != NULL);
 
   // SSL client errors.
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.user_agent_other_errors", RECD_INT, RECP_PERSISTENT,
@@ -926,6 +936,10 @@ SSLInitializeStatistics()
                      (int)ssl_total_handshake_time_stat, RecRawStatSyncSum);
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_success_handshake_count_in", RECD_INT, RECP_PERSISTENT,
                      (int)ssl_total_success_handshake_count_in_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_handshakes_offloaded", RECD_INT, RECP_PERSISTENT,
+                     (int)ssl_total_handshakes_offloaded_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_lazy_contexts_built", RECD_INT, RECP_PERSISTENT,
+                     (int)ssl_total_lazy_contexts_built_stat, RecRawStatSyncCount);
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_success_handshake_count_out", RECD_INT, RECP_PERSISTENT,
                      (int)ssl_total_success_handshake_count_out_stat, RecRawStatSyncCount);
 
@@ -961,6 +975,21 @@ SSLInitializeStatistics()
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ssl_session_cache_lock_contention", RECD_INT, RECP_PERSISTENT,
                      (int)ssl_session_cache_lock_contention, RecRawStatSyncCount);
 
+  RecRegisterHistogram(ssl_hist, RECT_PROCESS, "proxy.process.ssl.ssl_session_cache_probe_length",
+                       (int)ssl_session_cache_probe_length_hist);
+
+  RecRegisterHistogram(ssl_hist, RECT_PROCESS, "proxy.process.ssl.ssl_session_cache_bucket_occupancy",
+                       (int)ssl_session_cache_bucket_occupancy_hist);
+
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.origin_session_cache_hit", RECD_INT, RECP_PERSISTENT,
+                     (int)ssl_origin_session_cache_hit, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.origin_session_cache_miss", RECD_INT, RECP_PERSISTENT,
+                     (int)ssl_origin_session_cache_miss, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.origin_session_cache_eviction", RECD_INT, RECP_PERSISTENT,
+                     (int)ssl_origin_session_cache_eviction, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.origin_session_reused", RECD_INT, RECP_PERSISTENT,
+                     (int)ssl_origin_session_reused, RecRawStatSyncCount);
+
   /* error stats */
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ssl_error_want_write", RECD_INT, RECP_PERSISTENT,
                      (int)ssl_error_want_write, RecRawStatSyncCount);
@@ -1689,6 +1718,55 @@ ssl_set_handshake_callbacks(SSL_CTX *ctx)
 #endif
 }
 
+static void
+ssl_set_server_callbacks(SSL_CTX *ctx)
+{
+  SSL_CTX_set_info_callback(ctx, ssl_callback_info);
+
+#if TS_USE_TLS_NPN
+  SSL_CTX_set_next_protos_advertised_cb(ctx, SSLNetVConnection::advertise_next_protocol, NULL);
+#endif /* TS_USE_TLS_NPN */
+
+#if TS_USE_TLS_ALPN
+  SSL_CTX_set_alpn_select_cb(ctx, SSLNetVConnection::select_next_protocol, NULL);
+#endif /* TS_USE_TLS_ALPN */
+}
+
+// Apply the ticket and OCSP stapling settings of an ssl_multicert line to its context.
+static void
+ssl_set_server_options(SSL_CTX *ctx, const ssl_user_config &sslMultCertSettings, Vec<X509 *> &cert_list)
+{
+  const char *certname = sslMultCertSettings.cert.get();
+
+#if defined(SSL_OP_NO_TICKET)
+  // Session tickets are enabled by default. Disable if explicitly requested.
+  if (sslMultCertSettings.session_ticket_enabled == 0) {
+    SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    Debug("ssl", "ssl session ticket is disabled");
+  }
+#endif
+
+#ifdef HAVE_OPENSSL_OCSP_STAPLING
+  if (SSLConfigParams::ssl_ocsp_enabled) {
+    Debug("ssl", "ssl ocsp stapling is enabled");
+    SSL_CTX_set_tlsext_status_cb(ctx, ssl_callback_ocsp_stapling);
+    for (unsigned i = 0; i < cert_list.length(); ++i) {
+      if (!ssl_stapling_init_cert(ctx, cert_list[i], certname)) {
+        Warning("fail to configure SSL_CTX for OCSP Stapling info for certificate at %s", (const char *)certname);
+      }
+    }
+  } else {
+    Debug("ssl", "ssl ocsp stapling is disabled");
+  }
+#else
+  (void)cert_list;
+  (void)certname;
+  if (SSLConfigParams::ssl_ocsp_enabled) {
+    Warning("fail to enable ssl ocsp stapling, this openssl version does not support it");
+  }
+#endif /* HAVE_OPENSSL_OCSP_STAPLING */
+}
+
 static SSL_CTX *
 ssl_store_ssl_context(const SSLConfigParams *params, SSLCertLookup *lookup, const ssl_user_config &sslMultCertSettings)
 {
@@ -1705,15 +1783,7 @@ ssl_store_ssl_context(const SSLConfigParams *params, SSLCertLookup *lookup, cons
   // The certificate callbacks are set by the caller only
   // for the default certificate
 
-  SSL_CTX_set_info_callback(ctx, ssl_callback_info);
-
-#if TS_USE_TLS_NPN
-  SSL_CTX_set_next_protos_advertised_cb(ctx, SSLNetVConnection::advertise_next_protocol, NULL);
-#endif /* TS_USE_TLS_NPN */
-
-#if TS_USE_TLS_ALPN
-  SSL_CTX_set_alpn_select_cb(ctx, SSLNetVConnection::select_next_protocol, NULL);
-#endif /* TS_USE_TLS_ALPN */
+  ssl_set_server_callbacks(ctx);
 
   const char *certname = sslMultCertSettings.cert.get();
   for (unsigned i = 0; i < cert_list.length(); ++i) {
@@ -1764,32 +1834,7 @@ ssl_store_ssl_context(const SSLConfigParams *params, SSLCertLookup *lookup, cons
 #endif
   }
 
-
-#if defined(SSL_OP_NO_TICKET)
-  // Session tickets are enabled by default. Disable if explicitly requested.
-  if (sslMultCertSettings.session_ticket_enabled == 0) {
-    SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
-    Debug("ssl", "ssl session ticket is disabled");
-  }
-#endif
-
-#ifdef HAVE_OPENSSL_OCSP_STAPLING
-  if (SSLConfigParams::ssl_ocsp_enabled) {
-    Debug("ssl", "ssl ocsp stapling is enabled");
-    SSL_CTX_set_tlsext_status_cb(ctx, ssl_callback_ocsp_stapling);
-    for (unsigned i = 0; i < cert_list.length(); ++i) {
-      if (!ssl_stapling_init_cert(ctx, cert_list[i], certname)) {
-        Warning("fail to configure SSL_CTX for OCSP Stapling info for certificate at %s", (const char *)certname);
-      }
-    }
-  } else {
-    Debug("ssl", "ssl ocsp stapling is disabled");
-  }
-#else
-  if (SSLConfigParams::ssl_ocsp_enabled) {
-    Warning("fail to enable ssl ocsp stapling, this openssl version does not support it");
-  }
-#endif /* HAVE_OPENSSL_OCSP_STAPLING */
+  ssl_set_server_options(ctx, sslMultCertSettings, cert_list);
 
   // Insert additional mappings. Note that this maps multiple keys to the same value, so when
   // this code is updated to reconfigure the SSL certificates, it will need some sort of
@@ -1818,6 +1863,128 @@ ssl_store_ssl_context(const SSLConfigParams *params, SSLCertLookup *lookup, cons
   return ctx;
 }
 
+// Index the names of a line without a dest_ip to a context that is built on first use. Only the
+// certificates are read here, see ssl_lazy_context_select().
+static void
+ssl_store_lazy_context(const SSLConfigParams *params, SSLCertLookup *lookup, ssl_user_config *sslMultCertSettings)
+{
+  SSLLazyContext *lazy = new SSLLazyContext(sslMultCertSettings);
+  const char *certname = sslMultCertSettings->cert.get();
+  SimpleTokenizer cert_tok(certname, SSL_CERT_SEPARATE_DELIM);
+
+  lookup->lazy_contexts.push_back(lazy);
+
+  Debug("ssl", "importing SNI names from %s, deferring its SSL_CTX", certname);
+  for (const char *filename = cert_tok.getNext(); filename; filename = cert_tok.getNext()) {
+    ats_scoped_str completeServerCertPath(Layout::relative_to(params->serverCertPathOnly, filename));
+    scoped_BIO bio(BIO_new_file(completeServerCertPath, "r"));
+    X509 *cert = NULL;
+
+    if (bio) {
+      cert = PEM_read_bio_X509(bio.get(), NULL, 0, NULL);
+    }
+    if (cert && 0 > SSLCheckServerCertNow(cert, certname)) {
+      Debug("ssl", "Marking certificate as NOT VALID: %s", certname);
+      lookup->is_valid = false;
+    }
+    if (SSLConfigParams::load_ssl_file_cb) {
+      SSLConfigParams::load_ssl_file_cb(completeServerCertPath, CONFIG_FLAG_UNVERSIONED);
+    }
+    ssl_index_certificate(lookup, SSLCertContext(lazy, sslMultCertSettings->opt), cert, completeServerCertPath);
+    if (cert) {
+      X509_free(cert);
+    }
+  }
+}
+
+#if TS_USE_TLS_SNI
+// Build the context of a lazily loaded line, it is only selected by name so the ticket keys are
+// not kept, see ssl_callback_session_ticket().
+static SSL_CTX *
+ssl_build_lazy_context(const SSLConfigParams *params, const ssl_user_config &sslMultCertSettings)
+{
+  Vec<X509 *> cert_list;
+  SSL_CTX *ctx = SSLInitServerContext(params, sslMultCertSettings, cert_list);
+
+  if (!ctx) {
+    return NULL;
+  }
+
+  ssl_set_server_callbacks(ctx);
+  if (sslMultCertSettings.session_ticket_enabled != 0) {
+    ats_scoped_str ticket_key_path;
+    if (sslMultCertSettings.ticket_key_filename) {
+      ticket_key_path = Layout::relative_to(params->serverCertPathOnly, sslMultCertSettings.ticket_key_filename);
+    }
+    ticket_block_free(ssl_context_enable_tickets(ctx, ticket_key_path));
+  }
+  ssl_set_server_options(ctx, sslMultCertSettings, cert_list);
+
+  if (SSLConfigParams::init_ssl_ctx_cb) {
+    SSLConfigParams::init_ssl_ctx_cb(ctx, true);
+  }
+  for (unsigned int i = 0; i < cert_list.length(); i++) {
+    X509_free(cert_list[i]);
+  }
+  return ctx;
+}
+
+// Return a reference to the context of a lazily loaded line, building it if it was not built yet or
+// was freed since. The caller must SSL_CTX_free() it.
+static SSL_CTX *
+ssl_lazy_context_select(const SSLCertLookup *lookup, SSLLazyContext *lazy)
+{
+  SSL_CTX *ctx;
+  bool built = false;
+
+  lazy->referenced = true;
+  if ((ctx = lazy->acquire()) != NULL) {
+    return ctx;
+  }
+
+  ink_mutex_acquire(&lazy->mutex);
+  if (lazy->ctx == NULL && !lazy->failed) {
+    SSLConfig::scoped_config params;
+
+    lazy->ctx = ssl_build_lazy_context(params, *lazy->settings);
+    if (lazy->ctx) {
+      Debug("ssl", "built SSL_CTX %p for %s", lazy->ctx, (const char *)lazy->settings->cert);
+      built = true;
+    } else {
+      Error("failed to build the SSL_CTX for %s, using the default context", (const char *)lazy->settings->cert);
+      lazy->failed = true;
+    }
+  }
+  ink_mutex_release(&lazy->mutex);
+
+  if (built) {
+    SSL_INCREMENT_DYN_STAT(ssl_total_lazy_contexts_built_stat);
+    lookup->lazyContextBuilt(lazy);
+  }
+  return lazy->acquire();
+}
+#endif /* TS_USE_TLS_SNI */
+
+// Everything the context of a line is built from. Lines without a dest_ip that have the same key
+// would build identical contexts for the same names, so only the first one is loaded.
+static char *
+ssl_context_key(const ssl_user_config &sslMultCertSettings)
+{
+  const char *parts[] = {sslMultCertSettings.cert, sslMultCertSettings.key, sslMultCertSettings.ca,
+                         sslMultCertSettings.ticket_key_filename, sslMultCertSettings.dialog};
+  size_t len = 32;
+
+  for (unsigned i = 0; i < countof(parts); ++i) {
+    parts[i] = parts[i] ? parts[i] : "";
+    len += strlen(parts[i]) + 1;
+  }
+
+  char *key = (char *)ats_malloc(len);
+  snprintf(key, len, "%d:%d:%s:%s:%s:%s:%s", sslMultCertSettings.session_ticket_enabled, sslMultCertSettings.opt, parts[0],
+           parts[1], parts[2], parts[3], parts[4]);
+  return key;
+}
+
 static bool
 ssl_extract_certificate(const matcher_line *line_info, ssl_user_config &sslMultCertSettings)
 {
@@ -1909,6 +2076,9 @@ SSLParseCertificateConfiguration(const SSLConfigParams *params, SSLCertLookup *l
   REC_ReadConfigInteger(elevate_setting, "proxy.config.ssl.cert.load_elevated");
   ElevateAccess elevate_access(elevate_setting ? ElevateAccess::FILE_PRIVILEGE : 0); // destructor will demote for us
 
+  lookup->lazy_max = params->ssl_ctx_lazy_max;
+  InkHashTable *loaded = ink_hash_table_create(InkHashTableKeyType_String);
+
   line = tokLine(file_buf, &tok_state);
   while (line != NULL) {
     line_num++;
@@ -1919,7 +2089,7 @@ SSLParseCertificateConfiguration(const SSLConfigParams *params, SSLCertLookup *l
     }
 
     if (*line != '\0' && *line != '#') {
-      ssl_user_config sslMultiCertSettings;
+      ats_scoped_obj<ssl_user_config> sslMultiCertSettings(new ssl_user_config);
       const char *errPtr;
 
       errPtr = parseConfigLine(line, &line_info, &sslCertTags);
@@ -1927,9 +2097,23 @@ SSLParseCertificateConfiguration(const SSLConfigParams *params, SSLCertLookup *l
       if (errPtr != NULL) {
         RecSignalWarning(REC_SIGNAL_CONFIG_ERROR, "%s: discarding %s entry at line %d: %s", __func__, params->configFilePath,
                          line_num, errPtr);
-      } else {
-        if (ssl_extract_certificate(&line_info, sslMultiCertSettings)) {
-          ssl_store_ssl_context(params, lookup, sslMultiCertSettings);
+      } else if (ssl_extract_certificate(&line_info, *sslMultiCertSettings)) {
+        if (sslMultiCertSettings->addr) {
+          ssl_store_ssl_context(params, lookup, *sslMultiCertSettings);
+        } else {
+          ats_scoped_str key(ssl_context_key(*sslMultiCertSettings));
+
+          if (ink_hash_table_isbound(loaded, key)) {
+            Debug("ssl", "%s entry at line %d has the same settings as a previous one, skipping it", params->configFilePath,
+                  line_num);
+          } else {
+            ink_hash_table_insert(loaded, key, NULL);
+            if (params->ssl_ctx_lazy_load) {
+              ssl_store_lazy_context(params, lookup, sslMultiCertSettings.release());
+            } else {
+              ssl_store_ssl_context(params, lookup, *sslMultiCertSettings);
+            }
+          }
         }
       }
     }
@@ -1937,6 +2121,8 @@ SSLParseCertificateConfiguration(const SSLConfigParams *params, SSLCertLookup *l
     line = tokLine(NULL, &tok_state);
   }
 
+  ink_hash_table_destroy(loaded);
+
   // We *must* have a default context even if it can't possibly work. The default context is used to
   // bootstrap the SSL handshake so that we can subsequently do the SNI lookup to switch to the real
   // context.
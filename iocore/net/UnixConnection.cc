@@ -328,6 +328,18 @@ Connection::connect(sockaddr const *target, NetVCOptions const &opt)
 
   cleaner<Connection> cleanup(this, &Connection::_cleanup); // mark for close until we succeed.
 
+#ifdef TCP_FASTOPEN_CONNECT
+  // With TCP Fast Open the SYN waits for the first write and carries it,
+  // connect() returns at once if the kernel has a cookie for the server.
+  if (SOCK_STREAM == sock_type && (opt.sockopt_flags & NetVCOptions::SOCK_OPT_TCP_FAST_OPEN)) {
+    ProxyMutex *mutex = this_ethread()->mutex;
+    if (0 == safe_setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, SOCKOPT_ON, sizeof(int))) {
+      NET_INCREMENT_DYN_STAT(net_fastopen_out_attempts_stat);
+      Debug("socket", "::connect: setsockopt() TCP_FASTOPEN_CONNECT on socket");
+    }
+  }
+#endif
+
   res = ::connect(fd, target, ats_ip_size(target));
 
   // It's only really an error if either the connect was blocking
@@ -240,11 +240,17 @@ net_signal_hook_callback(EThread *thread)
   char dummy[1024];
   ATS_UNUSED_RETURN(read(thread->evpipe[0], &dummy[0], 1024));
 #endif
+  // Clear only after draining, anything enqueued by a signaller which saw
+  // the flag still set is picked up when the event loop empties the queue.
+  ink_atomic_swap(&thread->signal_pending, 0);
 }
 
 static void
 net_signal_hook_function(EThread *thread)
 {
+  // Coalesce wakeups, the thread only needs to leave epoll_wait() once.
+  if (ink_atomic_swap(&thread->signal_pending, 1))
+    return;
 #if HAVE_EVENTFD
   uint64_t counter = 1;
   ATS_UNUSED_RETURN(write(thread->evfd, &counter, sizeof(uint64_t)));
@@ -288,7 +294,7 @@ initialize_thread_for_net(EThread *thread)
 
 // NetHandler method definitions
 
-NetHandler::NetHandler() : Continuation(NULL), trigger_event(0), keep_alive_queue_size(0), active_queue_size(0)
+NetHandler::NetHandler() : Continuation(NULL), trigger_event(0), batch_reads(false), keep_alive_queue_size(0), active_queue_size(0)
 {
   SET_HANDLER((NetContHandler)&NetHandler::startNetEvent);
 }
@@ -506,23 +512,34 @@ NetHandler::mainNetEvent(int event, Event *e)
   pd->result = 0;
 
 #if defined(USE_EDGE_TRIGGER)
-  // UnixNetVConnection *
-  while ((vc = read_ready_list.dequeue())) {
-    // Initialize the thread-local continuation flags
-    set_cont_flags(vc->control_flags);
-    if (vc->closed)
-      close_UnixNetVConnection(vc, trigger_event->ethread);
-    else if (vc->read.enabled && vc->read.triggered)
-      vc->net_read_io(this, trigger_event->ethread);
-    else if (!vc->read.enabled) {
-      read_ready_list.remove(vc);
+  // Connections are read a batch at a time, the sockets of the batch are
+  // read first and their continuations called back after, so the read and
+  // the callback paths each run over many connections in a row.
+  while (!read_ready_list.empty()) {
+    batch_reads = true;
+    for (int n = 0; n < NET_READ_BATCH && (vc = read_ready_list.dequeue()); n++) {
+      // Initialize the thread-local continuation flags
+      set_cont_flags(vc->control_flags);
+      if (vc->closed)
+        close_UnixNetVConnection(vc, trigger_event->ethread);
+      else if (vc->read.enabled && vc->read.triggered)
+        vc->net_read_io(this, trigger_event->ethread);
+      else if (!vc->read.enabled) {
+        read_ready_list.remove(vc);
 #if defined(solaris)
-      if (vc->read.triggered && vc->write.enabled) {
-        vc->ep.modify(-EVENTIO_READ);
-        vc->ep.refresh(EVENTIO_WRITE);
-        vc->writeReschedule(this);
-      }
+        if (vc->read.triggered && vc->write.enabled) {
+          vc->ep.modify(-EVENTIO_READ);
+          vc->ep.refresh(EVENTIO_WRITE);
+          vc->writeReschedule(this);
+        }
 #endif
+      }
+    }
+    batch_reads = false;
+
+    while ((vc = read_signal_list.dequeue())) {
+      set_cont_flags(vc->control_flags);
+      read_signal_batched(this, vc, trigger_event->ethread);
     }
   }
   while ((vc = write_ready_list.dequeue())) {
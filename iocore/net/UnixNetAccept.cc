@@ -23,6 +23,10 @@
 
 #include "P_Net.h"
 
+#if defined(linux)
+#include <linux/filter.h>
+#endif
+
 #ifdef ROUNDUP
 #undef ROUNDUP
 #endif
@@ -189,11 +193,14 @@ NetAccept::init_accept_per_thread(bool isTransparent)
   period = -HRTIME_MSECONDS(net_accept_period);
 
   NetAccept *a;
+  int own = 0;
   n = eventProcessor.n_threads_for_type[ET_NET];
   for (i = 0; i < n; i++) {
-    if (i < n - 1)
+    if (i < n - 1) {
       a = clone();
-    else
+      if (listen_per_thread && a->listen_reuse_port(isTransparent))
+        ++own;
+    } else
       a = this;
     EThread *t = eventProcessor.eventthread[ET_NET][i];
     PollDescriptor *pd = get_PollDescriptor(t);
@@ -202,23 +209,101 @@ NetAccept::init_accept_per_thread(bool isTransparent)
     a->mutex = get_NetHandler(t)->mutex;
     t->schedule_every(a, period, etype);
   }
+  if (listen_per_thread) {
+    if (own < n - 1)
+      Warning("%d of %d threads share a listen socket on port %d", n - own, n, ats_ip_port_host_order(&server.accept_addr));
+    else if (listen_per_thread > 1)
+      steer_by_cpu(n);
+  }
+}
+
+//
+// Replace the listen socket this was cloned with by one of its own, in the
+// same SO_REUSEPORT group, keep sharing the original if that fails.
+//
+bool
+NetAccept::listen_reuse_port(bool transparent)
+{
+  int shared_fd = server.fd;
+
+  server.fd = NO_FD;
+  callback_on_open = false;
+  if (do_listen(NON_BLOCKING, transparent) == 0) {
+    Debug("iocore_net_accept", "listening on port %d with fd %d", ats_ip_port_host_order(&server.accept_addr), server.fd);
+    return true;
+  }
+  server.fd = shared_fd;
+  server.f_reuse_port = false;
+  return false;
+}
+
+//
+// The kernel numbers the sockets of a SO_REUSEPORT group in the order they
+// started listening, which is the template followed by the clones for threads
+// 0 to n - 2. Send each connection to the socket of the thread with the index
+// of the CPU that received it, this keeps a connection on one CPU when the
+// threads are bound to logical processors.
+//
+void
+NetAccept::steer_by_cpu(int n)
+{
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+  struct sock_filter code[] = {
+    {BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t)(SKF_AD_OFF + SKF_AD_CPU)}, // A = cpu
+    {BPF_ALU | BPF_ADD | BPF_K, 0, 0, 1},                                    // A += 1
+    {BPF_ALU | BPF_MOD | BPF_K, 0, 0, (uint32_t)n},                          // A %= n
+    {BPF_RET | BPF_A, 0, 0, 0},                                              // socket index
+  };
+  struct sock_fprog prog;
+
+  prog.len = countof(code);
+  prog.filter = code;
+  if (safe_setsockopt(server.fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, (char *)&prog, sizeof(prog)) < 0)
+    Warning("unable to steer connections on port %d by CPU: %s", ats_ip_port_host_order(&server.accept_addr), strerror(errno));
+#else
+  (void)n;
+  Warning("steering connections by CPU is not supported on this platform");
+#endif
 }
 
 int
 NetAccept::do_listen(bool non_blocking, bool transparent)
 {
   int res = 0;
+  // Of the port's flags only TCP Fast Open applies to the listen socket
+  uint32_t listen_flags = sockopt_flags & NetVCOptions::SOCK_OPT_TCP_FAST_OPEN;
 
   if (server.fd != NO_FD) {
-    if ((res = server.setup_fd_for_listen(non_blocking, recv_bufsize, send_bufsize, transparent))) {
+    if ((res = server.setup_fd_for_listen(non_blocking, recv_bufsize, send_bufsize, transparent, listen_flags))) {
       Warning("unable to listen on main accept port %d: errno = %d, %s", ntohs(server.accept_addr.port()), errno, strerror(errno));
       goto Lretry;
     }
   } else {
   Lretry:
-    if ((res = server.listen(non_blocking, recv_bufsize, send_bufsize, transparent)))
+    if ((res = server.listen(non_blocking, recv_bufsize, send_bufsize, transparent, listen_flags)))
       Warning("unable to listen on port %d: %d %d, %s", ntohs(server.accept_addr.port()), res, errno, strerror(errno));
   }
+  if (res == 0) {
+#ifdef TCP_DEFER_ACCEPT
+    // set tcp defer accept timeout if it is configured, this will not trigger an accept until there is
+    // data on the socket ready to be read
+    int should_filter_int = 0;
+    REC_ReadConfigInteger(should_filter_int, "proxy.config.net.defer_accept");
+    if (should_filter_int > 0) {
+      setsockopt(server.fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &should_filter_int, sizeof(int));
+    }
+#endif
+#ifdef TCP_INIT_CWND
+    int tcp_init_cwnd = 0;
+    REC_ReadConfigInteger(tcp_init_cwnd, "proxy.config.http.server_tcp_init_cwnd");
+    if (tcp_init_cwnd > 0) {
+      Debug("net", "Setting initial congestion window to %d", tcp_init_cwnd);
+      if (setsockopt(server.fd, IPPROTO_TCP, TCP_INIT_CWND, &tcp_init_cwnd, sizeof(int)) != 0) {
+        Error("Cannot set initial congestion window to %d", tcp_init_cwnd);
+      }
+    }
+#endif
+  }
   if (callback_on_open && !action_->cancelled) {
     if (res)
       action_->continuation->handleEvent(NET_EVENT_ACCEPT_FAILED, this);
@@ -317,6 +402,12 @@ NetAccept::acceptEvent(int event, void *ep)
   MUTEX_TRY_LOCK(lock, m, e->ethread);
   if (lock.is_locked()) {
     if (action_->cancelled) {
+      // As in acceptFastEvent(), the sockets opened by listen_reuse_port()
+      // are closed here, and a per thread clone leaves its poll descriptor.
+      this->ep.stop();
+      if (server.f_reuse_port) {
+        server.close();
+      }
       e->cancel();
       NET_DECREMENT_DYN_STAT(net_accepts_currently_open_stat);
       delete this;
@@ -357,6 +448,12 @@ NetAccept::acceptFastEvent(int event, void *ep)
   UnixNetVConnection *vc = NULL;
   int loop = accept_till_done;
 
+  // Cancelling the accept only closes the socket of the template, those
+  // opened by listen_reuse_port() are closed here.
+  if (action_->cancelled && server.f_reuse_port) {
+    goto Lerror;
+  }
+
   do {
     if (!backdoor && check_net_throttle(ACCEPT, Thread::get_hrtime())) {
       ifd = -1;
@@ -474,6 +571,7 @@ Ldone:
   return EVENT_CONT;
 
 Lerror:
+  this->ep.stop();
   server.close();
   e->cancel();
   if (vc)
@@ -508,7 +606,7 @@ NetAccept::acceptLoopEvent(int event, Event *e)
 
 NetAccept::NetAccept()
   : Continuation(NULL), period(0), alloc_cache(0), ifd(-1), callback_on_open(false), backdoor(false), recv_bufsize(0),
-    send_bufsize(0), sockopt_flags(0), packet_mark(0), packet_tos(0), etype(0)
+    send_bufsize(0), sockopt_flags(0), packet_mark(0), packet_tos(0), etype(0), listen_per_thread(0)
 {
 }
 
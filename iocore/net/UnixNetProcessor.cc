@@ -144,6 +144,13 @@ UnixNetProcessor::accept_internal(Continuation *cont, int fd, AcceptOptions cons
   if (na->callback_on_open)
     na->mutex = cont->mutex;
   if (opt.frequent_accept) { // true
+    REC_ReadConfigInteger(na->listen_per_thread, "proxy.config.net.listen_per_thread");
+    if (na->listen_per_thread > 0) {
+      // every net thread accepts from a socket of its own, no accept threads
+      Debug("iocore_net_accept", "Listening on port %d from every thread", ats_ip_port_host_order(&accept_ip));
+      na->server.f_reuse_port = true;
+      accept_threads = 0;
+    }
     if (accept_threads > 0) {
       if (0 == na->do_listen(BLOCKING, opt.f_inbound_transparent)) {
         for (int i = 1; i < accept_threads; ++i) {
@@ -175,23 +182,6 @@ UnixNetProcessor::accept_internal(Continuation *cont, int fd, AcceptOptions cons
     na->init_accept(NULL, opt.f_inbound_transparent);
   }
 
-#ifdef TCP_DEFER_ACCEPT
-  // set tcp defer accept timeout if it is configured, this will not trigger an accept until there is
-  // data on the socket ready to be read
-  if (should_filter_int > 0) {
-    setsockopt(na->server.fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &should_filter_int, sizeof(int));
-  }
-#endif
-#ifdef TCP_INIT_CWND
-  int tcp_init_cwnd = 0;
-  REC_ReadConfigInteger(tcp_init_cwnd, "proxy.config.http.server_tcp_init_cwnd");
-  if (tcp_init_cwnd > 0) {
-    Debug("net", "Setting initial congestion window to %d", tcp_init_cwnd);
-    if (setsockopt(na->server.fd, IPPROTO_TCP, TCP_INIT_CWND, &tcp_init_cwnd, sizeof(int)) != 0) {
-      Error("Cannot set initial congestion window to %d", tcp_init_cwnd);
-    }
-  }
-#endif
   return na->action_;
 }
 
@@ -97,6 +97,15 @@ net_activity(UnixNetVConnection *vc, EThread *thread)
 void
 close_UnixNetVConnection(UnixNetVConnection *vc, EThread *t)
 {
+  // An ET_CRYPTO thread still uses the socket and the SSL object, the VC is
+  // closed when the handshake comes back to the net thread.
+  if (vc->getSSLHandShakeOffloaded()) {
+    if (!vc->closed) {
+      vc->closed = 1;
+    }
+    return;
+  }
+
   NetHandler *nh = vc->nh;
   vc->cancel_OOB();
   vc->ep.stop();
@@ -125,6 +134,7 @@ close_UnixNetVConnection(UnixNetVConnection *vc, EThread *t)
     nh->cop_list.remove(vc);
     nh->read_ready_list.remove(vc);
     nh->write_ready_list.remove(vc);
+    nh->read_signal_list.remove(vc);
     if (vc->read.in_enabled_list) {
       nh->read_enable_list.remove(vc);
       vc->read.in_enabled_list = 0;
@@ -242,6 +252,47 @@ write_signal_error(NetHandler *nh, UnixNetVConnection *vc, int lerrno)
   return write_signal_done(VC_EVENT_ERROR, nh, vc);
 }
 
+// Is the READ_READY of a batched read still owed to the reader? Not if the
+// VIO was closed or replaced since, do_io_read() clears signal_ndone.
+static inline bool
+read_signal_owed(const NetState *s)
+{
+  return s->vio.op == VIO::READ && s->signal_ndone && s->vio.ndone >= s->signal_ndone;
+}
+
+// Signal the data read to the continuation and reschedule the
+// UnixNetVConnection. The VIO mutex is held, as lock_mutex.
+static void
+read_signal_ready(NetHandler *nh, UnixNetVConnection *vc, const ProxyMutex *lock_mutex)
+{
+  NetState *s = &vc->read;
+
+  s->signal_ndone = 0;
+  // If there are no more bytes to read, signal read complete
+  if (s->vio.ntodo() <= 0) {
+    read_signal_done(VC_EVENT_READ_COMPLETE, nh, vc);
+    Debug("iocore_net", "read_from_net, read finished - signal done");
+    return;
+  } else {
+    if (read_signal_and_update(VC_EVENT_READ_READY, vc) != EVENT_CONT)
+      return;
+    // change of lock... don't look at shared variables!
+    if (lock_mutex != s->vio.mutex.m_ptr) {
+      read_reschedule(nh, vc);
+      return;
+    }
+  }
+  // If here are is no more room, or nothing to do, disable the connection.
+  // A parked buffer has room, it is not given a block before the next read.
+  MIOBuffer *writer = s->vio.buffer.writer();
+  if (s->vio.ntodo() <= 0 || !s->enabled || (!writer->empty() && !writer->write_avail())) {
+    read_disable(nh, vc);
+    return;
+  }
+
+  read_reschedule(nh, vc);
+}
+
 // Read the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection by moving the VC
 // onto or off of the ready_list.
@@ -273,6 +324,13 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     return;
   }
 
+  // A batched read that could not be signalled yet
+  if (read_signal_owed(s)) {
+    read_signal_ready(nh, vc, lock.get_mutex());
+    return;
+  }
+  s->signal_ndone = 0;
+
   MIOBufferAccessor &buf = s->vio.buffer;
   ink_assert(buf.writer());
 
@@ -282,6 +340,8 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     read_disable(nh, vc);
     return;
   }
+  // A parked buffer only gets a block once there is something to read
+  bool parked = buf.writer()->empty();
   int64_t toread = buf.writer()->write_avail();
   if (toread > ntodo)
     toread = ntodo;
@@ -350,6 +410,9 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     if (r <= 0) {
       if (r == -EAGAIN || r == -ENOTCONN) {
         NET_INCREMENT_DYN_STAT(net_calls_to_read_nodata_stat);
+        if (parked) {
+          buf.writer()->release_blocks();
+        }
         vc->read.triggered = 0;
         nh->read_ready_list.remove(vc);
         return;
@@ -380,21 +443,15 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
 
   // Signal read ready, check if user is not done
   if (r) {
-    // If there are no more bytes to read, signal read complete
     ink_assert(ntodo >= 0);
-    if (s->vio.ntodo() <= 0) {
-      read_signal_done(VC_EVENT_READ_COMPLETE, nh, vc);
-      Debug("iocore_net", "read_from_net, read finished - signal done");
-      return;
+    if (nh->batch_reads) {
+      // signalled with the rest of the batch
+      s->signal_ndone = s->vio.ndone;
+      nh->read_signal_list.in_or_enqueue(vc);
     } else {
-      if (read_signal_and_update(VC_EVENT_READ_READY, vc) != EVENT_CONT)
-        return;
-      // change of lock... don't look at shared variables!
-      if (lock.get_mutex() != s->vio.mutex.m_ptr) {
-        read_reschedule(nh, vc);
-        return;
-      }
+      read_signal_ready(nh, vc, lock.get_mutex());
     }
+    return;
   }
   // If here are is no more room, or nothing to do, disable the connection
   if (s->vio.ntodo() <= 0 || !s->enabled || !buf.writer()->write_avail()) {
@@ -405,6 +462,41 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   read_reschedule(nh, vc);
 }
 
+// Signal a read done while the NetHandler was reading a batch of
+// connections, unless the VIO was closed, changed or disabled since.
+void
+read_signal_batched(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
+{
+  NetState *s = &vc->read;
+
+  MUTEX_TRY_LOCK_FOR(lock, s->vio.mutex, thread, s->vio._cont);
+
+  if (!lock.is_locked()) {
+    // read_from_net() signals it
+    s->triggered = 1;
+    read_reschedule(nh, vc);
+    return;
+  }
+
+  if (vc->closed) {
+    close_UnixNetVConnection(vc, thread);
+    return;
+  }
+  if (!read_signal_owed(s)) {
+    // a new read was set up, it is owed nothing
+    s->signal_ndone = 0;
+    read_reschedule(nh, vc);
+    return;
+  }
+  if (!s->enabled) {
+    // signalled when it is enabled again
+    read_disable(nh, vc);
+    return;
+  }
+
+  read_signal_ready(nh, vc, lock.get_mutex());
+}
+
 
 //
 // Write the data for a UnixNetVConnection.
@@ -634,6 +726,7 @@ UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
   read.vio._cont = c;
   read.vio.nbytes = nbytes;
   read.vio.ndone = 0;
+  read.signal_ndone = 0;
   read.vio.vc_server = (VConnection *)this;
   if (buf) {
     read.vio.buffer.writer_for(buf);
@@ -1411,3 +1504,55 @@ UnixNetVConnection::migrateToCurrentThread(Continuation *cont, EThread *t)
     return netvc;
   }
 }
+
+#if TS_HAS_TESTS
+#include "ts/TestBox.h"
+
+// A READ_READY held back until the end of a batch is delivered once the
+// reader enables the VIO again, and is dropped if the reader replaced the
+// VIO with do_io_read() in the meantime.
+REGRESSION_TEST(UnixNetVConnection_read_signal_batched)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  UnixNetVConnection *vc = new UnixNetVConnection;
+  Continuation cont(new_ProxyMutex());
+  MIOBuffer *buf = new_MIOBuffer();
+
+  box = REGRESSION_TEST_PASSED;
+
+  // enabled, so do_io_read() does not reschedule the VC on a NetHandler
+  vc->read.enabled = 1;
+  vc->do_io_read(&cont, 100, buf);
+  box.check(!read_signal_owed(&vc->read), "a new read is owed nothing");
+
+  // read_from_net() during a batch
+  vc->read.vio.ndone += 10;
+  vc->read.signal_ndone = vc->read.vio.ndone;
+  box.check(read_signal_owed(&vc->read), "a batched read is owed its READ_READY");
+
+  // the reader disabled the VIO before the batch ended, then reenabled it
+  vc->read.enabled = 0;
+  box.check(read_signal_owed(&vc->read), "a disabled read keeps its READ_READY");
+  vc->read.enabled = 1;
+  vc->read.vio.ndone += 5;
+  box.check(read_signal_owed(&vc->read), "the READ_READY is delivered after reenable");
+
+  // the reader replaced the VIO before the batch ended
+  vc->do_io_read(&cont, 100, buf);
+  box.check(vc->read.signal_ndone == 0, "do_io_read() clears signal_ndone");
+  box.check(!read_signal_owed(&vc->read), "the new VIO is owed nothing");
+  vc->read.vio.ndone += 20;
+  box.check(!read_signal_owed(&vc->read), "data read by the new VIO is signalled by its own read");
+
+  // a batched read followed by a VIO that is no longer a read
+  vc->read.signal_ndone = vc->read.vio.ndone;
+  vc->read.vio.op = VIO::NONE;
+  box.check(!read_signal_owed(&vc->read), "a closed VIO is owed nothing");
+
+  vc->read.vio.buffer.clear();
+  vc->read.vio.mutex.clear();
+  free_MIOBuffer(buf);
+  delete vc;
+}
+
+#endif // TS_HAS_TESTS
@@ -147,6 +147,92 @@ REGRESSION_TEST(SSLAddressLookup)(RegressionTest *t, int /* atype ATS_UNUSED */,
   box.check(lookup.find(endpoint.ip4p)->ctx == context.ip4p, "IPv4 longest match lookup w/ port");
 }
 
+REGRESSION_TEST(SSLWildcardSuffixLookup)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  SSLCertLookup lookup;
+
+  SSL_CTX *wild = SSL_CTX_new(SSLv23_server_method());
+  SSL_CTX *apex = SSL_CTX_new(SSLv23_server_method());
+  SSL_CTX *host = SSL_CTX_new(SSLv23_server_method());
+  SSLCertContext wild_cc(wild);
+  SSLCertContext apex_cc(apex);
+  SSLCertContext host_cc(host);
+
+  box = REGRESSION_TEST_PASSED;
+
+  // Wildcards and exact names share one table, "*.foo.com" is kept under ".foo.com".
+  box.check(lookup.insert("*.foo.com", wild_cc) >= 0, "insert wildcard context");
+  box.check(lookup.insert("foo.com", apex_cc) >= 0, "insert the wildcard domain itself");
+  box.check(lookup.insert("www.foo.com", host_cc) >= 0, "insert host context under the wildcard");
+
+  box.check(lookup.find("foo.com")->ctx == apex, "foo.com is not matched by *.foo.com");
+  box.check(lookup.find("www.foo.com")->ctx == host, "exact match wins over the wildcard");
+  box.check(lookup.find("a.foo.com")->ctx == wild, "wildcard lookup for a.foo.com");
+  box.check(lookup.find("a.b.foo.com")->ctx == wild, "wildcard lookup for a.b.foo.com");
+  box.check(lookup.find("afoo.com") == NULL, "afoo.com is not under foo.com");
+  box.check(lookup.find(".foo.com") != NULL && lookup.find(".foo.com")->ctx == wild, "the suffix key itself");
+  box.check(lookup.find("com") == NULL, "lookup for com");
+}
+
+REGRESSION_TEST(SSLLazyContexts)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  SSLCertLookup lookup;
+  const SSLCertLookup &shared = lookup; // handshakes only see the lookup through a const reference
+  SSLLazyContext *lazy[3];
+  Vec<SSL_CTX *> ctxs;
+
+  box = REGRESSION_TEST_PASSED;
+
+  for (unsigned i = 0; i < countof(lazy); ++i) {
+    lazy[i] = new SSLLazyContext(new ssl_user_config);
+    lookup.lazy_contexts.push_back(lazy[i]);
+  }
+  lookup.lazy_max = 2;
+
+  // Every name of a line refers to the same lazy context.
+  box.check(lookup.insert("www.a.com", SSLCertContext(lazy[0], SSLCertContext::OPT_NONE)) >= 0, "insert lazy host");
+  box.check(lookup.insert("*.a.com", SSLCertContext(lazy[0], SSLCertContext::OPT_NONE)) >= 0, "insert lazy wildcard");
+  box.check(lookup.insert("www.b.com", SSLCertContext(lazy[1], SSLCertContext::OPT_NONE)) >= 0, "insert lazy host");
+  box.check(lookup.insert("www.c.com", SSLCertContext(lazy[2], SSLCertContext::OPT_NONE)) >= 0, "insert lazy host");
+  box.check(lookup.find("www.a.com")->lazy == lazy[0] && lookup.find("x.a.com")->lazy == lazy[0], "names share the lazy context");
+  box.check(lookup.find("www.a.com")->ctx == NULL, "lazy context is not built at load time");
+
+  // A later line for a name that is already indexed is dropped, the first one is kept.
+  box.check(lookup.insert("www.a.com", SSLCertContext(lazy[1], SSLCertContext::OPT_NONE)) < 0, "insert duplicate lazy host");
+  box.check(lookup.find("www.a.com")->lazy == lazy[0], "duplicate line does not replace the first one");
+
+  box.check(lazy[0]->acquire() == NULL, "nothing to acquire before the context is built");
+
+  // Build all three, as selecting them would. Each was referenced, so the clock gives every one a
+  // second chance and then frees the first.
+  for (unsigned i = 0; i < countof(lazy); ++i) {
+    lazy[i]->referenced = true;
+    lazy[i]->ctx = SSL_CTX_new(SSLv23_server_method());
+    shared.lazyContextBuilt(lazy[i]);
+  }
+  box.check(lazy[0]->ctx == NULL, "the coldest context is freed past lazy_max");
+  box.check(lazy[1]->ctx != NULL && lazy[2]->ctx != NULL, "the newer contexts are kept");
+
+  shared.acquireLazyContexts(ctxs);
+  box.check(ctxs.length() == 2, "acquired %u lazy contexts, expected 2", ctxs.length());
+  for (unsigned i = 0; i < ctxs.length(); ++i) {
+    SSL_CTX_free(ctxs[i]);
+  }
+
+  // Only the second one was selected since the hand passed, so the third goes when the first is rebuilt.
+  lazy[1]->referenced = true;
+  lazy[0]->ctx = SSL_CTX_new(SSLv23_server_method());
+  shared.lazyContextBuilt(lazy[0]);
+  box.check(lazy[2]->ctx == NULL, "the unreferenced context is freed");
+  box.check(lazy[0]->ctx != NULL && lazy[1]->ctx != NULL, "the referenced contexts are kept");
+
+  SSL_CTX *ctx = lazy[1]->acquire();
+  box.check(ctx == lazy[1]->ctx, "acquire returns the built context");
+  SSL_CTX_free(ctx);
+}
+
 static unsigned
 load_hostnames_csv(const char *fname, SSLCertLookup &lookup)
 {
@@ -169,18 +169,69 @@ struct RecRawStat {
   uint32_t version;
 };
 
+// The thread local half of a raw-stat. Threads only ever touch sum and
+// count, so the per-thread block is kept to just those, which packs four
+// stats into every cache line the syncer has to walk.
+struct RecRawStatLocal {
+  int64_t sum;
+  int64_t count;
+};
+
 
 // WARNING!  It's advised that developers do not modify the contents of
 // the RecRawStatBlock.  ^_^
 struct RecRawStatBlock {
-  off_t ethr_stat_offset; // thread local raw-stat storage
-  RecRawStat **global;    // global raw-stat storage (ptr to RecRecord)
-  int num_stats;          // number of stats in this block
-  int max_stats;          // maximum number of stats for this block
+  off_t ethr_stat_offset;  // thread local raw-stat storage
+  RecRawStat **global;     // global raw-stat storage (ptr to RecRecord)
+  int num_stats;           // number of stats in this block
+  int max_stats;           // maximum number of stats for this block
+  RecRawStatLocal *totals; // thread local values summed by the last sync pass
+  uint32_t sync_pass;      // sync pass that computed totals
   ink_mutex mutex;
 };
 
 
+//-------------------------------------------------------------------------
+// Histogram Structures
+//-------------------------------------------------------------------------
+// Log-linear buckets in the style of HdrHistogram. Values below
+// REC_HISTOGRAM_SUB_BUCKETS get a bucket each, every power of two above
+// that is split into REC_HISTOGRAM_SUB_BUCKETS linear buckets, so a
+// reported value is never more than 1/REC_HISTOGRAM_SUB_BUCKETS off.
+// Values at or above 2^REC_HISTOGRAM_MAX_BITS land in the last bucket.
+#define REC_HISTOGRAM_SUB_BITS 3
+#define REC_HISTOGRAM_SUB_BUCKETS (1 << REC_HISTOGRAM_SUB_BITS)
+#define REC_HISTOGRAM_MAX_BITS 40
+#define REC_HISTOGRAM_BUCKETS ((REC_HISTOGRAM_MAX_BITS - REC_HISTOGRAM_SUB_BITS + 1) * REC_HISTOGRAM_SUB_BUCKETS)
+
+struct RecHistogram {
+  int64_t buckets[REC_HISTOGRAM_BUCKETS];
+};
+
+// Records exported for every registered histogram, as "<name>.<suffix>".
+enum RecHistogramExportT {
+  REC_HISTOGRAM_COUNT = 0,
+  REC_HISTOGRAM_P50,
+  REC_HISTOGRAM_P90,
+  REC_HISTOGRAM_P99,
+  REC_HISTOGRAM_P999,
+  REC_HISTOGRAM_MAX,
+  REC_HISTOGRAM_EXPORTS
+};
+
+struct RecRecord;
+struct RecHistogramWindow;
+
+struct RecHistogramBlock {
+  off_t ethr_hist_offset;      // thread local histogram storage
+  int num_histograms;          // number of histograms in this block
+  int max_histograms;          // maximum number of histograms for this block
+  RecRecord **exports;         // max_histograms * REC_HISTOGRAM_EXPORTS records
+  RecHistogramWindow *windows; // max_histograms windows the percentiles are exported over
+  RecHistogramBlock *next;
+};
+
+
 //-------------------------------------------------------------------------
 // RecCore Callback Types
 //-------------------------------------------------------------------------
@@ -240,6 +240,8 @@ public:
   bool m_outbound_transparent_p;
   // True if transparent pass-through is enabled on this port.
   bool m_transparent_passthrough;
+  /// True if the listen socket accepts data in the SYN (TCP Fast Open).
+  bool m_tcp_fastopen;
   /// Local address for inbound connections (listen address).
   IpAddr m_inbound_ip;
   /// Local address for outbound connections (to origin server).
@@ -388,6 +390,7 @@ public:
   static char const *const OPT_PLUGIN;                  ///< Protocol Plugin handle (experimental)
   static char const *const OPT_BLIND_TUNNEL;            ///< Blind tunnel.
   static char const *const OPT_COMPRESSED;              ///< Compressed.
+  static char const *const OPT_TCP_FAST_OPEN;           ///< TCP Fast Open.
   static char const *const OPT_HOST_RES_PREFIX;         ///< Set DNS family preference.
   static char const *const OPT_PROTO_PREFIX;            ///< Transport layer protocols.
 
@@ -52,6 +52,18 @@ int _RecRegisterRawStat(RecRawStatBlock *rsb, RecT rec_type, const char *name, R
 #define RecRegisterRawStat(rsb, rec_type, name, data_type, persist_type, id, sync_cb) \
   _RecRegisterRawStat((rsb), (rec_type), (name), (data_type), REC_PERSISTENCE_TYPE(persist_type), (id), (sync_cb))
 
+//-------------------------------------------------------------------------
+// Histogram Registration
+//-------------------------------------------------------------------------
+RecHistogramBlock *RecAllocateHistogramBlock(int num_histograms);
+
+int RecRegisterHistogram(RecHistogramBlock *hb, RecT rec_type, const char *name, int id);
+
+// Export a histogram that is not thread local, e.g. one created after the
+// event threads are running. The histogram must stay allocated for the
+// life of the process, and is updated with RecIncrSharedHistogram.
+int RecRegisterSharedHistogram(RecT rec_type, const char *name, RecHistogram *h);
+
 // RecRawStatRange* RecAllocateRawStatRange (int num_buckets);
 
 // int RecRegisterRawStatRange (RecRawStatRange *rsr,
@@ -112,25 +124,39 @@ int64_t *RecGetGlobalRawStatSumPtr(RecRawStatBlock *rsb, int id);
 int64_t *RecGetGlobalRawStatCountPtr(RecRawStatBlock *rsb, int id);
 
 
+//-------------------------------------------------------------------------
+// Histogram Setting/Getting
+//-------------------------------------------------------------------------
+// RecIncrHistogram is as cheap as RecIncrRawStat, it only touches the
+// calling thread's buckets. RecGetHistogram sums every thread's buckets
+// on the spot, the exported records are refreshed by the raw-stat syncer.
+inline int RecIncrHistogram(RecHistogramBlock *hb, EThread *ethread, int id, int64_t value);
+inline int RecIncrSharedHistogram(RecHistogram *h, int64_t value);
+int RecGetHistogram(RecHistogramBlock *hb, int id, RecHistogram *total);
+
+int64_t RecHistogramCount(const RecHistogram *h);
+int64_t RecHistogramPercentile(const RecHistogram *h, double percentile);
+
+
 //-------------------------------------------------------------------------
 // RecIncrRawStatXXX
 //-------------------------------------------------------------------------
 // inlined functions that are used very frequently.
 // FIXME: move it to Inline.cc
-inline RecRawStat *
+inline RecRawStatLocal *
 raw_stat_get_tlp(RecRawStatBlock *rsb, int id, EThread *ethread)
 {
   ink_assert((id >= 0) && (id < rsb->max_stats));
   if (ethread == NULL) {
     ethread = this_ethread();
   }
-  return (((RecRawStat *)((char *)(ethread) + rsb->ethr_stat_offset)) + id);
+  return (((RecRawStatLocal *)((char *)(ethread) + rsb->ethr_stat_offset)) + id);
 }
 
 inline int
 RecIncrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum += incr;
   tlp->count += 1;
   return REC_ERR_OKAY;
@@ -139,7 +165,7 @@ RecIncrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 inline int
 RecDecrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t decr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum -= decr;
   tlp->count += 1;
   return REC_ERR_OKAY;
@@ -148,7 +174,7 @@ RecDecrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t decr)
 inline int
 RecIncrRawStatSum(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum += incr;
   return REC_ERR_OKAY;
 }
@@ -156,9 +182,46 @@ RecIncrRawStatSum(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 inline int
 RecIncrRawStatCount(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatLocal *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->count += incr;
   return REC_ERR_OKAY;
 }
 
+
+//-------------------------------------------------------------------------
+// RecIncrHistogram
+//-------------------------------------------------------------------------
+inline int
+rec_histogram_bucket(int64_t value)
+{
+  if (value < REC_HISTOGRAM_SUB_BUCKETS) {
+    return value < 0 ? 0 : (int)value;
+  }
+  if (value >= (int64_t)1 << REC_HISTOGRAM_MAX_BITS) {
+    return REC_HISTOGRAM_BUCKETS - 1;
+  }
+
+  int shift = 63 - __builtin_clzll((uint64_t)value) - REC_HISTOGRAM_SUB_BITS;
+  return (shift + 1) * REC_HISTOGRAM_SUB_BUCKETS + (int)(value >> shift) - REC_HISTOGRAM_SUB_BUCKETS;
+}
+
+inline int
+RecIncrHistogram(RecHistogramBlock *hb, EThread *ethread, int id, int64_t value)
+{
+  ink_assert((id >= 0) && (id < hb->max_histograms));
+  if (ethread == NULL) {
+    ethread = this_ethread();
+  }
+  RecHistogram *h = ((RecHistogram *)((char *)(ethread) + hb->ethr_hist_offset)) + id;
+  h->buckets[rec_histogram_bucket(value)] += 1;
+  return REC_ERR_OKAY;
+}
+
+inline int
+RecIncrSharedHistogram(RecHistogram *h, int64_t value)
+{
+  ink_atomic_increment(&(h->buckets[rec_histogram_bucket(value)]), (int64_t)1);
+  return REC_ERR_OKAY;
+}
+
 #endif /* !_I_REC_PROCESS_H_ */
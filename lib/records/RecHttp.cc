@@ -123,6 +123,7 @@ char const *const HttpProxyPort::OPT_SSL = "ssl";
 char const *const HttpProxyPort::OPT_PLUGIN = "plugin";
 char const *const HttpProxyPort::OPT_BLIND_TUNNEL = "blind";
 char const *const HttpProxyPort::OPT_COMPRESSED = "compressed";
+char const *const HttpProxyPort::OPT_TCP_FAST_OPEN = "tfo";
 
 // File local constants.
 namespace
@@ -148,7 +149,7 @@ HttpProxyPort::Group &HttpProxyPort::m_global = GLOBAL_DATA;
 
 HttpProxyPort::HttpProxyPort()
   : m_fd(ts::NO_FD), m_type(TRANSPORT_DEFAULT), m_port(0), m_family(AF_INET), m_inbound_transparent_p(false),
-    m_outbound_transparent_p(false), m_transparent_passthrough(false)
+    m_outbound_transparent_p(false), m_transparent_passthrough(false), m_tcp_fastopen(false)
 {
   memcpy(m_host_res_preference, host_res_default_preference_order, sizeof(m_host_res_preference));
 }
@@ -350,6 +351,8 @@ HttpProxyPort::processOptions(char const *opts)
 #else
       Warning("Transparent pass-through requested [%s] in port descriptor '%s' but TPROXY was not configured.", item, opts);
 #endif
+    } else if (0 == strcasecmp(OPT_TCP_FAST_OPEN, item)) {
+      m_tcp_fastopen = true;
     } else if (0 != (value = this->checkPrefix(item, OPT_HOST_RES_PREFIX, OPT_HOST_RES_PREFIX_LEN))) {
       this->processFamilyPreference(value);
       host_res_set_p = true;
@@ -515,6 +518,9 @@ HttpProxyPort::print(char *out, size_t n)
   if (m_transparent_passthrough)
     zret += snprintf(out + zret, n - zret, ":%s", OPT_TRANSPARENT_PASSTHROUGH);
 
+  if (m_tcp_fastopen)
+    zret += snprintf(out + zret, n - zret, ":%s", OPT_TCP_FAST_OPEN);
+
   /* Don't print the IP resolution preferences if the port is outbound
    * transparent (which means the preference order is forced) or if
    * the order is the same as the default.
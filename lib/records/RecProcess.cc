@@ -43,6 +43,7 @@ static EventNotify g_force_req_notify;
 static int g_rec_raw_stat_sync_interval_ms = REC_RAW_STAT_SYNC_INTERVAL_MS;
 static int g_rec_config_update_interval_ms = REC_CONFIG_UPDATE_INTERVAL_MS;
 static int g_rec_remote_sync_interval_ms = REC_REMOTE_SYNC_INTERVAL_MS;
+static RecInt g_histogram_window = 0; // proxy.config.stats.histogram_window, 0 for lifetime percentiles
 static Event *raw_stat_sync_cont_event;
 static Event *config_update_cont_event;
 static Event *sync_cont_event;
@@ -126,7 +127,7 @@ static int
 raw_stat_get_total(RecRawStatBlock *rsb, int id, RecRawStat *total)
 {
   int i;
-  RecRawStat *tlp;
+  RecRawStatLocal *tlp;
 
   total->sum = 0;
   total->count = 0;
@@ -137,13 +138,13 @@ raw_stat_get_total(RecRawStatBlock *rsb, int id, RecRawStat *total)
 
   // get thread local values
   for (i = 0; i < eventProcessor.n_ethreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
     total->sum += tlp->sum;
     total->count += tlp->count;
   }
 
   for (i = 0; i < eventProcessor.n_dthreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
     total->sum += tlp->sum;
     total->count += tlp->count;
   }
@@ -157,56 +158,75 @@ raw_stat_get_total(RecRawStatBlock *rsb, int id, RecRawStat *total)
 
 
 //-------------------------------------------------------------------------
-// raw_stat_sync_to_global
+// raw_stat_sum_threads
 //-------------------------------------------------------------------------
-static int
-raw_stat_sync_to_global(RecRawStatBlock *rsb, int id)
+// Sum every thread's block into rsb->totals. Each thread block is walked
+// front to back once, rather than striding across all threads for every
+// stat, so a sync pass costs one sequential read of the block per thread.
+static uint32_t g_raw_stat_sync_pass = 1;
+
+static void
+raw_stat_sum_threads(RecRawStatBlock *rsb)
 {
-  int i;
-  RecRawStat *tlp;
-  RecRawStat total;
+  RecRawStatLocal *totals = rsb->totals;
+  RecRawStatLocal *tlp;
+  int n = rsb->num_stats;
 
-  total.sum = 0;
-  total.count = 0;
+  memset(totals, 0, n * sizeof(RecRawStatLocal));
 
-  // sum the thread local values
-  for (i = 0; i < eventProcessor.n_ethreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
-    total.sum += tlp->sum;
-    total.count += tlp->count;
+  for (int i = 0; i < eventProcessor.n_ethreads; i++) {
+    tlp = (RecRawStatLocal *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset);
+    for (int id = 0; id < n; id++) {
+      totals[id].sum += tlp[id].sum;
+      totals[id].count += tlp[id].count;
+    }
   }
 
-  for (i = 0; i < eventProcessor.n_dthreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
-    total.sum += tlp->sum;
-    total.count += tlp->count;
+  for (int i = 0; i < eventProcessor.n_dthreads; i++) {
+    tlp = (RecRawStatLocal *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset);
+    for (int id = 0; id < n; id++) {
+      totals[id].sum += tlp[id].sum;
+      totals[id].count += tlp[id].count;
+    }
+  }
+}
+
+
+//-------------------------------------------------------------------------
+// raw_stat_sync_to_global
+//-------------------------------------------------------------------------
+static int
+raw_stat_sync_to_global(RecRawStatBlock *rsb, int id)
+{
+  RecRawStatLocal total;
+
+  // The first stat of the block synced in a pass sums the whole block,
+  // the rest just pick up their total.
+  ink_mutex_acquire(&(rsb->mutex));
+  if (rsb->sync_pass != g_raw_stat_sync_pass) {
+    raw_stat_sum_threads(rsb);
+    rsb->sync_pass = g_raw_stat_sync_pass;
   }
+  total = rsb->totals[id];
 
   if (total.sum < 0) { // Assure that we stay positive
     total.sum = 0;
   }
 
-  // lock so the setting of the globals and last values are atomic
-  ink_mutex_acquire(&(rsb->mutex));
-
-  // get the delta from the last sync
-  RecRawStat delta;
-  delta.sum = total.sum - rsb->global[id]->last_sum;
-  delta.count = total.count - rsb->global[id]->last_count;
+  // Swapping in the new totals hands back the previous ones, so the
+  // globals are moved by exactly the delta since the last sync. The block
+  // mutex keeps raw_stat_clear() from resetting them in between.
+  int64_t last_sum = ink_atomic_swap(&(rsb->global[id]->last_sum), total.sum);
+  int64_t last_count = ink_atomic_swap(&(rsb->global[id]->last_count), total.count);
 
   // This is too verbose now, so leaving it out / leif
   // Debug("stats", "raw_stat_sync_to_global(): rsb pointer:%p id:%d delta:%" PRId64 " total:%" PRId64 " last:%" PRId64 " global:%"
   // PRId64 "\n",
-  // rsb, id, delta.sum, total.sum, rsb->global[id]->last_sum, rsb->global[id]->sum);
+  // rsb, id, total.sum - last_sum, total.sum, last_sum, rsb->global[id]->sum);
 
   // increment the global values by the delta
-  ink_atomic_increment(&(rsb->global[id]->sum), delta.sum);
-  ink_atomic_increment(&(rsb->global[id]->count), delta.count);
-
-  // set the new totals as the last values seen
-  ink_atomic_swap(&(rsb->global[id]->last_sum), total.sum);
-  ink_atomic_swap(&(rsb->global[id]->last_count), total.count);
-
+  ink_atomic_increment(&(rsb->global[id]->sum), total.sum - last_sum);
+  ink_atomic_increment(&(rsb->global[id]->count), total.count - last_count);
   ink_mutex_release(&(rsb->mutex));
 
   return REC_ERR_OKAY;
@@ -231,19 +251,22 @@ raw_stat_clear(RecRawStatBlock *rsb, int id)
   ink_mutex_release(&(rsb->mutex));
 
   // reset the local stats
-  RecRawStat *tlp;
+  RecRawStatLocal *tlp;
   for (int i = 0; i < eventProcessor.n_ethreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
     ink_atomic_swap(&(tlp->sum), (int64_t)0);
     ink_atomic_swap(&(tlp->count), (int64_t)0);
   }
 
   for (int i = 0; i < eventProcessor.n_dthreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
     ink_atomic_swap(&(tlp->sum), (int64_t)0);
     ink_atomic_swap(&(tlp->count), (int64_t)0);
   }
 
+  // the totals summed earlier in this sync pass are stale now
+  rsb->sync_pass = 0;
+
   return REC_ERR_OKAY;
 }
 
@@ -264,17 +287,20 @@ raw_stat_clear_sum(RecRawStatBlock *rsb, int id)
   ink_mutex_release(&(rsb->mutex));
 
   // reset the local stats
-  RecRawStat *tlp;
+  RecRawStatLocal *tlp;
   for (int i = 0; i < eventProcessor.n_ethreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
     ink_atomic_swap(&(tlp->sum), (int64_t)0);
   }
 
   for (int i = 0; i < eventProcessor.n_dthreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
     ink_atomic_swap(&(tlp->sum), (int64_t)0);
   }
 
+  // the totals summed earlier in this sync pass are stale now
+  rsb->sync_pass = 0;
+
   return REC_ERR_OKAY;
 }
 
@@ -295,17 +321,20 @@ raw_stat_clear_count(RecRawStatBlock *rsb, int id)
   ink_mutex_release(&(rsb->mutex));
 
   // reset the local stats
-  RecRawStat *tlp;
+  RecRawStatLocal *tlp;
   for (int i = 0; i < eventProcessor.n_ethreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_ethreads[i]) + rsb->ethr_stat_offset)) + id;
     ink_atomic_swap(&(tlp->count), (int64_t)0);
   }
 
   for (int i = 0; i < eventProcessor.n_dthreads; i++) {
-    tlp = ((RecRawStat *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
+    tlp = ((RecRawStatLocal *)((char *)(eventProcessor.all_dthreads[i]) + rsb->ethr_stat_offset)) + id;
     ink_atomic_swap(&(tlp->count), (int64_t)0);
   }
 
+  // the totals summed earlier in this sync pass are stale now
+  rsb->sync_pass = 0;
+
   return REC_ERR_OKAY;
 }
 
@@ -490,6 +519,7 @@ RecProcessStart(void)
   }
 
   Debug("statsproc", "Starting sync continuations:");
+  RecGetRecordInt("proxy.config.stats.histogram_window", &g_histogram_window);
   raw_stat_sync_cont *rssc = new raw_stat_sync_cont(new_ProxyMutex());
   Debug("statsproc", "raw-stat syncer");
   raw_stat_sync_cont_event = eventProcessor.schedule_every(rssc, HRTIME_MSECONDS(g_rec_raw_stat_sync_interval_ms), ET_TASK);
@@ -525,7 +555,7 @@ RecAllocateRawStatBlock(int num_stats)
   RecRawStatBlock *rsb;
 
   // allocate thread-local raw-stat memory
-  if ((ethr_stat_offset = eventProcessor.allocate(num_stats * sizeof(RecRawStat))) == -1) {
+  if ((ethr_stat_offset = eventProcessor.allocate(num_stats * sizeof(RecRawStatLocal))) == -1) {
     return NULL;
   }
   // create the raw-stat-block structure
@@ -536,6 +566,8 @@ RecAllocateRawStatBlock(int num_stats)
   memset(rsb->global, 0, num_stats * sizeof(RecRawStat *));
   rsb->num_stats = 0;
   rsb->max_stats = num_stats;
+  rsb->totals = (RecRawStatLocal *)ats_malloc(num_stats * sizeof(RecRawStatLocal));
+  rsb->sync_pass = 0;
   ink_mutex_init(&(rsb->mutex), "net stat mutex");
   return rsb;
 }
@@ -576,6 +608,13 @@ _RecRegisterRawStat(RecRawStatBlock *rsb, RecT rec_type, const char *name, RecDa
   rsb->global[id]->last_sum = 0;
   rsb->global[id]->last_count = 0;
 
+  ink_mutex_acquire(&(rsb->mutex));
+  if (id >= rsb->num_stats) {
+    rsb->num_stats = id + 1;
+    rsb->sync_pass = 0;
+  }
+  ink_mutex_release(&(rsb->mutex));
+
   // setup the periodic sync callback
   RecRegisterRawStatSyncCb(name, sync_cb, rsb, id);
 
@@ -584,6 +623,204 @@ Ldone:
 }
 
 
+//-------------------------------------------------------------------------
+// RecAllocateHistogramBlock
+//-------------------------------------------------------------------------
+static RecHistogramBlock *g_histogram_blocks = NULL;
+static ink_mutex g_histogram_blocks_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// The percentiles of a histogram are computed from the counts added since
+// base, so over the last one to two windows.
+struct RecHistogramWindow {
+  RecHistogram base;  // counts when the previous window started
+  RecHistogram start; // counts when the current window started
+  ink_hrtime start_time;
+};
+
+RecHistogramBlock *
+RecAllocateHistogramBlock(int num_histograms)
+{
+  off_t ethr_hist_offset;
+  RecHistogramBlock *hb;
+
+  // allocate thread-local bucket memory
+  if ((ethr_hist_offset = eventProcessor.allocate(num_histograms * sizeof(RecHistogram))) == -1) {
+    return NULL;
+  }
+  hb = (RecHistogramBlock *)ats_malloc(sizeof(RecHistogramBlock));
+  memset(hb, 0, sizeof(RecHistogramBlock));
+  hb->ethr_hist_offset = ethr_hist_offset;
+  hb->exports = (RecRecord **)ats_malloc(num_histograms * REC_HISTOGRAM_EXPORTS * sizeof(RecRecord *));
+  memset(hb->exports, 0, num_histograms * REC_HISTOGRAM_EXPORTS * sizeof(RecRecord *));
+  hb->windows = (RecHistogramWindow *)ats_calloc(num_histograms, sizeof(RecHistogramWindow));
+  hb->num_histograms = 0;
+  hb->max_histograms = num_histograms;
+
+  ink_mutex_acquire(&g_histogram_blocks_mutex);
+  hb->next = g_histogram_blocks;
+  g_histogram_blocks = hb;
+  ink_mutex_release(&g_histogram_blocks_mutex);
+
+  return hb;
+}
+
+
+//-------------------------------------------------------------------------
+// RecRegisterHistogram
+//-------------------------------------------------------------------------
+static const char *histogram_export_suffix[REC_HISTOGRAM_EXPORTS] = {"count", "p50", "p90", "p99", "p999", "max"};
+static const double histogram_export_percentile[REC_HISTOGRAM_EXPORTS] = {0, 50.0, 90.0, 99.0, 99.9, 100.0};
+
+static int
+histogram_register_exports(RecT rec_type, const char *name, RecRecord **exports)
+{
+  RecData data_default;
+  memset(&data_default, 0, sizeof(RecData));
+
+  for (int i = 0; i < REC_HISTOGRAM_EXPORTS; i++) {
+    char export_name[256];
+    RecRecord *r;
+
+    snprintf(export_name, sizeof(export_name), "%s.%s", name, histogram_export_suffix[i]);
+    if ((r = RecRegisterStat(rec_type, export_name, RECD_INT, data_default, RECP_NON_PERSISTENT)) == NULL) {
+      return REC_ERR_FAIL;
+    }
+    if (i_am_the_record_owner(r->rec_type)) {
+      r->sync_required = r->sync_required | REC_PEER_SYNC_REQUIRED;
+    } else {
+      send_register_message(r);
+    }
+    exports[i] = r;
+  }
+
+  return REC_ERR_OKAY;
+}
+
+int
+RecRegisterHistogram(RecHistogramBlock *hb, RecT rec_type, const char *name, int id)
+{
+  Debug("stats", "RecRegisterHistogram(%s): hb pointer:%p id:%d\n", name, hb, id);
+
+  ink_assert(id < hb->max_histograms);
+
+  if (histogram_register_exports(rec_type, name, hb->exports + id * REC_HISTOGRAM_EXPORTS) != REC_ERR_OKAY) {
+    return REC_ERR_FAIL;
+  }
+
+  if (id >= hb->num_histograms) {
+    hb->num_histograms = id + 1;
+  }
+
+  return REC_ERR_OKAY;
+}
+
+
+//-------------------------------------------------------------------------
+// RecRegisterSharedHistogram
+//-------------------------------------------------------------------------
+struct RecSharedHistogram {
+  RecHistogram *histogram;
+  RecRecord *exports[REC_HISTOGRAM_EXPORTS];
+  RecHistogramWindow window;
+  RecSharedHistogram *next;
+};
+
+static RecSharedHistogram *g_shared_histograms = NULL;
+
+int
+RecRegisterSharedHistogram(RecT rec_type, const char *name, RecHistogram *h)
+{
+  Debug("stats", "RecRegisterSharedHistogram(%s): histogram pointer:%p\n", name, h);
+
+  RecSharedHistogram *sh = (RecSharedHistogram *)ats_malloc(sizeof(RecSharedHistogram));
+  memset(sh, 0, sizeof(RecSharedHistogram));
+  sh->histogram = h;
+
+  if (histogram_register_exports(rec_type, name, sh->exports) != REC_ERR_OKAY) {
+    ats_free(sh);
+    return REC_ERR_FAIL;
+  }
+
+  ink_mutex_acquire(&g_histogram_blocks_mutex);
+  sh->next = g_shared_histograms;
+  g_shared_histograms = sh;
+  ink_mutex_release(&g_histogram_blocks_mutex);
+
+  return REC_ERR_OKAY;
+}
+
+
+//-------------------------------------------------------------------------
+// histogram_sync_exports
+//-------------------------------------------------------------------------
+// The count is exported for the life of the process, the percentiles for
+// the window.
+static void
+histogram_set_exports(RecRecord **exports, const RecHistogram *h, RecHistogramWindow *window, ink_hrtime now)
+{
+  RecHistogram windowed;
+
+  if (g_histogram_window > 0) {
+    if (now - window->start_time >= HRTIME_SECONDS(g_histogram_window)) {
+      memcpy(&window->base, &window->start, sizeof(RecHistogram));
+      memcpy(&window->start, h, sizeof(RecHistogram));
+      window->start_time = now;
+    }
+    for (int b = 0; b < REC_HISTOGRAM_BUCKETS; b++) {
+      windowed.buckets[b] = h->buckets[b] - window->base.buckets[b];
+    }
+  } else {
+    memcpy(&windowed, h, sizeof(RecHistogram));
+  }
+
+  for (int i = 0; i < REC_HISTOGRAM_EXPORTS; i++) {
+    int64_t value =
+      (i == REC_HISTOGRAM_COUNT) ? RecHistogramCount(h) : RecHistogramPercentile(&windowed, histogram_export_percentile[i]);
+
+    rec_mutex_acquire(&(exports[i]->lock));
+    RecDataSetFromInk64(exports[i]->data_type, &(exports[i]->data), value);
+    exports[i]->sync_required = REC_SYNC_REQUIRED;
+    rec_mutex_release(&(exports[i]->lock));
+  }
+}
+
+static void
+histogram_sync_exports()
+{
+  RecHistogram total;
+  ink_hrtime now = Thread::get_hrtime();
+  RecHistogramBlock *blocks;
+  RecSharedHistogram *shared;
+
+  // Nodes are only ever added at the head of the lists, once initialized and
+  // with the mutex held. Taking the heads under the mutex makes the whole lists
+  // safe to walk without it, so registering never waits for the exports.
+  ink_mutex_acquire(&g_histogram_blocks_mutex);
+  blocks = g_histogram_blocks;
+  shared = g_shared_histograms;
+  ink_mutex_release(&g_histogram_blocks_mutex);
+
+  for (RecHistogramBlock *hb = blocks; hb; hb = hb->next) {
+    for (int id = 0; id < hb->num_histograms; id++) {
+      RecRecord **exports = hb->exports + id * REC_HISTOGRAM_EXPORTS;
+
+      if (exports[REC_HISTOGRAM_COUNT] == NULL) {
+        continue;
+      }
+      RecGetHistogram(hb, id, &total);
+      histogram_set_exports(exports, &total, hb->windows + id, now);
+    }
+  }
+
+  // Shared histograms are updated atomically in place, take a copy so all
+  // the exports are computed from the same counts.
+  for (RecSharedHistogram *sh = shared; sh; sh = sh->next) {
+    memcpy(&total, sh->histogram, sizeof(RecHistogram));
+    histogram_set_exports(sh->exports, &total, &sh->window, now);
+  }
+}
+
+
 //-------------------------------------------------------------------------
 // RecRawStatSync...
 //-------------------------------------------------------------------------
@@ -840,6 +1077,86 @@ RecGetGlobalRawStatCountPtr(RecRawStatBlock *rsb, int id)
 }
 
 
+//-------------------------------------------------------------------------
+// RecGetHistogram
+//-------------------------------------------------------------------------
+int
+RecGetHistogram(RecHistogramBlock *hb, int id, RecHistogram *total)
+{
+  RecHistogram *h;
+
+  memset(total, 0, sizeof(RecHistogram));
+
+  for (int i = 0; i < eventProcessor.n_ethreads; i++) {
+    h = ((RecHistogram *)((char *)(eventProcessor.all_ethreads[i]) + hb->ethr_hist_offset)) + id;
+    for (int b = 0; b < REC_HISTOGRAM_BUCKETS; b++) {
+      total->buckets[b] += h->buckets[b];
+    }
+  }
+
+  for (int i = 0; i < eventProcessor.n_dthreads; i++) {
+    h = ((RecHistogram *)((char *)(eventProcessor.all_dthreads[i]) + hb->ethr_hist_offset)) + id;
+    for (int b = 0; b < REC_HISTOGRAM_BUCKETS; b++) {
+      total->buckets[b] += h->buckets[b];
+    }
+  }
+
+  return REC_ERR_OKAY;
+}
+
+
+//-------------------------------------------------------------------------
+// RecHistogramCount / RecHistogramPercentile
+//-------------------------------------------------------------------------
+int64_t
+RecHistogramCount(const RecHistogram *h)
+{
+  int64_t count = 0;
+
+  for (int b = 0; b < REC_HISTOGRAM_BUCKETS; b++) {
+    count += h->buckets[b];
+  }
+  return count;
+}
+
+// Returns the highest value that falls in the bucket holding the requested
+// percentile, or 0 for an empty histogram.
+int64_t
+RecHistogramPercentile(const RecHistogram *h, double percentile)
+{
+  int64_t count = RecHistogramCount(h);
+  int64_t seen = 0;
+  int64_t rank;
+  int b;
+
+  if (count == 0) {
+    return 0;
+  }
+
+  rank = (int64_t)(percentile / 100.0 * (double)count + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  } else if (rank > count) {
+    rank = count;
+  }
+
+  for (b = 0; b < REC_HISTOGRAM_BUCKETS - 1; b++) {
+    seen += h->buckets[b];
+    if (seen >= rank) {
+      break;
+    }
+  }
+
+  if (b < REC_HISTOGRAM_SUB_BUCKETS) {
+    return b;
+  }
+
+  int shift = b / REC_HISTOGRAM_SUB_BUCKETS - 1;
+  int64_t low = (int64_t)(REC_HISTOGRAM_SUB_BUCKETS + b % REC_HISTOGRAM_SUB_BUCKETS) << shift;
+  return low + ((int64_t)1 << shift) - 1;
+}
+
+
 //-------------------------------------------------------------------------
 // RecRegisterRawStatSyncCb
 //-------------------------------------------------------------------------
@@ -880,6 +1197,11 @@ RecExecRawStatSyncCbs()
   RecRecord *r;
   int i, num_records;
 
+  // Every block sums its thread local values afresh on the first sync of this pass.
+  if (++g_raw_stat_sync_pass == 0) {
+    g_raw_stat_sync_pass = 1;
+  }
+
   num_records = g_num_records;
   for (i = 0; i < num_records; i++) {
     r = &(g_records[i]);
@@ -898,6 +1220,8 @@ RecExecRawStatSyncCbs()
     rec_mutex_release(&(r->lock));
   }
 
+  histogram_sync_exports();
+
   return REC_ERR_OKAY;
 }
 
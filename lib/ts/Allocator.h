@@ -99,6 +99,13 @@ public:
     ink_freelist_madvise_init(&this->fl, name, element_size, chunk_size, alignment, advice);
   }
 
+  /** The free list, for its counts of allocated and used blocks. */
+  const InkFreeList *
+  freelist() const
+  {
+    return fl;
+  }
+
 protected:
   InkFreeList *fl;
 };
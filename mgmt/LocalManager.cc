@@ -1052,6 +1052,15 @@ LocalManager::bindProxyPort(HttpProxyPort &port)
     _exit(1);
   }
 
+#ifdef SO_REUSEPORT
+  // Let the net threads of traffic_server open their own sockets on the port.
+  bool found;
+  RecInt listen_per_thread = REC_readInteger("proxy.config.net.listen_per_thread", &found);
+  if (found && listen_per_thread > 0 && setsockopt(port.m_fd, SOL_SOCKET, SO_REUSEPORT, (char *)&one, sizeof(int)) < 0) {
+    mgmt_elog(stderr, 0, "[bindProxyPort] Unable to set socket options: %d : %s\n", port.m_port, strerror(errno));
+  }
+#endif
+
   if (port.m_inbound_transparent_p) {
 #if TS_USE_TPROXY
     Debug("http_tproxy", "Listen port %d inbound transparency enabled.\n", port.m_port);
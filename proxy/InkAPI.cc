@@ -57,6 +57,7 @@
 #include "PluginVC.h"
 #include "FetchSM.h"
 #include "HttpDebugNames.h"
+#include "HttpSurrogateKeys.h"
 #include "I_AIO.h"
 #include "I_Tasks.h"
 
@@ -6718,6 +6719,16 @@ TSCacheRemove(TSCont contp, TSCacheKey key)
   return (TSAction)cacheProcessor.remove(i, &info->cache_key, true, info->frag_type, info->hostname, info->len);
 }
 
+TSReturnCode
+TSCacheSurrogateKeyPurge(const char *keys, int len)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)keys) == TS_SUCCESS);
+
+  if (len < 0)
+    len = strlen(keys);
+  return HttpSurrogateKeys::getInstance()->purge(keys, len) > 0 ? TS_SUCCESS : TS_ERROR;
+}
+
 TSAction
 TSCacheScan(TSCont contp, TSCacheKey key, int KB_per_second)
 {
@@ -7980,6 +7991,10 @@ _conf_to_memberp(TSOverridableConfigKey conf, OverridableHttpConfigParams *overr
     typ = OVERRIDABLE_TYPE_INT;
     ret = &overridableHttpConfig->redirect_use_orig_cache_key;
     break;
+  case TS_CONFIG_HTTP_ORIGIN_MAX_CONNECTIONS_QUEUE_PRIORITY:
+    typ = OVERRIDABLE_TYPE_INT;
+    ret = &overridableHttpConfig->origin_max_connections_queue_priority;
+    break;
   // This helps avoiding compiler warnings, yet detect unhandled enum members.
   case TS_CONFIG_NULL:
   case TS_CONFIG_LAST_ENTRY:
@@ -8613,6 +8628,11 @@ TSHttpTxnConfigFind(const char *name, int length, TSOverridableConfigKey *conf,
     }
     break;
 
+  case 55:
+    if (!strncmp(name, "proxy.config.http.origin_max_connections_queue_priority", length))
+      cnf = TS_CONFIG_HTTP_ORIGIN_MAX_CONNECTIONS_QUEUE_PRIORITY;
+    break;
+
   case 58:
     if (!strncmp(name, "proxy.config.http.connect_attempts_max_retries_dead_server", length))
       cnf = TS_CONFIG_HTTP_CONNECT_ATTEMPTS_MAX_RETRIES_DEAD_SERVER;
@@ -1858,6 +1858,20 @@ tsapi TSAction TSCacheRemove(TSCont contp, TSCacheKey key);
 tsapi TSReturnCode TSCacheReady(int *is_ready);
 tsapi TSAction TSCacheScan(TSCont contp, TSCacheKey key, int KB_per_second);
 
+/**
+    Invalidates every cached HTTP object tagged with one of the
+    surrogate keys in keys, a space or comma separated list. The
+    objects are revalidated with the origin server the next time they
+    are requested.
+
+    @param keys the surrogate keys to purge.
+    @param len length of keys, or -1 if it is null terminated.
+    @return TS_ERROR if no key was purged, surrogate keys are disabled
+      when proxy.config.http.cache.surrogate_key_header is empty.
+
+ */
+tsapi TSReturnCode TSCacheSurrogateKeyPurge(const char *keys, int len);
+
 /* --------------------------------------------------------------------------
    VIOs */
 tsapi void TSVIOReenable(TSVIO viop);
@@ -1674,6 +1674,56 @@ HTTPHdr::url_string_get(Arena *arena, int *length)
   return zret;
 }
 
+// Parse one end of a byte range, -1 if it is left out
+static bool
+parse_range_pos(const char *s, const char *e, int64_t *pos)
+{
+  for (; s < e && ParseRules::is_ws(*s); ++s)
+    ;
+  for (; e > s && ParseRules::is_ws(e[-1]); --e)
+    ;
+  if (s >= e) {
+    *pos = -1;
+    return true;
+  }
+  for (*pos = 0; s < e; ++s) {
+    if (!ParseRules::is_digit(*s))
+      return false;
+    *pos = *pos * 10 + (*s - '0');
+  }
+  return true;
+}
+
+// The bytes asked for by a Range header with a single byte range, of an
+// object of size bytes. False if there is no such range or it is not
+// satisfiable.
+bool
+HTTPHdr::get_single_range(int64_t size, int64_t *start, int64_t *end)
+{
+  MIMEField *field = field_find(MIME_FIELD_RANGE, MIME_LEN_RANGE);
+  const char *value, *dash;
+  int value_len;
+
+  if (!field || field->has_dups() || size <= 0)
+    return false;
+  value = field->value_get(&value_len);
+  if (ptr_len_ncmp(value, value_len, "bytes=", 6) || memchr(value, ',', value_len) ||
+      !(dash = (const char *)memchr(value, '-', value_len)))
+    return false;
+  if (!parse_range_pos(value + 6, dash, start) || !parse_range_pos(dash + 1, value + value_len, end))
+    return false;
+
+  if (*start < 0) { // suffix range
+    if (*end <= 0)
+      return false;
+    *start = *end < size ? size - *end : 0;
+    *end = size - 1;
+  } else if (*end < 0 || *end >= size) {
+    *end = size - 1;
+  }
+  return *start <= *end;
+}
+
 int
 HTTPHdr::url_print(char *buff, int length, int *offset, int *skip)
 {
@@ -2190,3 +2240,112 @@ HTTPInfo::push_frag_offset(FragOffset offset)
 
   m_alt->m_frag_offsets[m_alt->m_frag_offset_count++] = offset;
 }
+
+int
+HTTPInfo::get_frag_index(FragOffset offset)
+{
+  int low = 0, high = get_frag_offset_count();
+  FragOffset *frags = get_frag_table();
+
+  // the number of fragments that end at or before offset
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (frags[mid] <= offset) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+int
+HTTPInfo::get_whole_frag_index(FragOffset offset)
+{
+  int idx = get_frag_index(offset);
+
+  // fragment idx starts at 0 or the offset of the one before it
+  if (offset > (idx ? get_frag_table()[idx - 1] : 0)) {
+    ++idx;
+  }
+  return idx;
+}
+
+/*-------------------------------------------------------------------------
+ * Regression tests
+  -------------------------------------------------------------------------*/
+#if TS_HAS_TESTS
+#include "ts/TestBox.h"
+
+REGRESSION_TEST(HTTPInfo_frag_index)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  HTTPInfo info;
+
+  box = REGRESSION_TEST_PASSED;
+  info.create();
+
+  // no fragment table, the object is one fragment
+  box.check(info.get_frag_index(0) == 0, "offset 0 of a single fragment object is in fragment 0");
+  box.check(info.get_frag_index(5000) == 0, "offset 5000 of a single fragment object is in fragment 0");
+  box.check(info.get_whole_frag_index(0) == 0, "fragment 0 starts at offset 0");
+  box.check(info.get_whole_frag_index(1) == 1, "no fragment starts at or after offset 1");
+
+  // fragments [0, 1000) [1000, 2000) [2000, 3000) [3000, size)
+  for (int i = 1; i <= 3; i++) {
+    info.push_frag_offset(i * 1000);
+  }
+  static const struct {
+    HTTPInfo::FragOffset offset;
+    int index;
+    int whole;
+  } cases[] = {{0, 0, 0},    {1, 0, 1},    {999, 0, 1},  {1000, 1, 1}, {1001, 1, 2},
+               {2999, 2, 3}, {3000, 3, 3}, {3001, 3, 4}, {9999, 3, 4}};
+  for (unsigned i = 0; i < countof(cases); i++) {
+    box.check(info.get_frag_index(cases[i].offset) == cases[i].index, "offset %d is in fragment %d, not %d", (int)cases[i].offset,
+              cases[i].index, info.get_frag_index(cases[i].offset));
+    box.check(info.get_whole_frag_index(cases[i].offset) == cases[i].whole, "first whole fragment at offset %d is %d, not %d",
+              (int)cases[i].offset, cases[i].whole, info.get_whole_frag_index(cases[i].offset));
+  }
+
+  box.check(!info.is_partial(), "a new alternate is not partial");
+  info.set_partial(true);
+  box.check(info.is_partial(), "set_partial(true) marks the alternate partial");
+  info.set_partial(false);
+  box.check(!info.is_partial(), "set_partial(false) clears the mark");
+
+  info.destroy();
+}
+
+REGRESSION_TEST(HTTPHdr_single_range)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  HTTPHdr request;
+  int64_t start, end;
+
+  box = REGRESSION_TEST_PASSED;
+  request.create(HTTP_TYPE_REQUEST);
+
+  box.check(!request.get_single_range(1000, &start, &end), "no Range header");
+
+  // of an object of 1000 bytes
+  static const struct {
+    const char *range;
+    bool valid;
+    int64_t start, end;
+  } cases[] = {{"bytes=0-99", true, 0, 99},       {"bytes=100-", true, 100, 999},   {"bytes=-100", true, 900, 999},
+               {"bytes=-2000", true, 0, 999},     {"bytes=900-2000", true, 900, 999}, {"bytes= 5 - 6 ", true, 5, 6},
+               {"bytes=1000-", false, 0, 0},      {"bytes=6-5", false, 0, 0},         {"bytes=-0", false, 0, 0},
+               {"bytes=0-1,5-6", false, 0, 0},    {"bytes=x-1", false, 0, 0},         {"items=0-1", false, 0, 0}};
+  for (unsigned i = 0; i < countof(cases); i++) {
+    request.value_set(MIME_FIELD_RANGE, MIME_LEN_RANGE, cases[i].range, strlen(cases[i].range));
+    start = end = 0;
+    bool valid = request.get_single_range(1000, &start, &end);
+    box.check(valid == cases[i].valid && (!valid || (start == cases[i].start && end == cases[i].end)),
+              "Range: %s is %s %" PRId64 "-%" PRId64, cases[i].range, valid ? "valid" : "invalid", start, end);
+  }
+
+  request.destroy();
+}
+
+#endif // TS_HAS_TESTS
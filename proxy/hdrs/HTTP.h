@@ -644,6 +644,7 @@ public:
   bool is_pragma_no_cache_set();
   bool is_keep_alive_set() const;
   HTTPKeepAlive keep_alive_get() const;
+  bool get_single_range(int64_t size, int64_t *start, int64_t *end);
 
 
 protected:
@@ -1322,6 +1323,10 @@ enum {
   CACHE_ALT_MAGIC_DEAD = 0xdeadeed,
 };
 
+/// Value of HTTPCacheAlt::m_rid marking an alternate only some of whose
+/// fragments are stored in the cache.
+#define CACHE_ALT_PARTIAL 0x50415254
+
 // struct HTTPCacheAlt
 struct HTTPCacheAlt {
   HTTPCacheAlt();
@@ -1340,6 +1345,7 @@ struct HTTPCacheAlt {
   int32_t m_unmarshal_len;
 
   int32_t m_id;
+  /// Not otherwise used, CACHE_ALT_PARTIAL for a partially stored alternate.
   int32_t m_rid;
 
   int32_t m_object_key[4];
@@ -1439,6 +1445,19 @@ public:
     m_alt->m_rid = id;
   }
 
+  /// Is only part of the object stored? The object size and fragment table
+  /// are complete, but any fragment may be missing from the cache.
+  bool
+  is_partial() const
+  {
+    return m_alt->m_rid == CACHE_ALT_PARTIAL;
+  }
+  void
+  set_partial(bool partial)
+  {
+    m_alt->m_rid = partial ? CACHE_ALT_PARTIAL : -1;
+  }
+
   INK_MD5 object_key_get();
   void object_key_get(INK_MD5 *);
   bool compare_object_key(const INK_MD5 *);
@@ -1516,6 +1535,11 @@ public:
   int get_frag_offset_count();
   /// Add an @a offset to the end of the fragment offset table.
   void push_frag_offset(FragOffset offset);
+  /// Get the index of the fragment containing the byte at @a offset.
+  int get_frag_index(FragOffset offset);
+  /// Get the index of the first fragment starting at or after @a offset,
+  /// one past the last fragment if there is none.
+  int get_whole_frag_index(FragOffset offset);
 
   // Sanity check functions
   static bool check_marshalled(char *buf, int len);
@@ -140,6 +140,13 @@ public:
     return cache_read_vc ? (cache_read_vc->get_volume_number()) : -1;
   }
 
+  // key of the last open read or write
+  const HttpCacheKey *
+  get_cache_key() const
+  {
+    return &cache_key;
+  }
+
   inline void
   abort_read()
   {
@@ -61,9 +61,9 @@ ClassAllocator<HttpClientSession> httpClientSessionAllocator("httpClientSessionA
 
 HttpClientSession::HttpClientSession()
   : con_id(0), client_vc(NULL), magic(HTTP_CS_MAGIC_DEAD), transact_count(0), tcp_init_cwnd_set(false), half_close(false),
-    conn_decrease(false), upgrade_to_h2c(false), bound_ss(NULL), read_buffer(NULL), current_reader(NULL), read_state(HCS_INIT),
-    ka_vio(NULL), slave_ka_vio(NULL), outbound_port(0), f_outbound_transparent(false), host_res_style(HOST_RES_IPV4),
-    acl_record(NULL), m_active(false)
+    conn_decrease(false), upgrade_to_h2c(false), parked(false), parked_bytes(0), bound_ss(NULL), read_buffer(NULL),
+    current_reader(NULL), read_state(HCS_INIT), ka_vio(NULL), slave_ka_vio(NULL), outbound_port(0), f_outbound_transparent(false),
+    host_res_style(HOST_RES_IPV4), acl_record(NULL), m_active(false)
 {
 }
 
@@ -76,6 +76,7 @@ HttpClientSession::destroy()
   ink_release_assert(bound_ss == NULL);
   ink_assert(read_buffer);
 
+  unpark();
   magic = HTTP_CS_MAGIC_DEAD;
   if (read_buffer) {
     free_MIOBuffer(read_buffer);
@@ -416,6 +417,10 @@ HttpClientSession::state_keep_alive(int event, void *data)
 
   STATE_ENTER(&HttpClientSession::state_keep_alive, event, data);
 
+  // Whatever happens next the session leaves keep-alive, the net
+  // processor gave the buffer a block if there was anything to read
+  unpark();
+
   switch (event) {
   case VC_EVENT_READ_READY:
     // New transaction, need to spawn of new sm to process
@@ -502,6 +507,7 @@ HttpClientSession::release(IOBufferReader *r)
   ink_assert(read_state == HCS_ACTIVE_READER);
   ink_assert(current_reader != NULL);
   MgmtInt ka_in = current_reader->t_state.txn_conf->keep_alive_no_activity_timeout_in;
+  bool park_buffers = current_reader->t_state.http_config_param->keep_alive_park_buffers;
 
   DebugHttpSsn("[%" PRId64 "] session released by sm [%" PRId64 "]", con_id, current_reader->sm_id);
   current_reader = NULL;
@@ -535,6 +541,9 @@ HttpClientSession::release(IOBufferReader *r)
     DebugHttpSsn("[%" PRId64 "] initiating io for next header", con_id);
     read_state = HCS_KEEP_ALIVE;
     SET_HANDLER(&HttpClientSession::state_keep_alive);
+    if (park_buffers) {
+      park();
+    }
     ka_vio = this->do_io_read(this, INT64_MAX, read_buffer);
     ink_assert(slave_ka_vio != ka_vio);
     client_vc->set_inactivity_timeout(HRTIME_SECONDS(ka_in));
@@ -543,6 +552,36 @@ HttpClientSession::release(IOBufferReader *r)
   }
 }
 
+// Free the blocks of the empty read buffer while the session waits for the
+// next request, the net processor allocates one again once the client
+// connection is readable.
+void
+HttpClientSession::park()
+{
+  ink_assert(!parked && sm_reader->read_avail() == 0);
+
+  parked_bytes = 0;
+  for (IOBufferBlock *b = sm_reader->get_current_block(); b; b = b->next) {
+    parked_bytes += b->block_size();
+  }
+  read_buffer->release_blocks();
+  parked = true;
+
+  DebugHttpSsn("[%" PRId64 "] parked, released %" PRId64 " bytes", con_id, parked_bytes);
+  HTTP_INCREMENT_DYN_STAT(http_current_parked_client_connections_stat);
+  HTTP_SUM_DYN_STAT(http_parked_client_buffer_bytes_stat, parked_bytes);
+}
+
+void
+HttpClientSession::unpark()
+{
+  if (parked) {
+    parked = false;
+    HTTP_DECREMENT_DYN_STAT(http_current_parked_client_connections_stat);
+    HTTP_SUM_DYN_STAT(http_parked_client_buffer_bytes_stat, -parked_bytes);
+  }
+}
+
 HttpServerSession *
 HttpClientSession::get_bound_ss()
 {
@@ -135,6 +135,8 @@ private:
   int state_slave_keep_alive(int event, void *data);
   int state_wait_for_close(int event, void *data);
   void set_tcp_init_cwnd();
+  void park();
+  void unpark();
 
   enum C_Read_State {
     HCS_INIT,
@@ -152,6 +154,8 @@ private:
   bool half_close;
   bool conn_decrease;
   bool upgrade_to_h2c; // Switching to HTTP/2 with upgrade mechanism
+  bool parked;         // read_buffer blocks released while waiting for the next request
+  int64_t parked_bytes;
 
   HttpServerSession *bound_ss;
 
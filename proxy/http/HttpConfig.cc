@@ -51,6 +51,7 @@
 
 
 RecRawStatBlock *http_rsb;
+RecHistogramBlock *http_hist;
 #define HTTP_CLEAR_DYN_STAT(x)          \
   do {                                  \
     RecSetRawStatSum(http_rsb, x, 0);   \
@@ -201,6 +202,12 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.websocket.current_active_client_connections", RECD_INT,
                      RECP_NON_PERSISTENT, (int)http_websocket_current_active_client_connections_stat, RecRawStatSyncSum);
   HTTP_CLEAR_DYN_STAT(http_websocket_current_active_client_connections_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.current_parked_client_connections", RECD_INT,
+                     RECP_NON_PERSISTENT, (int)http_current_parked_client_connections_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_current_parked_client_connections_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.parked_client_buffer_bytes", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)http_parked_client_buffer_bytes_stat, RecRawStatSyncSum);
+  HTTP_CLEAR_DYN_STAT(http_parked_client_buffer_bytes_stat);
   // Current Transaction Stats
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.current_client_transactions", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_current_client_transactions_stat, RecRawStatSyncSum);
@@ -241,6 +248,12 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.current_cache_connections", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_current_cache_connections_stat, RecRawStatSyncSum);
   HTTP_CLEAR_DYN_STAT(http_current_cache_connections_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_queued", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_queued_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_queue_timeouts", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_queue_timeouts_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_queue_full", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_queue_full_stat, RecRawStatSyncCount);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.avg_transactions_per_client_connection", RECD_FLOAT,
                      RECP_PERSISTENT, (int)http_transactions_per_client_con, RecRawStatSyncAvg);
 
@@ -602,6 +615,9 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_read_errors", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_cache_read_errors, RecRawStatSyncSum);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_surrogate_key_evictions", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_surrogate_key_evictions_stat, RecRawStatSyncSum);
+
   ////////////////////////////////////////////////////////////////////////////////
   // status code counts
   ////////////////////////////////////////////////////////////////////////////////
@@ -858,6 +874,10 @@ register_stat_callbacks()
                      (int)http_sm_start_time_stat, RecRawStatSyncSum);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.milestone.sm_finish", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_sm_finish_time_stat, RecRawStatSyncSum);
+
+  // latency histograms
+  RecRegisterHistogram(http_hist, RECT_PROCESS, "proxy.process.http.histogram.ttfb", (int)http_ttfb_hist);
+  RecRegisterHistogram(http_hist, RECT_PROCESS, "proxy.process.http.histogram.total_time", (int)http_total_time_hist);
 }
 
 
@@ -870,6 +890,7 @@ void
 HttpConfig::startup()
 {
   http_rsb = RecAllocateRawStatBlock((int)http_stat_count);
+  http_hist = RecAllocateHistogramBlock((int)http_hist_count);
   register_stat_callbacks();
 
   HttpConfigParams &c = m_master;
@@ -892,6 +913,11 @@ HttpConfig::startup()
   HttpEstablishStaticConfigLongLong(c.oride.server_tcp_init_cwnd, "proxy.config.http.server_tcp_init_cwnd");
   HttpEstablishStaticConfigLongLong(c.oride.origin_max_connections, "proxy.config.http.origin_max_connections");
   HttpEstablishStaticConfigLongLong(c.origin_min_keep_alive_connections, "proxy.config.http.origin_min_keep_alive_connections");
+  HttpEstablishStaticConfigLongLong(c.origin_max_connections_queue, "proxy.config.http.origin_max_connections_queue");
+  HttpEstablishStaticConfigLongLong(c.origin_max_connections_queue_timeout,
+                                    "proxy.config.http.origin_max_connections_queue_timeout");
+  HttpEstablishStaticConfigLongLong(c.oride.origin_max_connections_queue_priority,
+                                    "proxy.config.http.origin_max_connections_queue_priority");
   HttpEstablishStaticConfigLongLong(c.attach_server_session_to_client, "proxy.config.http.attach_server_session_to_client");
 
   HttpEstablishStaticConfigByte(c.parent_proxy_routing_enable, "proxy.config.http.parent_proxy_routing_enable");
@@ -1037,6 +1063,7 @@ HttpConfig::startup()
   HttpEstablishStaticConfigByte(c.oride.cache_urls_that_look_dynamic, "proxy.config.http.cache.cache_urls_that_look_dynamic");
   HttpEstablishStaticConfigByte(c.cache_enable_default_vary_headers, "proxy.config.http.cache.enable_default_vary_headers");
   HttpEstablishStaticConfigByte(c.cache_post_method, "proxy.config.http.cache.post_method");
+  HttpEstablishStaticConfigByte(c.cache_range_partial, "proxy.config.http.cache.range.partial");
 
   HttpEstablishStaticConfigByte(c.ignore_accept_mismatch, "proxy.config.http.cache.ignore_accept_mismatch");
   HttpEstablishStaticConfigByte(c.ignore_accept_language_mismatch, "proxy.config.http.cache.ignore_accept_language_mismatch");
@@ -1073,6 +1100,13 @@ HttpConfig::startup()
 
   HttpEstablishStaticConfigByte(c.record_cop_page, "proxy.config.http.record_heartbeat");
 
+  HttpEstablishStaticConfigByte(c.latency_histograms, "proxy.config.http.latency_histograms");
+  HttpEstablishStaticConfigLongLong(c.latency_histograms_max_entries, "proxy.config.http.latency_histograms.max_entries");
+
+  HttpEstablishStaticConfigByte(c.adaptive_buffer_size, "proxy.config.http.adaptive_buffer_size");
+  HttpEstablishStaticConfigLongLong(c.adaptive_buffer_max_size, "proxy.config.http.adaptive_buffer_size.max");
+  HttpEstablishStaticConfigByte(c.keep_alive_park_buffers, "proxy.config.http.keep_alive_park_buffers");
+
   HttpEstablishStaticConfigByte(c.oride.send_http11_requests, "proxy.config.http.send_http11_requests");
 
   // HTTP Referer Filtering
@@ -1163,6 +1197,9 @@ HttpConfig::reconfigure()
   params->oride.server_tcp_init_cwnd = m_master.oride.server_tcp_init_cwnd;
   params->oride.origin_max_connections = m_master.oride.origin_max_connections;
   params->origin_min_keep_alive_connections = m_master.origin_min_keep_alive_connections;
+  params->origin_max_connections_queue = m_master.origin_max_connections_queue;
+  params->origin_max_connections_queue_timeout = m_master.origin_max_connections_queue_timeout;
+  params->oride.origin_max_connections_queue_priority = m_master.oride.origin_max_connections_queue_priority;
   params->attach_server_session_to_client = m_master.attach_server_session_to_client;
 
   if (params->oride.origin_max_connections && params->oride.origin_max_connections < params->origin_min_keep_alive_connections) {
@@ -1301,6 +1338,7 @@ HttpConfig::reconfigure()
   params->oride.cache_urls_that_look_dynamic = INT_TO_BOOL(m_master.oride.cache_urls_that_look_dynamic);
   params->cache_enable_default_vary_headers = INT_TO_BOOL(m_master.cache_enable_default_vary_headers);
   params->cache_post_method = INT_TO_BOOL(m_master.cache_post_method);
+  params->cache_range_partial = INT_TO_BOOL(m_master.cache_range_partial);
 
   params->ignore_accept_mismatch = m_master.ignore_accept_mismatch;
   params->ignore_accept_language_mismatch = m_master.ignore_accept_language_mismatch;
@@ -1332,6 +1370,11 @@ HttpConfig::reconfigure()
   params->errors_log_error_pages = INT_TO_BOOL(m_master.errors_log_error_pages);
   params->oride.slow_log_threshold = m_master.oride.slow_log_threshold;
   params->record_cop_page = INT_TO_BOOL(m_master.record_cop_page);
+  params->latency_histograms = m_master.latency_histograms;
+  params->latency_histograms_max_entries = m_master.latency_histograms_max_entries;
+  params->adaptive_buffer_size = m_master.adaptive_buffer_size;
+  params->adaptive_buffer_max_size = m_master.adaptive_buffer_max_size;
+  params->keep_alive_park_buffers = m_master.keep_alive_park_buffers;
   params->oride.send_http11_requests = m_master.oride.send_http11_requests;
   params->oride.doc_in_cache_skip_dns = INT_TO_BOOL(m_master.oride.doc_in_cache_skip_dns);
   params->oride.default_buffer_size_index = m_master.oride.default_buffer_size_index;
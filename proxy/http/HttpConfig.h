@@ -56,6 +56,8 @@ enum {
   http_current_client_connections_stat,
   http_current_active_client_connections_stat,
   http_websocket_current_active_client_connections_stat,
+  http_current_parked_client_connections_stat,
+  http_parked_client_buffer_bytes_stat,
   http_current_client_transactions_stat,
   http_total_incoming_connections_stat,
   http_current_server_transactions_stat,
@@ -77,6 +79,9 @@ enum {
   http_current_parent_proxy_connections_stat,
   http_current_server_connections_stat,
   http_current_cache_connections_stat,
+  http_origin_queued_stat,
+  http_origin_queue_timeouts_stat,
+  http_origin_queue_full_stat,
 
   // Http K-A Stats
   http_transactions_per_client_con,
@@ -177,6 +182,7 @@ enum {
   http_cache_miss_uncacheable_stat,
   http_cache_miss_ims_stat,
   http_cache_read_error_stat,
+  http_cache_surrogate_key_evictions_stat,
 
   // bandwidth savings stats
   http_tcp_hit_count_stat,
@@ -332,6 +338,18 @@ extern RecRawStatBlock *http_rsb;
 #define HTTP_READ_DYN_SUM(x, S) RecGetRawStatSum(http_rsb, (int)x, &S) // This aggregates threads too
 #define HTTP_READ_GLOBAL_DYN_SUM(x, S) RecGetGlobalRawStatSum(http_rsb, (int)x, &S)
 
+// latency histograms, in microseconds
+enum {
+  http_ttfb_hist,
+  http_total_time_hist,
+
+  http_hist_count
+};
+
+extern RecHistogramBlock *http_hist;
+
+#define HTTP_HISTOGRAM_ADD(x, y) RecIncrHistogram(http_hist, mutex->thread_holding, (int)x, (int64_t)y)
+
 /////////////////////////////////////////////////////////////
 //
 // struct HttpConfigPortRange
@@ -378,12 +396,13 @@ struct OverridableHttpConfigParams {
       cache_heuristic_min_lifetime(3600), cache_heuristic_max_lifetime(86400), cache_guaranteed_min_lifetime(0),
       cache_guaranteed_max_lifetime(31536000), cache_max_stale_age(604800), keep_alive_no_activity_timeout_in(115),
       keep_alive_no_activity_timeout_out(120), transaction_no_activity_timeout_in(30), transaction_no_activity_timeout_out(30),
-      transaction_active_timeout_out(0), origin_max_connections(0), connect_attempts_max_retries(0),
-      connect_attempts_max_retries_dead_server(3), connect_attempts_rr_retries(3), connect_attempts_timeout(30),
-      post_connect_attempts_timeout(1800), down_server_timeout(300), client_abort_threshold(10), freshness_fuzz_time(240),
-      freshness_fuzz_min_time(0), max_cache_open_read_retries(-1), cache_open_read_retry_time(10), cache_generation_number(-1),
-      max_cache_open_write_retries(1), background_fill_active_timeout(60), http_chunking_size(4096), flow_high_water_mark(0),
-      flow_low_water_mark(0), default_buffer_size_index(8), default_buffer_water_mark(32768), slow_log_threshold(0),
+      transaction_active_timeout_out(0), origin_max_connections(0), origin_max_connections_queue_priority(0),
+      connect_attempts_max_retries(0), connect_attempts_max_retries_dead_server(3), connect_attempts_rr_retries(3),
+      connect_attempts_timeout(30), post_connect_attempts_timeout(1800), down_server_timeout(300), client_abort_threshold(10),
+      freshness_fuzz_time(240), freshness_fuzz_min_time(0), max_cache_open_read_retries(-1), cache_open_read_retry_time(10),
+      cache_generation_number(-1), max_cache_open_write_retries(1), background_fill_active_timeout(60), http_chunking_size(4096),
+      flow_high_water_mark(0), flow_low_water_mark(0), default_buffer_size_index(8), default_buffer_water_mark(32768),
+      slow_log_threshold(0),
 
       // Strings / floats must come last
       body_factory_template_base(NULL), body_factory_template_base_len(0), proxy_response_server_string(NULL),
@@ -528,6 +547,7 @@ struct OverridableHttpConfigParams {
   MgmtInt transaction_no_activity_timeout_out;
   MgmtInt transaction_active_timeout_out;
   MgmtInt origin_max_connections;
+  MgmtInt origin_max_connections_queue_priority;
 
   ////////////////////////////////////
   // origin server connect attempts //
@@ -632,6 +652,8 @@ public:
 
   MgmtInt server_max_connections;
   MgmtInt origin_min_keep_alive_connections; // TODO: This one really ought to be overridable, but difficult right now.
+  MgmtInt origin_max_connections_queue;
+  MgmtInt origin_max_connections_queue_timeout;
   MgmtInt attach_server_session_to_client;
   MgmtInt max_websocket_connections;
 
@@ -693,6 +715,7 @@ public:
   ///////////////////
   MgmtByte cache_enable_default_vary_headers;
   MgmtByte cache_post_method;
+  MgmtByte cache_range_partial;
 
   ////////////////////////////////////////////
   // CONNECT ports (used to be == ssl_ports //
@@ -724,6 +747,20 @@ public:
   ///////////////////
   MgmtByte record_cop_page;
 
+  ///////////////////////
+  // latency histograms //
+  ///////////////////////
+  MgmtByte latency_histograms;
+  MgmtInt latency_histograms_max_entries;
+
+  ///////////////////////////
+  // adaptive buffer sizes //
+  ///////////////////////////
+  MgmtByte adaptive_buffer_size;
+  MgmtInt adaptive_buffer_max_size;
+
+  MgmtByte keep_alive_park_buffers;
+
   /////////////////////
   // Error Reporting //
   /////////////////////
@@ -847,16 +884,19 @@ extern volatile int32_t icp_dynamic_enabled;
 /////////////////////////////////////////////////////////////
 inline HttpConfigParams::HttpConfigParams()
   : proxy_hostname(NULL), proxy_hostname_len(0), server_max_connections(0), origin_min_keep_alive_connections(0),
-    max_websocket_connections(-1), parent_proxy_routing_enable(0), disable_ssl_parenting(0), enable_url_expandomatic(0),
+    origin_max_connections_queue(0), origin_max_connections_queue_timeout(5000), max_websocket_connections(-1),
+    parent_proxy_routing_enable(0), disable_ssl_parenting(0), enable_url_expandomatic(0),
     no_dns_forward_to_parent(0), uncacheable_requests_bypass_parent(1), no_origin_server_dns(0), use_client_target_addr(0),
     use_client_source_port(0), proxy_request_via_string(NULL), proxy_request_via_string_len(0), proxy_response_via_string(NULL),
     proxy_response_via_string_len(0), url_expansions_string(NULL), url_expansions(NULL), num_url_expansions(0),
     session_auth_cache_keep_alive_enabled(1), transaction_active_timeout_in(900), accept_no_activity_timeout(120),
     parent_connect_attempts(4), per_parent_connect_attempts(2), parent_connect_timeout(30), anonymize_other_header_list(NULL),
     enable_http_stats(1), icp_enabled(0), stale_icp_enabled(0), cache_vary_default_text(NULL), cache_vary_default_images(NULL),
-    cache_vary_default_other(NULL), cache_enable_default_vary_headers(0), cache_post_method(0), connect_ports_string(NULL),
-    connect_ports(NULL), push_method_enabled(0), referer_filter_enabled(0), referer_format_redirect(0), reverse_proxy_enabled(0),
-    url_remap_required(1), record_cop_page(0), errors_log_error_pages(1), enable_http_info(0), cluster_time_delta(0),
+    cache_vary_default_other(NULL), cache_enable_default_vary_headers(0), cache_post_method(0), cache_range_partial(0),
+    connect_ports_string(NULL), connect_ports(NULL), push_method_enabled(0), referer_filter_enabled(0), referer_format_redirect(0),
+    reverse_proxy_enabled(0), url_remap_required(1), record_cop_page(0), latency_histograms(0), latency_histograms_max_entries(16),
+    adaptive_buffer_size(0), adaptive_buffer_max_size(131072), keep_alive_park_buffers(0), errors_log_error_pages(1),
+    enable_http_info(0), cluster_time_delta(0),
     redirection_host_no_port(1), post_copy_size(2048), ignore_accept_mismatch(0), ignore_accept_language_mismatch(0),
     ignore_accept_encoding_mismatch(0), ignore_accept_charset_mismatch(0), send_100_continue_response(0),
     disallow_post_100_continue(0), parser_allow_non_http(1), max_post_size(0),
@@ -21,7 +21,233 @@
   limitations under the License.
  */
 
+#include "P_EventSystem.h"
 #include "HttpConnectionCount.h"
 
 
 ConnectionCount ConnectionCount::_connectionCount;
+
+ConnectionCount::WaitResult
+ConnectionCount::waitForConnection(const IpEndpoint &addr, int max_connections, OriginWaiter *waiter, int max_waiters, bool woken)
+{
+  ConnAddr caddr(addr);
+  WaitResult result = WAIT_QUEUED;
+  int priority      = waiter->priority;
+
+  if (priority < 0) {
+    priority = 0;
+  } else if (priority >= ORIGIN_QUEUE_PRIORITIES) {
+    priority = ORIGIN_QUEUE_PRIORITIES - 1;
+  }
+
+  ink_mutex_acquire(&_mutex);
+  WaitQueue *queue = _hostQueue.find(&addr.sa);
+  bool room        = _hostCount.get(caddr) < max_connections;
+
+  if (room && (woken || queue == NULL)) {
+    result = WAIT_CONNECT;
+  } else if (!woken && queue != NULL && queue->length >= max_waiters) {
+    result = WAIT_FULL;
+  } else {
+    if (queue == NULL) {
+      queue = new WaitQueue(addr);
+      _hostQueue.insert(queue);
+    }
+    if (woken) {
+      queue->waiters[priority].push(waiter);
+    } else {
+      queue->waiters[priority].enqueue(waiter);
+    }
+    ats_ip_copy(&waiter->addr, &addr);
+    waiter->queued = true;
+    ++queue->length;
+    ++_waiting;
+    // There is room but others got here first, keep the line moving.
+    if (room) {
+      dispatch(queue, NULL);
+    }
+  }
+  ink_mutex_release(&_mutex);
+
+  return result;
+}
+
+bool
+ConnectionCount::cancelWait(OriginWaiter *waiter)
+{
+  bool waiting = false;
+
+  ink_mutex_acquire(&_mutex);
+  WaitQueue *queue = _hostQueue.find(&waiter->addr.sa);
+  if (waiter->queued) {
+    ink_assert(queue != NULL);
+    for (int i = 0; i < ORIGIN_QUEUE_PRIORITIES; ++i) {
+      if (queue->waiters[i].in(waiter)) {
+        queue->waiters[i].remove(waiter);
+        break;
+      }
+    }
+    waiter->queued = false;
+    --queue->length;
+    --_waiting;
+    releaseQueue(queue);
+    waiting = true;
+  } else if (waiter->wakeup != NULL) {
+    waiter->wakeup->cancel();
+    waiter->wakeup = NULL;
+    if (queue != NULL) {
+      dispatch(queue, NULL);
+    }
+    waiting = true;
+  }
+  ink_mutex_release(&_mutex);
+
+  return waiting;
+}
+
+void
+ConnectionCount::wakeup(const IpEndpoint &addr, EThread *thread)
+{
+  if (_waiting == 0) {
+    return;
+  }
+
+  ink_mutex_acquire(&_mutex);
+  WaitQueue *queue = _hostQueue.find(&addr.sa);
+  if (queue != NULL) {
+    dispatch(queue, thread);
+  }
+  ink_mutex_release(&_mutex);
+}
+
+int
+ConnectionCount::getWaiting(const IpEndpoint &addr)
+{
+  ink_mutex_acquire(&_mutex);
+  WaitQueue *queue = _hostQueue.find(&addr.sa);
+  int waiting      = queue ? queue->length : 0;
+  ink_mutex_release(&_mutex);
+  return waiting;
+}
+
+// Called with _mutex held.
+void
+ConnectionCount::dispatch(WaitQueue *queue, EThread *thread)
+{
+  for (int i = ORIGIN_QUEUE_PRIORITIES - 1; i >= 0; --i) {
+    OriginWaiter *waiter = queue->waiters[i].head;
+    while (waiter != NULL && thread != NULL && waiter->thread != thread) {
+      waiter = waiter->link.next;
+    }
+    if (waiter != NULL) {
+      queue->waiters[i].remove(waiter);
+      waiter->queued = false;
+      --queue->length;
+      --_waiting;
+      waiter->wakeup = waiter->thread->schedule_imm_signal(waiter->cont);
+      releaseQueue(queue);
+      return;
+    }
+  }
+}
+
+// Called with _mutex held, frees the queue of a host nobody waits for.
+void
+ConnectionCount::releaseQueue(WaitQueue *queue)
+{
+  if (queue->length == 0) {
+    _hostQueue.remove(_hostQueue.find(queue));
+    delete queue;
+  }
+}
+
+#if TS_HAS_TESTS
+#include "ts/TestBox.h"
+
+namespace
+{
+struct OriginWaitTestCont : public Continuation {
+  OriginWaitTestCont() : Continuation(new_ProxyMutex()) { SET_HANDLER(&OriginWaitTestCont::handle_event); }
+  int
+  handle_event(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    return EVENT_DONE;
+  }
+};
+}
+
+REGRESSION_TEST(ConnectionCount_WaitQueue)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  ConnectionCount *cc = ConnectionCount::getInstance();
+  EThread *thread     = this_ethread();
+  EThread *other      = NULL;
+  IpEndpoint addr;
+  OriginWaiter w[5];
+  int priority[5] = {0, 0, 2, 0, 0};
+
+  // Wake ups are cancelled before they are delivered, keep the continuation anyway.
+  OriginWaitTestCont *cont = new OriginWaitTestCont;
+  for (int i = 0; i < 5; ++i) {
+    w[i].cont     = cont;
+    w[i].thread   = thread;
+    w[i].priority = priority[i];
+  }
+  for (int i = 0; i < eventProcessor.n_ethreads; ++i) {
+    if (eventProcessor.all_ethreads[i] != thread) {
+      other = eventProcessor.all_ethreads[i];
+    }
+  }
+
+  ats_ip_pton("192.0.2.50:80", &addr);
+  cc->incrementCount(addr, 2);
+
+  box.check(cc->waitForConnection(addr, 3, &w[0], 3, false) == ConnectionCount::WAIT_CONNECT, "Under the limit, should connect");
+
+  // At the limit, three may wait.
+  cc->incrementCount(addr);
+  for (int i = 0; i < 3; ++i) {
+    box.check(cc->waitForConnection(addr, 3, &w[i], 3, false) == ConnectionCount::WAIT_QUEUED, "Waiter %d should be queued", i);
+  }
+  box.check(cc->waitForConnection(addr, 3, &w[3], 3, false) == ConnectionCount::WAIT_FULL, "Waiter 3 should find the queue full");
+  box.check(cc->getWaiting(addr) == 3, "Expected 3 waiting, got %d", cc->getWaiting(addr));
+
+  // A session pooled on another thread is no use to waiters of this one.
+  if (other != NULL) {
+    cc->wakeup(addr, other);
+    box.check(cc->getWaiting(addr) == 3, "Nobody should be woken for another thread's pool");
+  }
+
+  // Priority first, then arrival order.
+  cc->wakeup(addr);
+  box.check(!w[2].queued && w[2].wakeup != NULL, "The priority 2 waiter should be woken first");
+  cc->wakeup(addr, thread);
+  box.check(!w[0].queued && w[0].wakeup != NULL && w[1].queued, "Waiter 0 should be woken before waiter 1");
+
+  // Beaten to the connection, a woken waiter goes back to the front.
+  w[0].wakeup->cancel();
+  cc->wakeupDone(&w[0]);
+  box.check(cc->waitForConnection(addr, 3, &w[0], 3, true) == ConnectionCount::WAIT_QUEUED, "Woken waiter 0 should queue again");
+  cc->wakeup(addr);
+  box.check(!w[0].queued && w[0].wakeup != NULL && w[1].queued, "Waiter 0 should be woken again before waiter 1");
+
+  // Newcomers queue behind waiters even with room, and move the line along.
+  cc->incrementCount(addr, -1);
+  box.check(cc->waitForConnection(addr, 3, &w[4], 3, false) == ConnectionCount::WAIT_QUEUED, "Waiter 4 should queue behind 1");
+  box.check(!w[1].queued && w[1].wakeup != NULL && w[4].queued, "Waiter 1 should be woken by the newcomer");
+
+  box.check(cc->cancelWait(&w[4]), "Waiter 4 should have been queued");
+  box.check(!cc->cancelWait(&w[3]), "Waiter 3 was never queued");
+  box.check(cc->getWaiting(addr) == 0, "Expected nobody waiting, got %d", cc->getWaiting(addr));
+
+  for (int i = 0; i < 5; ++i) {
+    if (w[i].wakeup != NULL) {
+      w[i].wakeup->cancel();
+      cc->wakeupDone(&w[i]);
+    }
+  }
+  cc->incrementCount(addr, -2);
+}
+#endif /* TS_HAS_TESTS */
@@ -26,10 +26,34 @@
 #include "ts/ink_inet.h"
 #include "ts/ink_mutex.h"
 #include "ts/Map.h"
+#include "ts/List.h"
 
 #ifndef _HTTP_CONNECTION_COUNT_H_
 #define _HTTP_CONNECTION_COUNT_H_
 
+class Continuation;
+class EThread;
+class Event;
+
+#define ORIGIN_QUEUE_PRIORITIES 4
+
+/**
+ * A transaction waiting for a connection to a host that is at its
+ * connection limit.  It is woken with an EVENT_IMMEDIATE on the thread it
+ * queued from.
+ */
+struct OriginWaiter {
+  Continuation *cont;
+  EThread *thread;
+  IpEndpoint addr; // of the host waited for
+  Event *wakeup;   // dispatched but not yet handled by cont
+  int priority;
+  bool queued;
+  LINK(OriginWaiter, link);
+
+  OriginWaiter() : cont(NULL), thread(NULL), wakeup(NULL), priority(0), queued(false) { ink_zero(addr); }
+};
+
 /**
  * Singleton class to keep track of the number of connections per host
  */
@@ -75,6 +99,60 @@ public:
     ink_mutex_release(&_mutex);
   }
 
+  enum WaitResult {
+    WAIT_CONNECT, ///< go ahead and open a connection
+    WAIT_QUEUED,  ///< queued, the waiter is woken when a connection frees up
+    WAIT_FULL     ///< too many transactions are already waiting
+  };
+
+  /**
+   * Check whether a transaction may open a connection to the host, queue it
+   * otherwise.  New transactions queue behind the ones already waiting even
+   * if the host is under its limit, a woken one goes back to the front of
+   * its class if it lost the connection to someone else.
+   * @param addr IP address of the host
+   * @param max_connections Connection limit of the host
+   * @param waiter The transaction, queued on WAIT_QUEUED
+   * @param max_waiters Maximum number of transactions waiting for the host
+   * @param woken true if the transaction is retrying after a wake up
+   */
+  WaitResult waitForConnection(const IpEndpoint &addr, int max_connections, OriginWaiter *waiter, int max_waiters, bool woken);
+
+  /**
+   * Stop waiting, called with the mutex of the waiter held.  A wake up that
+   * is already on its way is cancelled and passed on to the next waiter.
+   * @return true if the transaction was queued or about to be woken
+   */
+  bool cancelWait(OriginWaiter *waiter);
+
+  /**
+   * Note that a woken transaction handled its wake up event
+   */
+  void
+  wakeupDone(OriginWaiter *waiter)
+  {
+    ink_mutex_acquire(&_mutex);
+    waiter->wakeup = NULL;
+    ink_mutex_release(&_mutex);
+  }
+
+  /**
+   * Wake the first transaction waiting for the host, highest priority class
+   * first and in arrival order within a class.  Called whenever a connection
+   * to the host is closed or goes back to the session pool.
+   * @param addr IP address of the host
+   * @param thread If set, only a transaction that queued from this thread is
+   * woken, for a session released to the pool of that thread
+   */
+  void wakeup(const IpEndpoint &addr, EThread *thread = NULL);
+
+  /**
+   * Gets the number of transactions waiting for a connection to the host
+   * @param ip IP address of the host
+   * @return Number of transactions queued
+   */
+  int getWaiting(const IpEndpoint &addr);
+
   struct ConnAddr {
     IpEndpoint _addr;
 
@@ -104,12 +182,50 @@ public:
   };
 
 private:
+  struct WaitQueue {
+    IpEndpoint addr;
+    Queue<OriginWaiter> waiters[ORIGIN_QUEUE_PRIORITIES];
+    int length;
+    LINK(WaitQueue, hash_link);
+
+    WaitQueue(const IpEndpoint &a) : length(0) { ats_ip_copy(&addr, &a); }
+  };
+
+  struct WaitQueueHashing {
+    typedef uint32_t ID;
+    typedef sockaddr const *Key;
+    typedef WaitQueue Value;
+    typedef DList(WaitQueue, hash_link) ListHead;
+
+    static ID
+    hash(Key key)
+    {
+      return ats_ip_hash(key);
+    }
+    static Key
+    key(Value const *value)
+    {
+      return &value->addr.sa;
+    }
+    static bool
+    equal(Key lhs, Key rhs)
+    {
+      return ats_ip_addr_eq(lhs, rhs);
+    }
+  };
+  typedef TSHashTable<WaitQueueHashing> WaitQueueTable;
+
   // Hide the constructor and copy constructor
-  ConnectionCount() { ink_mutex_init(&_mutex, "ConnectionCountMutex"); }
+  ConnectionCount() : _waiting(0) { ink_mutex_init(&_mutex, "ConnectionCountMutex"); }
   ConnectionCount(const ConnectionCount & /* x ATS_UNUSED */) {}
 
+  void dispatch(WaitQueue *queue, EThread *thread);
+  void releaseQueue(WaitQueue *queue);
+
   static ConnectionCount _connectionCount;
   HashMap<ConnAddr, ConnAddrHashFns, int> _hostCount;
+  WaitQueueTable _hostQueue; // only hosts with transactions waiting
+  int _waiting;              // across all hosts, to skip the lookup in wakeup()
   ink_mutex _mutex;
 };
 
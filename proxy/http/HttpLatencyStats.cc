@@ -0,0 +1,146 @@
+/** @file
+
+  Per remap rule and per origin latency histograms
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HttpLatencyStats.h"
+#include "remap/UrlMapping.h"
+
+HttpLatencyStats HttpLatencyStats::_latencyStats;
+HttpLatencyEntry HttpLatencyStats::untracked;
+
+static const struct {
+  const char *name;
+  TSMilestonesType start;
+  TSMilestonesType end;
+} latency_metrics[HTTP_LATENCY_METRICS] = {
+  {"dns", TS_MILESTONE_DNS_LOOKUP_BEGIN, TS_MILESTONE_DNS_LOOKUP_END},
+  {"cache_read", TS_MILESTONE_CACHE_OPEN_READ_BEGIN, TS_MILESTONE_CACHE_OPEN_READ_END},
+  {"server_connect", TS_MILESTONE_SERVER_CONNECT, TS_MILESTONE_SERVER_CONNECT_END},
+  {"server_ttfb", TS_MILESTONE_SERVER_BEGIN_WRITE, TS_MILESTONE_SERVER_FIRST_READ},
+  {"ttfb", TS_MILESTONE_SM_START, TS_MILESTONE_UA_BEGIN_WRITE},
+  {"total", TS_MILESTONE_SM_START, TS_MILESTONE_SM_FINISH},
+};
+
+// Copy a remap or origin host into a record name component, anything but
+// letters, digits, '-' and '_' becomes '_' so the key stays one component.
+static void
+latency_key(char *buf, int size, const char *s, int len)
+{
+  int i;
+
+  for (i = 0; i < len && i < size - 1; i++) {
+    buf[i] = (ParseRules::is_alnum(s[i]) || s[i] == '-' || s[i] == '_') ? s[i] : '_';
+  }
+  buf[i] = '\0';
+}
+
+HttpLatencyEntry *
+HttpLatencyStats::getEntry(const char *kind, const char *key, int64_t max_entries)
+{
+  char name[256];
+  HttpLatencyEntry *entry;
+
+  snprintf(name, sizeof(name), "%s.%s", kind, key);
+
+  ink_mutex_acquire(&_mutex);
+  if ((entry = _table.get(name)) == NULL && _entries < max_entries) {
+    entry = (HttpLatencyEntry *)ats_malloc(sizeof(HttpLatencyEntry));
+    memset(entry, 0, sizeof(HttpLatencyEntry));
+    _table.put(ats_strdup(name), entry);
+    ++_entries;
+
+    Debug("http_latency", "tracking latency of %s", name);
+    for (int i = 0; i < HTTP_LATENCY_METRICS; i++) {
+      char stat_name[512];
+
+      snprintf(stat_name, sizeof(stat_name), "proxy.process.http.latency.%s.%s", name, latency_metrics[i].name);
+      if (RecRegisterSharedHistogram(RECT_PROCESS, stat_name, &entry->histograms[i]) != REC_ERR_OKAY) {
+        Warning("unable to register latency histogram %s, increase the number of API stats", stat_name);
+        _entries = max_entries; // out of records, stop adding keys
+        break;
+      }
+    }
+  }
+  ink_mutex_release(&_mutex);
+
+  return entry ? entry : &untracked;
+}
+
+HttpLatencyEntry *
+HttpLatencyStats::originEntry(int64_t max_entries, const char *origin)
+{
+  char key[128];
+
+  if (origin == NULL || *origin == '\0') {
+    return &untracked;
+  }
+  latency_key(key, sizeof(key), origin, strlen(origin));
+
+  return getEntry("origin", key, max_entries);
+}
+
+void
+HttpLatencyStats::record(int mode, int64_t max_entries, url_mapping *map, HttpLatencyEntry *origin,
+                         const TransactionMilestones &milestones)
+{
+  HttpLatencyEntry *entries[2];
+  int n = 0;
+  char key[128];
+
+  if ((mode & HTTP_LATENCY_BY_REMAP) && map) {
+    // The entry outlives the mapping, so racing transactions can only ever
+    // store the same pointer here, untracked rules cache the sentinel.
+    if (map->latency_stats == NULL) {
+      if (map->map_id) {
+        snprintf(key, sizeof(key), "mapid_%u", map->map_id);
+      } else {
+        int len;
+        const char *host = map->fromURL.host_get(&len);
+
+        if (host && len > 0) {
+          latency_key(key, sizeof(key), host, len);
+        } else {
+          ink_strlcpy(key, "default", sizeof(key));
+        }
+      }
+      map->latency_stats = getEntry("remap", key, max_entries);
+    }
+    if (map->latency_stats != &untracked) {
+      entries[n++] = map->latency_stats;
+    }
+  }
+
+  if ((mode & HTTP_LATENCY_BY_ORIGIN) && origin && origin != &untracked) {
+    entries[n++] = origin;
+  }
+
+  for (int i = 0; n > 0 && i < HTTP_LATENCY_METRICS; i++) {
+    if (milestones[latency_metrics[i].start] == 0 || milestones[latency_metrics[i].end] == 0) {
+      continue;
+    }
+
+    int64_t usec = ink_hrtime_to_usec(milestones.elapsed(latency_metrics[i].start, latency_metrics[i].end));
+    for (int j = 0; j < n; j++) {
+      RecIncrSharedHistogram(&entries[j]->histograms[i], usec);
+    }
+  }
+}
@@ -0,0 +1,108 @@
+/** @file
+
+  Per remap rule and per origin latency histograms
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "ts/ink_platform.h"
+#include "ts/ink_mutex.h"
+#include "ts/Map.h"
+#include "P_RecProcess.h"
+#include "StatSystem.h"
+
+#ifndef _HTTP_LATENCY_STATS_H_
+#define _HTTP_LATENCY_STATS_H_
+
+class url_mapping;
+
+/// Values for proxy.config.http.latency_histograms, a bit mask.
+enum {
+  HTTP_LATENCY_BY_REMAP = 1,
+  HTTP_LATENCY_BY_ORIGIN = 2,
+};
+
+/// Milestone deltas recorded for every tracked remap rule and origin.
+enum HttpLatencyMetric {
+  HTTP_LATENCY_DNS,            ///< dns_lookup_begin -> dns_lookup_end
+  HTTP_LATENCY_CACHE_READ,     ///< cache_open_read_begin -> cache_open_read_end
+  HTTP_LATENCY_SERVER_CONNECT, ///< server_connect -> server_connect_end
+  HTTP_LATENCY_SERVER_TTFB,    ///< server_begin_write -> server_first_read
+  HTTP_LATENCY_TTFB,           ///< sm_start -> ua_begin_write
+  HTTP_LATENCY_TOTAL,          ///< sm_start -> sm_finish
+  HTTP_LATENCY_METRICS
+};
+
+/// The histograms, in microseconds, of one remap rule or origin.
+struct HttpLatencyEntry {
+  RecHistogram histograms[HTTP_LATENCY_METRICS];
+};
+
+/**
+ * Singleton class keeping latency histograms of transaction milestone deltas
+ * per remap rule and per origin server. The histograms are exported as
+ *
+ *   proxy.process.http.latency.{remap,origin}.<key>.<metric>.{count,p50,p90,p99,p999,max}
+ *
+ * Entries are created on first use and live for the life of the process, so
+ * a url_mapping and an HttpServerSession can cache their entry, and only the
+ * first transaction of a rule or session pays for the lookup. At most
+ * proxy.config.http.latency_histograms.max_entries keys are tracked, keys
+ * past that cache the untracked sentinel so they are not looked up again.
+ */
+class HttpLatencyStats
+{
+public:
+  static HttpLatencyStats *
+  getInstance()
+  {
+    return &_latencyStats;
+  }
+
+  /**
+   * Get the entry of an origin server, for caching in its server session.
+   * @return The entry, or the untracked sentinel, never NULL
+   */
+  HttpLatencyEntry *originEntry(int64_t max_entries, const char *origin);
+
+  /**
+   * Record the milestone deltas of a finished transaction.
+   * @param mode Value of proxy.config.http.latency_histograms
+   * @param max_entries Maximum number of remap and origin keys to track
+   * @param map The remap rule the transaction matched, or NULL
+   * @param origin The cached entry of the last origin server session, or NULL
+   */
+  void record(int mode, int64_t max_entries, url_mapping *map, HttpLatencyEntry *origin, const TransactionMilestones &milestones);
+
+  /// Cached for keys that are not tracked, never recorded into.
+  static HttpLatencyEntry untracked;
+
+private:
+  HttpLatencyStats() : _entries(0) { ink_mutex_init(&_mutex, "HttpLatencyStatsMutex"); }
+  HttpLatencyStats(const HttpLatencyStats & /* x ATS_UNUSED */) {}
+
+  HttpLatencyEntry *getEntry(const char *kind, const char *key, int64_t max_entries);
+
+  static HttpLatencyStats _latencyStats;
+  HashMap<cchar *, StringHashFns, HttpLatencyEntry *> _table;
+  int64_t _entries;
+  ink_mutex _mutex;
+};
+
+#endif
@@ -32,6 +32,7 @@
 #include "HttpUpdateSM.h"
 #include "HttpClientSession.h"
 #include "HttpPages.h"
+#include "HttpSurrogateKeys.h"
 #include "HttpTunnel.h"
 #include "ts/Tokenizer.h"
 #include "P_SSLNextProtocolAccept.h"
@@ -117,6 +118,9 @@ make_net_accept_options(const HttpProxyPort &port, unsigned nthreads)
   net.f_inbound_transparent = port.m_inbound_transparent_p;
   net.ip_family = port.m_family;
   net.local_port = port.m_port;
+  if (port.m_tcp_fastopen) {
+    net.sockopt_flags |= NetVCOptions::SOCK_OPT_TCP_FAST_OPEN;
+  }
 
   if (port.m_inbound_ip.isValid()) {
     net.local_ip = port.m_inbound_ip;
@@ -242,6 +246,7 @@ init_HttpProxyServer(int n_accept_threads)
   init_reverse_proxy();
   httpSessionManager.init();
   http_pages_init();
+  HttpSurrogateKeys::getInstance()->start();
   ink_mutex_init(&debug_sm_list_mutex, "HttpSM Debug List");
   ink_mutex_init(&debug_cs_list_mutex, "HttpCS Debug List");
   // DI's request to disable/reenable ICP on the fly
@@ -300,6 +305,8 @@ start_HttpProxyServer()
     // NULL. It would be useful to be able to detect errors and spew them here though.
   }
 
+  httpSessionManager.start_prewarm();
+
 #if TS_HAS_TESTS
   if (is_action_tag_set("http_update_test")) {
     init_http_update_test();
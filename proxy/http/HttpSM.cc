@@ -27,6 +27,7 @@
 #include "HttpClientSession.h"
 #include "HttpServerSession.h"
 #include "HttpDebugNames.h"
+#include "HttpLatencyStats.h"
 #include "HttpSessionManager.h"
 #include "P_Cache.h"
 #include "P_Net.h"
@@ -270,7 +271,8 @@ HttpSM::HttpSM()
     enable_redirection(false), redirect_url(NULL), redirect_url_len(0), redirection_tries(0), transfered_bytes(0),
     post_failed(false), debug_on(false), plugin_tunnel_type(HTTP_NO_PLUGIN_TUNNEL), plugin_tunnel(NULL), reentrancy_count(0),
     history_pos(0), tunnel(), ua_entry(NULL), ua_session(NULL), background_fill(BACKGROUND_FILL_NONE), ua_raw_buffer_reader(NULL),
-    server_entry(NULL), server_session(NULL), will_be_private_ss(false), shared_session_retries(0), server_buffer_reader(NULL),
+    server_entry(NULL), server_session(NULL), origin_latency_stats(NULL), will_be_private_ss(false), shared_session_retries(0),
+    origin_waiter(), origin_queue_timeout(NULL), origin_queue_deadline(0), origin_queue_woken(false), server_buffer_reader(NULL),
     transform_info(), post_transform_info(), has_active_plugin_agents(false), second_cache_sm(NULL), default_handler(NULL),
     pending_action(NULL), historical_action(NULL), last_action(HttpTransact::SM_ACTION_UNDEFINED),
     // TODO:  Now that bodies can be empty, should the body counters be set to -1 ? TS-2213
@@ -1091,8 +1093,16 @@ HttpSM::state_raw_http_server_open(int event, void *data)
     break;
 
   case EVENT_INTERVAL:
-    Error("[HttpSM::state_raw_http_server_open] event: EVENT_INTERVAL state: %d server_entry: %p", t_state.current.state,
-          server_entry);
+    if (origin_queue_expired(data)) {
+      t_state.current.state = HttpTransact::CONGEST_CONTROL_CONGESTED_ON_M;
+      break;
+    }
+    // Retrying while over server_max_connections or origin_max_connections
+    do_http_server_open(true);
+    return 0;
+
+  case EVENT_IMMEDIATE:
+    origin_queue_resume(true);
     return 0;
 
   default:
@@ -1659,8 +1669,16 @@ HttpSM::state_http_server_open(int event, void *data)
     handle_http_server_open();
     return 0;
   case EVENT_INTERVAL:
+    if (origin_queue_expired(data)) {
+      t_state.current.state = HttpTransact::CONGEST_CONTROL_CONGESTED_ON_M;
+      call_transact_and_set_next_state(HttpTransact::HandleResponse);
+      return 0;
+    }
     do_http_server_open();
     break;
+  case EVENT_IMMEDIATE:
+    origin_queue_resume(false);
+    break;
   case VC_EVENT_ERROR:
   case NET_EVENT_OPEN_FAILED:
     t_state.current.state = HttpTransact::CONNECTION_ERROR;
@@ -2993,6 +3011,7 @@ HttpSM::tunnel_handler_server(int event, HttpTunnelProducer *p)
   } else {
     server_session->attach_hostname(t_state.current.server->name);
     server_session->server_trans_stat--;
+    server_session->last_response_bytes = p->bytes_read;
     HTTP_DECREMENT_DYN_STAT(http_current_server_transactions_stat);
 
     // If the option to attach the server session to the client session is set
@@ -4272,6 +4291,12 @@ HttpSM::parse_range_and_compare(MIMEField *field, int64_t content_length)
     }
   }
 
+  if (nr > 0 && t_state.cache_info.object_read->is_partial() &&
+      (nr != 1 || !cache_sm.cache_read_vc->is_range_cached(ranges[0]._start, ranges[0]._end))) {
+    Debug("http_range", "range not stored in the partial object");
+    t_state.range_in_cache = false;
+  }
+
   if (nr > 0) {
     t_state.range_setup = HttpTransact::RANGE_REQUESTED;
     t_state.ranges = ranges;
@@ -4289,6 +4314,17 @@ Lfaild:
   return;
 }
 
+bool
+HttpSM::is_partial_range_cached()
+{
+  int64_t start, end;
+
+  if (!cache_sm.cache_read_vc ||
+      !t_state.hdr_info.client_request.get_single_range(t_state.cache_info.object_read->object_size_get(), &start, &end))
+    return false;
+  return cache_sm.cache_read_vc->is_range_cached(start, end);
+}
+
 void
 HttpSM::calculate_output_cl(int64_t num_chars_for_ct, int64_t num_chars_for_cl)
 {
@@ -4732,7 +4768,39 @@ HttpSM::do_http_server_open(bool raw)
     ConnectionCount *connections = ConnectionCount::getInstance();
 
     char addrbuf[INET6_ADDRSTRLEN];
-    if (connections->getCount((t_state.current.server->dst_addr)) >= t_state.txn_conf->origin_max_connections) {
+    if (t_state.http_config_param->origin_max_connections_queue > 0) {
+      MgmtInt queue_timeout  = t_state.http_config_param->origin_max_connections_queue_timeout;
+      origin_waiter.cont     = this;
+      origin_waiter.thread   = this_ethread();
+      origin_waiter.priority = t_state.txn_conf->origin_max_connections_queue_priority;
+
+      switch (connections->waitForConnection(t_state.current.server->dst_addr, t_state.txn_conf->origin_max_connections,
+                                             &origin_waiter, t_state.http_config_param->origin_max_connections_queue,
+                                             origin_queue_woken)) {
+      case ConnectionCount::WAIT_CONNECT:
+        break;
+      case ConnectionCount::WAIT_QUEUED:
+        DebugSM("http", "[%" PRId64 "] queued for a connection to: %s", sm_id,
+                ats_ip_ntop(&t_state.current.server->dst_addr.sa, addrbuf, sizeof(addrbuf)));
+        // A transaction woken up but beaten to the connection keeps its deadline.
+        if (!origin_queue_woken) {
+          HTTP_INCREMENT_DYN_STAT(http_origin_queued_stat);
+          origin_queue_deadline = Thread::get_hrtime() + HRTIME_MSECONDS(queue_timeout);
+        }
+        if (queue_timeout > 0) {
+          ink_hrtime left = origin_queue_deadline - Thread::get_hrtime();
+          ink_assert(origin_queue_timeout == NULL);
+          origin_queue_timeout = eventProcessor.schedule_in(this, left > 0 ? left : 0);
+        }
+        return;
+      case ConnectionCount::WAIT_FULL:
+        DebugSM("http", "[%" PRId64 "] too many transactions waiting for: %s", sm_id,
+                ats_ip_ntop(&t_state.current.server->dst_addr.sa, addrbuf, sizeof(addrbuf)));
+        HTTP_INCREMENT_DYN_STAT(http_origin_queue_full_stat);
+        handleEvent(CONGESTION_EVENT_CONGESTED_ON_M, NULL);
+        return;
+      }
+    } else if (connections->getCount((t_state.current.server->dst_addr)) >= t_state.txn_conf->origin_max_connections) {
       DebugSM("http", "[%" PRId64 "] over the number of connection for this host: %s", sm_id,
               ats_ip_ntop(&t_state.current.server->dst_addr.sa, addrbuf, sizeof(addrbuf)));
       ink_assert(pending_action == NULL);
@@ -4800,6 +4868,13 @@ HttpSM::do_http_server_open(bool raw)
                                                        &opt);
   } else {
     if (t_state.method != HTTP_WKSIDX_CONNECT) {
+      // With TCP Fast Open the request goes in the SYN, which the network
+      // may deliver twice, only send idempotent requests that way.
+      if ((opt.sockopt_flags & NetVCOptions::SOCK_OPT_TCP_FAST_OPEN) && t_state.method != HTTP_WKSIDX_GET &&
+          t_state.method != HTTP_WKSIDX_HEAD && t_state.method != HTTP_WKSIDX_OPTIONS && t_state.method != HTTP_WKSIDX_TRACE &&
+          t_state.method != HTTP_WKSIDX_PUT && t_state.method != HTTP_WKSIDX_DELETE) {
+        opt.sockopt_flags &= ~NetVCOptions::SOCK_OPT_TCP_FAST_OPEN;
+      }
       DebugSM("http", "calling netProcessor.connect_re");
       connect_action_handle = netProcessor.connect_re(this,                                 // state machine
                                                       &t_state.current.server->dst_addr.sa, // addr + port
@@ -4820,6 +4895,9 @@ HttpSM::do_http_server_open(bool raw)
         else
           connect_timeout = t_state.txn_conf->connect_attempts_timeout;
       }
+      // connect_s() waits for the handshake before anything is written, so
+      // there is no first write for the SYN to carry.
+      opt.sockopt_flags &= ~NetVCOptions::SOCK_OPT_TCP_FAST_OPEN;
       DebugSM("http", "calling netProcessor.connect_s");
       connect_action_handle = netProcessor.connect_s(this,                                 // state machine
                                                      &t_state.current.server->dst_addr.sa, // addr + port
@@ -5556,7 +5634,12 @@ HttpSM::perform_cache_write_action()
     } else {
       // We are not caching the untransformed.  We might want to
       //  use the cache writevc to cache the transformed copy
+      //  unless it is part of a partially cached object
       ink_assert(transform_cache_sm.cache_write_vc == NULL);
+      if (t_state.partial_write_offset >= 0) {
+        cache_sm.end_both();
+        break;
+      }
       transform_cache_sm.cache_write_vc = cache_sm.cache_write_vc;
       cache_sm.cache_write_vc = NULL;
     }
@@ -5633,6 +5716,14 @@ HttpSM::attach_server_session(HttpServerSession *s)
   HTTP_INCREMENT_DYN_STAT(http_current_server_transactions_stat);
   ++s->server_trans_stat;
 
+  if (t_state.http_config_param->latency_histograms & HTTP_LATENCY_BY_ORIGIN) {
+    if (s->latency_stats == NULL) {
+      s->latency_stats = HttpLatencyStats::getInstance()->originEntry(t_state.http_config_param->latency_histograms_max_entries,
+                                                                      t_state.current.server ? t_state.current.server->name : NULL);
+    }
+    origin_latency_stats = s->latency_stats;
+  }
+
   // Record the VC in our table
   server_entry = vc_table.new_entry();
   server_entry->vc = server_session;
@@ -5909,6 +6000,15 @@ HttpSM::setup_cache_write_transfer(HttpCacheSM *c_sm, VConnection *source_vc, HT
   c_sm->cache_write_vc->set_http_info(store_info);
   store_info->clear();
 
+  // a 206 response is stored as the fragments of the object it covers
+  if (store_info == &t_state.cache_info.object_store && t_state.partial_write_offset >= 0 &&
+      !c_sm->cache_write_vc->set_partial_write(t_state.partial_write_offset, t_state.partial_write_size)) {
+    DebugSM("http", "[%" PRId64 "] partial cache write refused", sm_id);
+    t_state.cache_info.write_status = HttpTransact::CACHE_WRITE_ERROR;
+    c_sm->abort_write();
+    return;
+  }
+
   tunnel.add_consumer(c_sm->cache_write_vc, source_vc, &HttpSM::tunnel_handler_cache_write, HT_CACHE_WRITE, name, skip_bytes);
 
   c_sm->cache_write_vc = NULL;
@@ -6079,7 +6179,19 @@ HttpSM::find_http_resp_buffer_size(int64_t content_length)
   int64_t buf_size;
   int64_t alloc_index;
 
-  if (content_length == HTTP_UNDEFINED_CL) {
+  if (content_length == HTTP_UNDEFINED_CL && t_state.http_config_param->adaptive_buffer_size) {
+    // Start from what the last response on the server session needed, the
+    //   tunnel grows the blocks if the transfer goes on. Blocks never shrink
+    //   during a transfer, a smaller response gets smaller blocks for the
+    //   next one on the session.
+    int64_t max_index = buffer_size_to_index(t_state.http_config_param->adaptive_buffer_max_size);
+
+    alloc_index = MIN_CONFIG_BUFFER_SIZE_INDEX;
+    if (server_session && server_session->last_response_bytes > 0) {
+      alloc_index = std::max(alloc_index, buffer_size_to_index(server_session->last_response_bytes, max_index));
+    }
+    alloc_index = std::min(alloc_index, max_index);
+  } else if (content_length == HTTP_UNDEFINED_CL) {
     // Try use our configured default size.  Otherwise pick
     //   the default size
     alloc_index = (int)t_state.txn_conf->default_buffer_size_index;
@@ -6092,7 +6204,10 @@ HttpSM::find_http_resp_buffer_size(int64_t content_length)
 #else
     buf_size = index_to_buffer_size(HTTP_HEADER_BUFFER_SIZE_INDEX) + content_length;
 #endif
-    alloc_index = buffer_size_to_index(buf_size);
+    // Large documents don't need their whole size in one block
+    alloc_index = t_state.http_config_param->adaptive_buffer_size ?
+                    buffer_size_to_index(buf_size, buffer_size_to_index(t_state.http_config_param->adaptive_buffer_max_size)) :
+                    buffer_size_to_index(buf_size);
   }
 
   return alloc_index;
@@ -6522,6 +6637,36 @@ HttpSM::plugin_agents_cleanup()
   }
 }
 
+// Is this the end of the wait for a connection to an origin at its
+// origin_max_connections?
+bool
+HttpSM::origin_queue_expired(void *data)
+{
+  if (origin_queue_timeout == NULL || data != origin_queue_timeout) {
+    return false;
+  }
+
+  origin_queue_timeout = NULL;
+  ConnectionCount::getInstance()->cancelWait(&origin_waiter);
+  HTTP_INCREMENT_DYN_STAT(http_origin_queue_timeouts_stat);
+  DebugSM("http_ss", "[%" PRId64 "] timed out waiting for a connection to the origin", sm_id);
+  return true;
+}
+
+// A connection to the origin was closed or released while we waited.
+void
+HttpSM::origin_queue_resume(bool raw)
+{
+  ConnectionCount::getInstance()->wakeupDone(&origin_waiter);
+  if (origin_queue_timeout != NULL) {
+    origin_queue_timeout->cancel();
+    origin_queue_timeout = NULL;
+  }
+  origin_queue_woken = true;
+  do_http_server_open(raw);
+  origin_queue_woken = false;
+}
+
 //////////////////////////////////////////////////////////////////////////
 //
 //  HttpSM::kill_this()
@@ -6553,6 +6698,14 @@ HttpSM::kill_this()
       pending_action = NULL;
     }
 
+    if (origin_waiter.cont != NULL) {
+      ConnectionCount::getInstance()->cancelWait(&origin_waiter);
+      if (origin_queue_timeout != NULL) {
+        origin_queue_timeout->cancel();
+        origin_queue_timeout = NULL;
+      }
+    }
+
     cache_sm.end_both();
     if (second_cache_sm)
       second_cache_sm->end_both();
@@ -6714,6 +6867,16 @@ HttpSM::update_stats()
 
   HttpTransact::client_result_stat(&t_state, total_time, request_process_time);
 
+  HTTP_HISTOGRAM_ADD(http_total_time_hist, ink_hrtime_to_usec(total_time));
+  if (milestones[TS_MILESTONE_UA_BEGIN_WRITE] != 0) {
+    HTTP_HISTOGRAM_ADD(http_ttfb_hist, ink_hrtime_to_usec(milestones.elapsed(TS_MILESTONE_SM_START, TS_MILESTONE_UA_BEGIN_WRITE)));
+  }
+  if (t_state.http_config_param->latency_histograms) {
+    HttpLatencyStats::getInstance()->record(t_state.http_config_param->latency_histograms,
+                                            t_state.http_config_param->latency_histograms_max_entries, t_state.url_map.getMapping(),
+                                            origin_latency_stats, milestones);
+  }
+
   ink_hrtime ua_write_time;
   if (milestones[TS_MILESTONE_UA_BEGIN_WRITE] != 0 && milestones[TS_MILESTONE_UA_CLOSE] != 0) {
     ua_write_time = milestones.elapsed(TS_MILESTONE_UA_BEGIN_WRITE, TS_MILESTONE_UA_CLOSE);
@@ -41,6 +41,7 @@
 #include "InkAPIInternal.h"
 #include "StatSystem.h"
 #include "HttpClientSession.h"
+#include "HttpConnectionCount.h"
 #include "HdrUtils.h"
 //#include "AuthHttpAdapter.h"
 
@@ -72,6 +73,7 @@ static size_t const HTTP_HEADER_BUFFER_SIZE_INDEX = CLIENT_CONNECTION_FIRST_READ
 static size_t const HTTP_SERVER_RESP_HDR_BUFFER_INDEX = BUFFER_SIZE_INDEX_8K;
 
 class HttpServerSession;
+struct HttpLatencyEntry;
 class AuthHttpAdapter;
 
 class HttpSM;
@@ -223,6 +225,10 @@ public:
   void calculate_output_cl(int64_t, int64_t);
   void parse_range_and_compare(MIMEField *, int64_t);
 
+  // Called by transact. Is the single byte range the client asked for
+  // stored in the partially cached object being read?
+  bool is_partial_range_cached();
+
   // Called by transact to prevent reset problems
   //  failed PUSH requests
   void set_ua_half_close_flag();
@@ -315,6 +321,9 @@ protected:
   HttpVCTableEntry *server_entry;
   HttpServerSession *server_session;
 
+  // Latency histograms of the origin of the last server session, or NULL
+  HttpLatencyEntry *origin_latency_stats;
+
   /* Because we don't want to take a session from a shared pool if we know that it will be private,
    * but we cannot set it to private until we have an attached server session.
    * So we use this variable to indicate that
@@ -322,6 +331,12 @@ protected:
    */
   bool will_be_private_ss;
   int shared_session_retries;
+
+  // Waiting for a connection to an origin at its origin_max_connections.
+  OriginWaiter origin_waiter;
+  Event *origin_queue_timeout;
+  ink_hrtime origin_queue_deadline;
+  bool origin_queue_woken;
   IOBufferReader *server_buffer_reader;
   void remove_server_entry();
 
@@ -411,6 +426,8 @@ protected:
   void do_hostdb_reverse_lookup();
   void do_cache_lookup_and_read();
   void do_http_server_open(bool raw = false);
+  bool origin_queue_expired(void *data);
+  void origin_queue_resume(bool raw);
   void do_setup_post_tunnel(HttpVC_t to_vc_type);
   void do_cache_prepare_write();
   void do_cache_prepare_write_transform();
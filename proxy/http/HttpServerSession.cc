@@ -147,6 +147,7 @@ HttpServerSession::do_io_close(int alerrno)
     } else {
       Error("[%" PRId64 "] number of connections should be greater than zero: %u", con_id, connection_count->getCount(server_ip));
     }
+    connection_count->wakeup(server_ip);
   }
 
   if (to_parent_proxy) {
@@ -178,6 +179,13 @@ HttpServerSession::release()
     return;
   }
 
+  // Once in the pool the session may be taken and closed by another thread.
+  // A session in a per thread pool can only be reused from this thread.
+  bool limited    = enable_origin_connection_limiting;
+  EThread *reuser = TS_SERVER_SESSION_SHARING_POOL_THREAD == sharing_pool ? this_ethread() : NULL;
+  IpEndpoint addr;
+  ats_ip_copy(&addr, &server_ip);
+
   HSMresult_t r = httpSessionManager.release_session(this);
 
   if (r == HSM_RETRY) {
@@ -190,5 +198,9 @@ HttpServerSession::release()
     //    manager and it will manage it
     // (Note: should never get HSM_NOT_FOUND here)
     ink_assert(r == HSM_DONE);
+    // Hand it to a transaction waiting for a connection to this origin
+    if (limited) {
+      ConnectionCount::getInstance()->wakeup(addr, reuser);
+    }
   }
 }
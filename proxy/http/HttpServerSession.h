@@ -50,6 +50,7 @@
 #include "HttpProxyAPIEnums.h"
 
 class HttpSM;
+struct HttpLatencyEntry;
 class MIOBuffer;
 class IOBufferReader;
 
@@ -72,7 +73,7 @@ public:
     : VConnection(NULL), hostname_hash(), con_id(0), transact_count(0), state(HSS_INIT), to_parent_proxy(false),
       server_trans_stat(0), private_session(false), sharing_match(TS_SERVER_SESSION_SHARING_MATCH_BOTH),
       sharing_pool(TS_SERVER_SESSION_SHARING_POOL_GLOBAL), enable_origin_connection_limiting(false), connection_count(NULL),
-      read_buffer(NULL), server_vc(NULL), magic(HTTP_SS_MAGIC_DEAD), buf_reader(NULL)
+      last_response_bytes(0), latency_stats(NULL), read_buffer(NULL), server_vc(NULL), magic(HTTP_SS_MAGIC_DEAD), buf_reader(NULL)
   {
     ink_zero(server_ip);
   }
@@ -154,6 +155,14 @@ public:
   bool enable_origin_connection_limiting;
   ConnectionCount *connection_count;
 
+  // Bytes read for the last response on this session, the
+  //   first guess at the buffer size for the next one
+  int64_t last_response_bytes;
+
+  // Latency histograms of the origin, looked up by the first
+  //   transaction on the session, see HttpLatencyStats
+  HttpLatencyEntry *latency_stats;
+
   // The ServerSession owns the following buffer which use
   //   for parsing the headers.  The server session needs to
   //   own the buffer so we can go from a keep-alive state
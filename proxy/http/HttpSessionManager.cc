@@ -35,6 +35,7 @@
 #include "HttpServerSession.h"
 #include "HttpSM.h"
 #include "HttpDebugNames.h"
+#include "ts/Tokenizer.h"
 
 // Initialize a thread to handle HTTP session management
 void
@@ -108,6 +109,19 @@ ServerSessionPool::acquireSession(sockaddr const *addr, INK_MD5 const &hostname_
   return zret;
 }
 
+int
+ServerSessionPool::countSessions(sockaddr const *addr, INK_MD5 const &host_hash)
+{
+  int count = 0;
+
+  for (IPHashTable::Location loc = m_ip_pool.find(addr); loc; ++loc) {
+    if (loc->hostname_hash == host_hash) {
+      ++count;
+    }
+  }
+  return count;
+}
+
 void
 ServerSessionPool::releaseSession(HttpServerSession *ss)
 {
@@ -224,6 +238,262 @@ HttpSessionManager::init()
   m_g_pool = new ServerSessionPool;
 }
 
+int
+HttpSessionManager::count_idle_sessions(sockaddr const *addr, INK_MD5 const &host_hash, TSServerSessionSharingPoolType pool_type)
+{
+  EThread *ethread = this_ethread();
+  int count = 0;
+
+  if (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) {
+    for (int i = 0; i < eventProcessor.n_threads_for_type[ET_NET]; ++i) {
+      ServerSessionPool *pool = eventProcessor.eventthread[ET_NET][i]->server_session_pool;
+      MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
+      if (!lock.is_locked()) {
+        return -1;
+      }
+      count += pool->countSessions(addr, host_hash);
+    }
+  } else {
+    MUTEX_TRY_LOCK(lock, m_g_pool->mutex, ethread);
+    if (!lock.is_locked()) {
+      return -1;
+    }
+    count = m_g_pool->countSessions(addr, host_hash);
+  }
+  return count;
+}
+
+/** Keeps a number of TLS connections to an origin server idle in the session pools.
+
+    Every second the origin name is resolved, the idle sessions to its address are counted and the
+    missing connections are opened. A connection is released to the pools once its handshake is
+    done, so the transaction that picks it up sends its request right away.
+*/
+class HttpPrewarmOrigin : public Continuation
+{
+public:
+  HttpPrewarmOrigin(const char *host, int port, int connections);
+
+  int mainEvent(int event, void *data);
+
+  ats_scoped_str host;
+  int port;
+  int connections; ///< Idle connections to keep open.
+  INK_MD5 host_hash;
+  volatile int pending; ///< Connections opening.
+  Action *lookup;
+  unsigned next_thread; ///< The net thread to open the next connection on.
+};
+
+/** A connection of a pre-warmed origin, until its handshake is done.
+
+    It is opened on the thread the connection is scheduled on, which is the thread whose pool the
+    session is released to with a @c thread sharing pool.
+*/
+class HttpPrewarmConnection : public Continuation
+{
+public:
+  HttpPrewarmConnection(HttpPrewarmOrigin *o, sockaddr const *addr, NetVCOptions const &opt)
+    : Continuation(new_ProxyMutex()), origin(o), vc(NULL), buffer(NULL), timeout(0)
+  {
+    options = opt;
+    ats_ip_copy(&server_ip, addr);
+    SET_HANDLER(&HttpPrewarmConnection::mainEvent);
+  }
+
+  int mainEvent(int event, void *data);
+
+private:
+  void done();
+
+  HttpPrewarmOrigin *origin;
+  IpEndpoint server_ip;
+  NetVCOptions options;
+  NetVConnection *vc;
+  MIOBuffer *buffer;
+  ink_hrtime timeout;
+};
+
+HttpPrewarmOrigin::HttpPrewarmOrigin(const char *h, int p, int n)
+  : Continuation(new_ProxyMutex()), host(ats_strdup(h)), port(p), connections(n), pending(0), lookup(NULL), next_thread(0)
+{
+  ink_code_md5((unsigned char *)h, strlen(h), (unsigned char *)&host_hash);
+  SET_HANDLER(&HttpPrewarmOrigin::mainEvent);
+}
+
+int
+HttpPrewarmOrigin::mainEvent(int event, void *data)
+{
+  switch (event) {
+  case EVENT_INTERVAL:
+    if (lookup == NULL) {
+      Action *action = hostDBProcessor.getbyname_re(this, host, 0);
+      if (action != ACTION_RESULT_DONE) {
+        lookup = action;
+      }
+    }
+    return EVENT_DONE;
+
+  case EVENT_HOST_DB_LOOKUP:
+    lookup = NULL;
+    break;
+
+  default:
+    ink_release_assert(!"unexpected event");
+    return EVENT_DONE;
+  }
+
+  HostDBInfo *r = static_cast<HostDBInfo *>(data);
+  if (r == NULL) {
+    Debug("http_prewarm", "unable to resolve %s", host.get());
+    return EVENT_DONE;
+  }
+
+  // Only the first address of a round robin record is kept warm.
+  IpEndpoint addr;
+  ats_ip_copy(&addr, r->is_rr() ? r->rr()->info[0].ip() : r->ip());
+  ats_ip_port_cast(&addr) = htons(port);
+
+  HttpConfigParams *params = HttpConfig::acquire();
+  TSServerSessionSharingPoolType pool_type = static_cast<TSServerSessionSharingPoolType>(params->server_session_sharing_pool);
+  int idle = httpSessionManager.count_idle_sessions(&addr.sa, host_hash, pool_type);
+  int missing = idle < 0 ? 0 : connections - idle - pending;
+
+  if (missing > 0 && params->oride.origin_max_connections > 0) {
+    int room = params->oride.origin_max_connections - ConnectionCount::getInstance()->getCount(addr) - pending;
+    missing = std::min(missing, std::max(room, 0));
+  }
+
+  NetVCOptions opt;
+
+  opt.f_blocking_connect = false;
+  opt.set_sock_param(params->oride.sock_recv_buffer_size_out, params->oride.sock_send_buffer_size_out,
+                     params->oride.sock_option_flag_out, params->oride.sock_packet_mark_out, params->oride.sock_packet_tos_out);
+  opt.ip_family = addr.sa.sa_family;
+  opt.set_sni_servername(host, strlen(host));
+
+  // Idle sessions are counted over every pool, so the connections are opened round robin over the
+  // net threads to keep the thread pools evenly stocked.
+  for (int i = 0; i < missing; ++i) {
+    EThread *thread = eventProcessor.eventthread[ET_NET][next_thread++ % eventProcessor.n_threads_for_type[ET_NET]];
+
+    ink_atomic_increment(&pending, 1);
+    thread->schedule_imm(new HttpPrewarmConnection(this, &addr.sa, opt));
+  }
+
+  if (missing > 0) {
+    Debug("http_prewarm", "opening %d connections to %s, %d idle", missing, host.get(), idle);
+  }
+  HttpConfig::release(params);
+  return EVENT_DONE;
+}
+
+int
+HttpPrewarmConnection::mainEvent(int event, void *data)
+{
+  switch (event) {
+  case EVENT_IMMEDIATE:
+    sslNetProcessor.connect_re(this, &server_ip.sa, &options);
+    return EVENT_DONE;
+
+  case NET_EVENT_OPEN: {
+    HttpConfigParams *params = HttpConfig::acquire();
+
+    vc = static_cast<NetVConnection *>(data);
+    timeout = HRTIME_SECONDS(params->oride.keep_alive_no_activity_timeout_out);
+    vc->set_inactivity_timeout(HRTIME_SECONDS(params->oride.connect_attempts_timeout));
+    HttpConfig::release(params);
+
+    // Nothing is ever sent or read, the zero length read and the empty write only drive the
+    // handshake. Whichever side finishes it signals.
+    buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_128);
+    vc->do_io_read(this, 0, buffer);
+    vc->do_io_write(this, 1, buffer->alloc_reader());
+    return EVENT_DONE;
+  }
+
+  case VC_EVENT_READ_COMPLETE:
+  case VC_EVENT_WRITE_READY:
+    break;
+
+  case NET_EVENT_OPEN_FAILED:
+    Debug("http_prewarm", "unable to connect to %s", origin->host.get());
+    done();
+    return EVENT_DONE;
+
+  default:
+    Debug("http_prewarm", "handshake with %s failed: %s", origin->host.get(), HttpDebugNames::get_event_name(event));
+    vc->do_io_close();
+    done();
+    return EVENT_DONE;
+  }
+
+  HttpConfigParams *params = HttpConfig::acquire();
+  TSServerSessionSharingPoolType pool_type = static_cast<TSServerSessionSharingPoolType>(params->server_session_sharing_pool);
+  HttpServerSession *session = (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) ?
+                                 THREAD_ALLOC_INIT(httpServerSessionAllocator, this_ethread()) :
+                                 httpServerSessionAllocator.alloc();
+
+  session->sharing_pool = pool_type;
+  session->sharing_match = static_cast<TSServerSessionSharingMatchType>(params->oride.server_session_sharing_match);
+  if (params->oride.origin_max_connections > 0 || params->origin_min_keep_alive_connections > 0) {
+    session->enable_origin_connection_limiting = true;
+  }
+  HttpConfig::release(params);
+
+  ats_ip_copy(&session->server_ip, &server_ip);
+  session->attach_hostname(origin->host);
+  session->new_connection(vc);
+  vc->set_inactivity_timeout(timeout);
+  Debug("http_prewarm", "[%" PRId64 "] connection to %s ready", session->con_id, origin->host.get());
+  // The pool takes over both sides of the connection, or closes it.
+  session->release();
+  done();
+  return EVENT_DONE;
+}
+
+void
+HttpPrewarmConnection::done()
+{
+  if (buffer) {
+    free_MIOBuffer(buffer);
+  }
+  ink_atomic_increment(&origin->pending, -1);
+  delete this;
+}
+
+void
+HttpSessionManager::start_prewarm()
+{
+  char *origins = REC_ConfigReadString("proxy.config.http.server_prewarm.origins");
+  int connections = REC_ConfigReadInteger("proxy.config.http.server_prewarm.connections");
+
+  if (origins && connections > 0) {
+    Tokenizer tok(" \t,;");
+    tok_iter_state state;
+
+    tok.Initialize(origins);
+    for (const char *origin = tok.iterFirst(&state); origin; origin = tok.iterNext(&state)) {
+      ats_scoped_str host(ats_strdup(origin));
+      char *colon = strrchr(host, ':');
+      int port = 443;
+
+      if (colon) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+      }
+      if (*host == '\0' || port <= 0 || port > 65535) {
+        Warning("invalid origin '%s' in proxy.config.http.server_prewarm.origins", origin);
+        continue;
+      }
+
+      Debug("http_prewarm", "keeping %d connections open to %s:%d", connections, host.get(), port);
+      eventProcessor.schedule_every(new HttpPrewarmOrigin(host, port, connections), HRTIME_SECONDS(1), ET_NET);
+    }
+  }
+  ats_free(origins);
+}
+
 // TODO: Should this really purge all keep-alive sessions?
 // Does this make any sense, since we always do the global pool and not the per thread?
 void
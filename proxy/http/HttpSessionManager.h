@@ -142,6 +142,9 @@ public:
    */
   void releaseSession(HttpServerSession *ss);
 
+  /// Count the sessions to @a addr for @a host_hash.
+  int countSessions(sockaddr const *addr, INK_MD5 const &host_hash);
+
   /// Close all sessions and then clear the table.
   void purge();
 
@@ -162,7 +165,14 @@ public:
                               HttpSM *sm);
   HSMresult_t release_session(HttpServerSession *to_release);
   void purge_keepalives();
+  /** Count the idle sessions to @a addr for @a host_hash in the pools of @a pool_type.
+
+      @return The count or -1 if a pool was locked.
+  */
+  int count_idle_sessions(sockaddr const *addr, INK_MD5 const &host_hash, TSServerSessionSharingPoolType pool_type);
   void init();
+  /// Start keeping connections open to the origins in proxy.config.http.server_prewarm.origins.
+  void start_prewarm();
   int main_handler(int event, void *data);
 
 private:
@@ -0,0 +1,348 @@
+/** @file
+
+  Invalidation of cached objects by surrogate key
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HttpSurrogateKeys.h"
+#include "HttpConfig.h"
+#include "HttpTransact.h"
+#include "P_EventSystem.h"
+#include "P_RecProcess.h"
+#include "ts/I_Layout.h"
+#include "ts/ParseRules.h"
+#include "ts/HashFNV.h"
+
+#define SURROGATE_KEYS_FILE "surrogate_keys.db"
+#define SURROGATE_KEYS_SYNC_INTERVAL HRTIME_SECONDS(5)
+
+// Slot::key of a slot that was never used, ends a probe
+#define SLOT_EMPTY 0
+// Slot::key of a slot whose key was forgotten, a probe goes on past it
+#define SLOT_REMOVED 1
+// end of the list by purge time
+#define AGE_NONE ((unsigned)-1)
+
+HttpSurrogateKeys HttpSurrogateKeys::_surrogateKeys;
+
+struct SurrogateKeysSync : public Continuation {
+  SurrogateKeysSync() : Continuation(new_ProxyMutex()) { SET_HANDLER(&SurrogateKeysSync::mainEvent); }
+
+  int
+  mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    HttpSurrogateKeys::getInstance()->sync();
+    return EVENT_CONT;
+  }
+};
+
+// Next key of a space or comma separated list, NULL at the end.
+static const char *
+next_key(const char *&s, const char *end, int *len)
+{
+  const char *key;
+
+  while (s < end && (ParseRules::is_space(*s) || *s == ','))
+    s++;
+  key = s;
+  while (s < end && !ParseRules::is_space(*s) && *s != ',')
+    s++;
+  *len = s - key;
+  return *len ? key : NULL;
+}
+
+static uint64_t
+key_hash(const char *key, int len)
+{
+  ATSHash64FNV1a hash;
+
+  hash.update(key, len);
+  hash.final();
+  return hash.get() > SLOT_REMOVED ? hash.get() : hash.get() + 2;
+}
+
+void
+HttpSurrogateKeys::start()
+{
+  ats_scoped_str rundir(RecConfigReadRuntimeDir());
+  unsigned nslots = 16;
+
+  _header = REC_ConfigReadString("proxy.config.http.cache.surrogate_key_header");
+  if (!_header || !*_header) {
+    ats_free(_header);
+    _header = NULL;
+    return;
+  }
+  _header_len = strlen(_header);
+  _max_entries = REC_ConfigReadInteger("proxy.config.http.cache.surrogate_key_max_entries");
+  _max_age = REC_ConfigReadInteger("proxy.config.http.cache.surrogate_key_max_age");
+
+  // at most half full, so probes stay short
+  while (nslots < 2 * (unsigned)_max_entries)
+    nslots <<= 1;
+  _slots = (Slot *)ats_calloc(nslots, sizeof(Slot));
+  _ages = (Age *)ats_malloc(nslots * sizeof(Age));
+  _snapshot = (Slot *)ats_malloc(_max_entries * sizeof(Slot));
+  _mask = nslots - 1;
+  _oldest = _newest = AGE_NONE;
+
+  _path = Layout::relative_to(rundir, SURROGATE_KEYS_FILE);
+  load();
+  eventProcessor.schedule_every(new SurrogateKeysSync, SURROGATE_KEYS_SYNC_INTERVAL, ET_TASK);
+}
+
+void
+HttpSurrogateKeys::load()
+{
+  char line[64];
+  FILE *fp = fopen(_path, "r");
+
+  if (!fp)
+    return;
+  ink_mutex_acquire(&_mutex);
+  while (fgets(line, sizeof(line), fp)) {
+    char *key, *end;
+    time_t t = strtol(line, &key, 10);
+    uint64_t hash = strtoull(key, &end, 16);
+
+    if (t > 0 && hash > SLOT_REMOVED && (*end == '\n' || *end == '\0'))
+      set(hash, t);
+  }
+  ink_mutex_release(&_mutex);
+  fclose(fp);
+  Debug("http_surrogate", "loaded %d surrogate keys from %s", _size, _path);
+}
+
+// Look a key up without the lock. A slot is only reused after its key was
+// marked removed, so if the key is still there after reading the time, the
+// time is the key's.
+time_t
+HttpSurrogateKeys::get(uint64_t key) const
+{
+  unsigned i = key & _mask;
+
+  for (unsigned n = 0; n <= _mask && _slots[i].key != SLOT_EMPTY; ++n, i = (i + 1) & _mask) {
+    if (_slots[i].key == key) {
+      time_t purged = _slots[i].purged;
+      return _slots[i].key == key ? purged : 0;
+    }
+  }
+  return 0;
+}
+
+// Put a used slot in the list by purge time. Purges come in time order, so
+// this only walks back from the newest key if the clock went back.
+void
+HttpSurrogateKeys::link(unsigned idx)
+{
+  unsigned older = _newest;
+
+  while (older != AGE_NONE && _slots[older].purged > _slots[idx].purged)
+    older = _ages[older].older;
+  _ages[idx].older = older;
+  _ages[idx].newer = older == AGE_NONE ? _oldest : _ages[older].newer;
+  if (_ages[idx].older == AGE_NONE)
+    _oldest = idx;
+  else
+    _ages[_ages[idx].older].newer = idx;
+  if (_ages[idx].newer == AGE_NONE)
+    _newest = idx;
+  else
+    _ages[_ages[idx].newer].older = idx;
+}
+
+void
+HttpSurrogateKeys::unlink(unsigned idx)
+{
+  if (_ages[idx].older == AGE_NONE)
+    _oldest = _ages[idx].newer;
+  else
+    _ages[_ages[idx].older].newer = _ages[idx].newer;
+  if (_ages[idx].newer == AGE_NONE)
+    _newest = _ages[idx].older;
+  else
+    _ages[_ages[idx].newer].older = _ages[idx].older;
+}
+
+void
+HttpSurrogateKeys::set(uint64_t key, time_t purged)
+{
+  unsigned i = key & _mask;
+
+  for (unsigned n = 0; n <= _mask && _slots[i].key != SLOT_EMPTY; ++n, i = (i + 1) & _mask) {
+    if (_slots[i].key == key) {
+      if (purged > _slots[i].purged) {
+        _slots[i].purged = purged;
+        unlink(i);
+        link(i);
+      }
+      return;
+    }
+  }
+
+  if (_size >= _max_entries) {
+    // every key kept may still cover fresh objects, sync() forgets the others
+    Debug("http_surrogate", "forgetting the surrogate key purged at %" PRId64 " to make room", (int64_t)_slots[_oldest].purged);
+    HTTP_SUM_GLOBAL_DYN_STAT(http_cache_surrogate_key_evictions_stat, 1);
+    _evicted++;
+    remove(_oldest);
+  }
+
+  for (i = key & _mask; _slots[i].key > SLOT_REMOVED; i = (i + 1) & _mask)
+    ;
+  _slots[i].purged = purged;
+  _slots[i].key = key;
+  link(i);
+  _size++;
+}
+
+void
+HttpSurrogateKeys::remove(unsigned idx)
+{
+  unlink(idx);
+  _slots[idx].key = SLOT_REMOVED;
+  _size--;
+  // removed slots just before an empty one end no probe early, empty them
+  while (_slots[idx].key == SLOT_REMOVED && _slots[(idx + 1) & _mask].key == SLOT_EMPTY) {
+    _slots[idx].key = SLOT_EMPTY;
+    idx = (idx - 1) & _mask;
+  }
+}
+
+int
+HttpSurrogateKeys::purge(const char *keys, int len)
+{
+  const char *end = keys + len, *key;
+  time_t now = ink_cluster_time();
+  int n = 0, key_len;
+
+  if (!_header)
+    return 0;
+  ink_mutex_acquire(&_mutex);
+  while ((key = next_key(keys, end, &key_len)) != NULL) {
+    Debug("http_surrogate", "purging surrogate key %.*s", key_len, key);
+    set(key_hash(key, key_len), now);
+    n++;
+  }
+  _dirty = _dirty || n > 0;
+  ink_mutex_release(&_mutex);
+
+  return n;
+}
+
+bool
+HttpSurrogateKeys::purge(HTTPHdr *request)
+{
+  MIMEField *field;
+
+  if (!_header || (field = request->field_find(_header, _header_len)) == NULL)
+    return false;
+  for (; field; field = field->m_next_dup) {
+    int len;
+    const char *value = field->value_get(&len);
+
+    purge(value, len);
+  }
+  return true;
+}
+
+bool
+HttpSurrogateKeys::is_purged(HTTPHdr *cached_response, time_t response_received_time)
+{
+  MIMEField *field;
+  bool purged = false;
+
+  if (_size == 0 || (field = cached_response->field_find(_header, _header_len)) == NULL)
+    return false;
+
+  for (; field && !purged; field = field->m_next_dup) {
+    int len, key_len;
+    const char *value = field->value_get(&len);
+    const char *end = value + len, *key;
+
+    while (!purged && (key = next_key(value, end, &key_len)) != NULL) {
+      time_t t = get(key_hash(key, key_len));
+
+      purged = t && response_received_time <= t;
+    }
+  }
+
+  return purged;
+}
+
+void
+HttpSurrogateKeys::sync()
+{
+  // no object is fresh longer than guaranteed_max_lifetime after it was received
+  time_t max_age = (time_t)HttpConfig::m_master.oride.cache_guaranteed_max_lifetime;
+  time_t oldest;
+  int n = 0, evicted;
+
+  if (_max_age > 0 && _max_age < max_age)
+    max_age = _max_age;
+  oldest = ink_cluster_time() - max_age;
+
+  ink_mutex_acquire(&_mutex);
+  while (_oldest != AGE_NONE && _slots[_oldest].purged < oldest) {
+    remove(_oldest);
+    _dirty = true;
+  }
+  evicted = _evicted;
+  _evicted = 0;
+  if (!_dirty) {
+    ink_mutex_release(&_mutex);
+    return;
+  }
+  // the file is written from a copy, purges don't wait for it
+  for (unsigned i = _oldest; i != AGE_NONE; i = _ages[i].newer) {
+    _snapshot[n].key = _slots[i].key;
+    _snapshot[n].purged = _slots[i].purged;
+    n++;
+  }
+  _dirty = false;
+  ink_mutex_release(&_mutex);
+
+  if (evicted) {
+    Warning("%d surrogate key purges were forgotten to make room, objects tagged only with them may be served again, "
+            "raise proxy.config.http.cache.surrogate_key_max_entries",
+            evicted);
+  }
+
+  // write a copy and rename it, so a crash leaves the previous file
+  char tmp_path[PATH_NAME_MAX];
+  FILE *fp;
+  bool ok = false;
+
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", _path);
+  if ((fp = fopen(tmp_path, "w")) != NULL) {
+    ok = true;
+    for (int i = 0; ok && i < n; ++i) {
+      ok = fprintf(fp, "%" PRId64 " %016" PRIx64 "\n", (int64_t)_snapshot[i].purged, (uint64_t)_snapshot[i].key) > 0;
+    }
+    ok = fclose(fp) == 0 && ok;
+  }
+  if (!ok || rename(tmp_path, _path) != 0) {
+    Warning("unable to save surrogate keys to %s: %s", _path, strerror(errno));
+    unlink(tmp_path);
+    ink_mutex_acquire(&_mutex);
+    _dirty = true; // try again next time
+    ink_mutex_release(&_mutex);
+  }
+}
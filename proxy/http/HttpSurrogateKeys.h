@@ -0,0 +1,128 @@
+/** @file
+
+  Invalidation of cached objects by surrogate key
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "ts/ink_platform.h"
+#include "ts/ink_mutex.h"
+#include "HTTP.h"
+
+#ifndef _HTTP_SURROGATE_KEYS_H_
+#define _HTTP_SURROGATE_KEYS_H_
+
+/**
+ * Singleton class keeping the time each surrogate key was last purged.
+ *
+ * Origin servers tag responses with a space separated list of keys in the
+ * header named by proxy.config.http.cache.surrogate_key_header, which is
+ * stored in the cache with the rest of the response. Purging a key records
+ * the current time and any cached response carrying the key that was received
+ * no later than that is stale, so one purge invalidates every object with the
+ * key without finding or removing them.
+ *
+ * Keys are kept by their 64 bit hash in a table of fixed size, probed without
+ * the lock so that checking cache hits never waits for purges or saving. A
+ * list through the slots orders the keys by purge time. At most
+ * proxy.config.http.cache.surrogate_key_max_entries keys are kept, the one at
+ * the head of the list, purged longest ago, makes room for a new one. A key
+ * is forgotten once no object it covers can still be fresh, after
+ * proxy.config.http.cache.guaranteed_max_lifetime, or earlier if
+ * proxy.config.http.cache.surrogate_key_max_age says so.
+ *
+ * Purge times are written to surrogate_keys.db in the local state directory
+ * every few seconds, oldest first, and read back on startup.
+ */
+class HttpSurrogateKeys
+{
+public:
+  static HttpSurrogateKeys *
+  getInstance()
+  {
+    return &_surrogateKeys;
+  }
+
+  /// Read the configuration and the saved keys, start saving them periodically.
+  void start();
+
+  /**
+   * Purge the keys of a space or comma separated list.
+   * @return The number of keys purged
+   */
+  int purge(const char *keys, int len);
+
+  /**
+   * Purge the keys in the surrogate key header of a PURGE request.
+   * @return @c false if the request has no surrogate key header
+   */
+  bool purge(HTTPHdr *request);
+
+  /// Whether a key of a cached response was purged after it was received.
+  bool is_purged(HTTPHdr *cached_response, time_t response_received_time);
+
+  /// Forget old keys and save the rest if they changed.
+  void sync();
+
+private:
+  struct Slot {
+    volatile uint64_t key; ///< hash of the key, or one of the SLOT_ values
+    volatile time_t purged;
+  };
+
+  /// Links of a used slot in the list by purge time, only used with @a _mutex held.
+  struct Age {
+    unsigned older;
+    unsigned newer;
+  };
+
+  HttpSurrogateKeys()
+    : _header(NULL), _header_len(0), _path(NULL), _slots(NULL), _ages(NULL), _snapshot(NULL), _mask(0), _oldest(0), _newest(0),
+      _max_entries(0), _max_age(0), _size(0), _evicted(0), _dirty(false)
+  {
+    ink_mutex_init(&_mutex, "HttpSurrogateKeysMutex");
+  }
+  HttpSurrogateKeys(const HttpSurrogateKeys & /* x ATS_UNUSED */) {}
+
+  void load();
+  void set(uint64_t key, time_t purged);
+  time_t get(uint64_t key) const;
+  void remove(unsigned idx);
+  void link(unsigned idx);
+  void unlink(unsigned idx);
+
+  static HttpSurrogateKeys _surrogateKeys;
+  char *_header;
+  int _header_len;
+  char *_path;
+  Slot *_slots;     ///< open addressing with linear probing, written with @a _mutex held
+  Age *_ages;       ///< purge time order of @a _slots
+  Slot *_snapshot;  ///< the keys oldest first, saved by sync() without the lock
+  unsigned _mask;   ///< number of slots - 1
+  unsigned _oldest; ///< head of the list by purge time
+  unsigned _newest; ///< tail of the list by purge time
+  int _max_entries;
+  time_t _max_age;
+  volatile int _size; // lets responses be checked at once while nothing was purged
+  int _evicted;       ///< keys dropped to make room since the last sync()
+  bool _dirty;
+  ink_mutex _mutex;
+};
+
+#endif
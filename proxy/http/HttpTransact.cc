@@ -45,6 +45,7 @@
 #include "HttpBodyFactory.h"
 #include "StatPages.h"
 #include "HttpClientSession.h"
+#include "HttpSurrogateKeys.h"
 #include "I_Machine.h"
 
 static char range_type[] = "multipart/byteranges; boundary=RANGE_SEPARATOR";
@@ -1786,7 +1787,8 @@ HttpTransact::OSDNSLookup(State *s)
       // Access Control is called after DNS response
     } else {
       if ((s->cache_info.action == CACHE_DO_NO_ACTION) &&
-          (((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !s->txn_conf->cache_range_write) ||
+          (((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !s->txn_conf->cache_range_write &&
+             !is_request_partially_cacheable(s, &s->hdr_info.client_request)) ||
             s->range_setup == RANGE_NOT_SATISFIABLE || s->range_setup == RANGE_NOT_HANDLED))) {
         TRANSACT_RETURN(SM_ACTION_API_OS_DNS, HandleCacheOpenReadMiss);
       } else if (!s->txn_conf->cache_http || s->cache_lookup_result == HttpTransact::CACHE_LOOKUP_SKIPPED) {
@@ -1873,6 +1875,16 @@ HttpTransact::HandleFiltering(State *s)
 void
 HttpTransact::DecideCacheLookup(State *s)
 {
+  // A PURGE with surrogate keys invalidates every object tagged with one of
+  // them rather than the object at the URL.
+  if (s->method == HTTP_WKSIDX_PURGE && HttpSurrogateKeys::getInstance()->purge(&s->hdr_info.client_request)) {
+    DebugTxn("http_trans", "[DecideCacheLookup] PURGE by surrogate key");
+    s->cache_info.action = CACHE_DO_NO_ACTION;
+    s->hdr_info.trust_response_cl = true;
+    build_response(s, &s->hdr_info.client_response, s->client_info.http_version, HTTP_STATUS_OK);
+    TRANSACT_RETURN(SM_ACTION_INTERNAL_CACHE_NOOP, NULL);
+  }
+
   // Check if a client request is lookupable.
   if (s->redirect_info.redirect_in_process || s->cop_test_page) {
     // for redirect, we want to skip cache lookup and write into
@@ -2263,6 +2275,28 @@ HttpTransact::issue_revalidate(State *s)
     return;
   }
 
+  // A partially cached object is never revalidated as a whole. A Range
+  // request asks for the range if the stored validator still matches, the
+  // 206 fills in the object. Anything else replaces it.
+  if (s->cache_info.object_read && s->cache_info.object_read->is_partial() && s->cache_info.action == CACHE_PREPARE_TO_UPDATE) {
+    HTTPHdr *server_request = &s->hdr_info.server_request;
+
+    server_request->field_delete(MIME_FIELD_IF_MODIFIED_SINCE, MIME_LEN_IF_MODIFIED_SINCE);
+    server_request->field_delete(MIME_FIELD_IF_NONE_MATCH, MIME_LEN_IF_NONE_MATCH);
+    if (is_request_partially_cacheable(s, &s->hdr_info.client_request)) {
+      int length;
+      const char *validator = c_resp->value_get(MIME_FIELD_ETAG, MIME_LEN_ETAG, &length);
+
+      if (!validator || (length >= 2 && validator[0] == 'W' && validator[1] == '/'))
+        validator = c_resp->value_get(MIME_FIELD_LAST_MODIFIED, MIME_LEN_LAST_MODIFIED, &length);
+      if (validator)
+        server_request->value_set(MIME_FIELD_IF_RANGE, MIME_LEN_IF_RANGE, validator, length);
+    }
+    if (!s->cop_test_page)
+      DUMP_HEADER("http_hdrs", server_request, s->state_machine_id, "Proxy's Request (Partial Fill)");
+    return;
+  }
+
   // if the document is cached, just send a conditional request to the server
 
   // So the request does not have preconditions. It can, however
@@ -3078,7 +3112,8 @@ HttpTransact::HandleCacheOpenReadMiss(State *s)
   // We must, however, not cache the responses to these requests.
   if (does_method_require_cache_copy_deletion(s->http_config_param, s->method) && s->api_req_cacheable == false) {
     s->cache_info.action = CACHE_DO_NO_ACTION;
-  } else if ((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !s->txn_conf->cache_range_write) ||
+  } else if ((s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE) && !s->txn_conf->cache_range_write &&
+              !is_request_partially_cacheable(s, &s->hdr_info.client_request)) ||
              does_method_effect_cache(s->method) == false || s->range_setup == RANGE_NOT_SATISFIABLE ||
              s->range_setup == RANGE_NOT_HANDLED) {
     s->cache_info.action = CACHE_DO_NO_ACTION;
@@ -4122,6 +4157,11 @@ HttpTransact::handle_cache_operation_on_forward_server_response(State *s)
   const char *warn_text = NULL;
   bool cacheable = false;
 
+  s->partial_write_offset = -1;
+  if (s->hdr_info.server_response.status_get() == HTTP_STATUS_PARTIAL_CONTENT &&
+      is_request_partially_cacheable(s, &s->hdr_info.client_request)) {
+    is_partial_response_cacheable(s);
+  }
   cacheable = is_response_cacheable(s, &s->hdr_info.client_request, &s->hdr_info.server_response);
   DebugTxn("http_trans", "[hcoofsr] response %s cacheable", cacheable ? "is" : "is not");
 
@@ -4378,6 +4418,10 @@ HttpTransact::handle_cache_operation_on_forward_server_response(State *s)
         s->cache_info.action = CACHE_DO_NO_ACTION;
       } else if (s->method == HTTP_WKSIDX_HEAD) {
         s->cache_info.action = CACHE_DO_NO_ACTION;
+      } else if (!cacheProcessor.admit(s->state_machine->get_cache_sm().get_cache_key(),
+                                       s->hdr_info.server_response.get_content_length())) {
+        DebugTxn("http_trans", "[hcoofsr] not requested often enough, not written to cache");
+        s->cache_info.action = CACHE_DO_NO_ACTION;
       } else {
         s->cache_info.action = CACHE_DO_WRITE;
       }
@@ -4503,6 +4547,19 @@ HttpTransact::handle_cache_operation_on_forward_server_response(State *s)
 
   if ((s->cache_info.action == CACHE_DO_WRITE) || (s->cache_info.action == CACHE_DO_REPLACE)) {
     set_headers_for_cache_write(s, &s->cache_info.object_store, &s->hdr_info.server_request, &s->hdr_info.server_response);
+    if (s->partial_write_offset >= 0) {
+      // the object is stored as the complete response it is part of
+      HTTPHdr *cached_response = s->cache_info.object_store.response_get();
+      const char *reason = http_hdr_reason_lookup(HTTP_STATUS_OK);
+
+      cached_response->status_set(HTTP_STATUS_OK);
+      cached_response->reason_set(reason, strlen(reason));
+      cached_response->field_delete(MIME_FIELD_CONTENT_RANGE, MIME_LEN_CONTENT_RANGE);
+      cached_response->set_content_length(s->partial_write_size);
+      s->cache_info.object_store.set_partial(true);
+      if (s->cache_info.action == CACHE_DO_REPLACE)
+        s->cache_info.object_store.copy_frag_offsets_from(s->cache_info.object_read);
+    }
   }
   // 304, 412, and 416 responses are handled here
   if ((client_response_code == HTTP_STATUS_NOT_MODIFIED) || (client_response_code == HTTP_STATUS_PRECONDITION_FAILED)) {
@@ -5829,6 +5886,13 @@ HttpTransact::is_cache_response_returnable(State *s)
     SET_VIA_STRING(VIA_DETAIL_CACHE_LOOKUP, VIA_DETAIL_MISS_COOKIE);
     return false;
   }
+  // Only the stored ranges of a partially cached object can be served
+  if (s->cache_info.object_read->is_partial() && s->method != HTTP_WKSIDX_HEAD &&
+      !(is_request_partially_cacheable(s, &s->hdr_info.client_request) && s->state_machine->is_partial_range_cached())) {
+    SET_VIA_STRING(VIA_CACHE_RESULT, VIA_IN_CACHE_NOT_ACCEPTABLE);
+    SET_VIA_STRING(VIA_DETAIL_CACHE_LOOKUP, VIA_DETAIL_MISS_NOT_CACHED);
+    return false;
+  }
 
   return true;
 }
@@ -6195,8 +6259,10 @@ HttpTransact::is_response_cacheable(State *s, HTTPHdr *request, HTTPHdr *respons
       }
     }
   }
-  // do not cache partial content - Range response
-  if (response_code == HTTP_STATUS_PARTIAL_CONTENT || response_code == HTTP_STATUS_RANGE_NOT_SATISFIABLE) {
+  // do not cache partial content - Range response, unless it is part of a
+  // partially cached object
+  if ((response_code == HTTP_STATUS_PARTIAL_CONTENT && s->partial_write_offset < 0) ||
+      response_code == HTTP_STATUS_RANGE_NOT_SATISFIABLE) {
     DebugTxn("http_trans", "[is_response_cacheable] "
                            "response code %d - don't cache",
              response_code);
@@ -7311,6 +7377,11 @@ HttpTransact::what_is_document_freshness(State *s, HTTPHdr *client_request, HTTP
     }
   }
 
+  if (HttpSurrogateKeys::getInstance()->is_purged(cached_obj_response, s->response_received_time)) {
+    DebugTxn("http_match", "[what_is_document_freshness] document stale due to purged surrogate key");
+    return FRESHNESS_STALE;
+  }
+
   //////////////////////////////////////////////////////
   // If config file has a ttl-in-cache field set,     //
   // it has priority over any other http headers and  //
@@ -7708,6 +7779,76 @@ HttpTransact::is_request_likely_cacheable(State *s, HTTPHdr *request)
   return false;
 }
 
+// return true if the given Range request can be served from, and its 206
+// response stored in, a partially cached object
+bool
+HttpTransact::is_request_partially_cacheable(State *s, HTTPHdr *request)
+{
+  return s->http_config_param->cache_range_partial && s->method == HTTP_WKSIDX_GET && request->presence(MIME_PRESENCE_RANGE) &&
+         !is_request_conditional(request) && request->version_get() == HTTPVersion(1, 1) && !s->api_server_response_no_store;
+}
+
+// Check that a 206 response can be stored as a range of the object, the
+// Content-Range must give the object size and a strong validator is needed
+// to tell the ranges of different versions apart. A range filled in to a
+// partially cached object must come from the same version. On success the
+// position of the range is set in the state.
+bool
+HttpTransact::is_partial_response_cacheable(State *s)
+{
+  HTTPHdr *response = &s->hdr_info.server_response;
+  MIMEField *field = response->field_find(MIME_FIELD_CONTENT_RANGE, MIME_LEN_CONTENT_RANGE);
+  int64_t first, last, size;
+  char buf[64];
+  const char *value, *etag;
+  int length, etag_len;
+
+  if (!field || field->has_dups())
+    return false;
+  value = field->value_get(&length);
+  if (length <= 0 || length >= (int)sizeof(buf))
+    return false;
+  memcpy(buf, value, length);
+  buf[length] = '\0';
+  if (sscanf(buf, "bytes %" SCNd64 "-%" SCNd64 "/%" SCNd64, &first, &last, &size) != 3 || first < 0 || first > last ||
+      last >= size) {
+    DebugTxn("http_trans", "[is_partial_response_cacheable] no complete Content-Range: %s", buf);
+    return false;
+  }
+  if (response->presence(MIME_PRESENCE_CONTENT_LENGTH) && response->get_content_length() != last - first + 1)
+    return false;
+
+  etag = response->value_get(MIME_FIELD_ETAG, MIME_LEN_ETAG, &etag_len);
+  if (etag && etag_len >= 2 && etag[0] == 'W' && etag[1] == '/')
+    etag = NULL;
+  if (!etag && !response->get_last_modified()) {
+    DebugTxn("http_trans", "[is_partial_response_cacheable] no strong validator");
+    return false;
+  }
+
+  if (s->cache_info.action == CACHE_DO_UPDATE) {
+    HTTPHdr *cached_response = s->cache_info.object_read->response_get();
+    const char *cached_etag;
+    int cached_etag_len;
+
+    if (!s->cache_info.object_read->is_partial() || s->cache_info.object_read->object_size_get() != size)
+      return false;
+    cached_etag = cached_response->value_get(MIME_FIELD_ETAG, MIME_LEN_ETAG, &cached_etag_len);
+    if (etag ? (!cached_etag || cached_etag_len != etag_len || memcmp(etag, cached_etag, etag_len)) :
+               response->get_last_modified() != cached_response->get_last_modified()) {
+      DebugTxn("http_trans", "[is_partial_response_cacheable] range of a different version");
+      return false;
+    }
+  } else if (s->cache_info.action != CACHE_DO_WRITE) {
+    return false;
+  }
+
+  DebugTxn("http_trans", "[is_partial_response_cacheable] bytes %" PRId64 "-%" PRId64 " of %" PRId64, first, last, size);
+  s->partial_write_offset = first;
+  s->partial_write_size = size;
+  return true;
+}
+
 void
 HttpTransact::build_request(State *s, HTTPHdr *base_request, HTTPHdr *outgoing_request, HTTPVersion outgoing_version)
 {
@@ -956,6 +956,11 @@ public:
     bool transparent_passthrough;
     bool range_in_cache;
 
+    // Where a 206 response goes in the partially cached object, -1 if the
+    // response is not stored as part of one
+    int64_t partial_write_offset;
+    int64_t partial_write_size;
+
     // Methods
     void
     init()
@@ -992,7 +997,7 @@ public:
         congestion_congested_or_failed(0), congestion_connection_opened(0), filter_mask(0), remap_redirect(NULL),
         reverse_proxy(false), url_remap_success(false), api_skip_all_remapping(false), already_downgraded(false), pristine_url(),
         range_setup(RANGE_NONE), num_range_fields(0), range_output_cl(0), ranges(NULL), txn_conf(NULL),
-        transparent_passthrough(false), range_in_cache(false)
+        transparent_passthrough(false), range_in_cache(false), partial_write_offset(-1), partial_write_size(-1)
     {
       int i;
       char *via_ptr = via_string;
@@ -1207,6 +1212,7 @@ public:
   static bool is_request_retryable(State *s);
 
   static bool is_response_cacheable(State *s, HTTPHdr *request, HTTPHdr *response);
+  static bool is_partial_response_cacheable(State *s);
   static bool is_response_valid(State *s, HTTPHdr *incoming_response);
 
   static void process_quick_http_filter(State *s, int method);
@@ -1217,6 +1223,7 @@ public:
   static bool setup_auth_lookup(State *s);
   static bool will_this_request_self_loop(State *s);
   static bool is_request_likely_cacheable(State *s, HTTPHdr *request);
+  static bool is_request_partially_cacheable(State *s, HTTPHdr *request);
 
   static void build_request(State *s, HTTPHdr *base_request, HTTPHdr *outgoing_request, HTTPVersion outgoing_version);
   static void build_response(State *s, HTTPHdr *base_response, HTTPHdr *outgoing_response, HTTPVersion outgoing_version,
@@ -29,6 +29,8 @@
 #include "time.h"
 #include "HTTP.h"
 #include "HttpCompat.h"
+#include "HdrUtils.h"
+#include "ts/HashFNV.h"
 #include "Error.h"
 #include "ts/InkErrno.h"
 
@@ -200,6 +202,15 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
     return 0;
   }
 
+  // An alternate whose Vary'd request headers are known to differ from the
+  // client's can only get Q = -1, so it is skipped by comparing hashes instead
+  // of being scored. Unless Vary is partly ignored, see CalcVariability, or a
+  // plugin selects alternates and must see every one of them.
+  bool use_variants = alt_count > 1 && !http_config_params->cache_global_user_agent_header &&
+                      !http_config_params->ignore_accept_encoding_mismatch && !http_global_hooks->get(TS_HTTP_SELECT_ALT_HOOK);
+  uint64_t client_vary_key = 0, client_variant_key = 0;
+  bool client_keyed = false;
+
   for (int i = 0; i < alt_count; i++) {
     float Q;
     CacheHTTPInfo *obj = cache_vector->get(i);
@@ -210,6 +221,18 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
       ink_assert(cached_request->valid());
       ink_assert(cached_response->valid());
 
+      uint64_t vary_key, variant_key;
+      if (use_variants && calculate_variant_key(cached_request, cached_response, &vary_key, &variant_key)) {
+        if (!client_keyed || vary_key != client_vary_key) {
+          calculate_variant_key(client_request, cached_response, &client_vary_key, &client_variant_key);
+          client_keyed = true;
+        }
+        if (variant_key != client_variant_key) {
+          Debug("http_match", "[SelectFromAlternates] alternate #%d varies", i + 1);
+          continue;
+        }
+      }
+
       Q = calculate_quality_of_match(http_config_params, client_request, cached_request, cached_response);
 
       if (alt_count > 1) {
@@ -1258,6 +1281,57 @@ HttpTransactCache::CalcVariability(CacheLookupHttpConfig *http_config_params, HT
   return variability;
 }
 
+/**
+  Hash the header names in the Vary of @a response and the values @a request
+  has for them. Values are compared the way CalcVariability does, so if the
+  hashes of two requests for the same Vary differ, one of them varies from
+  the other.
+
+  @return false if @a response has no Vary or varies on everything.
+*/
+bool
+HttpTransactCache::calculate_variant_key(HTTPHdr *request, HTTPHdr *response, uint64_t *vary_key, uint64_t *variant_key)
+{
+  StrList vary_list;
+  ATSHash64FNV1a vary_hash, variant_hash;
+
+  if (response->value_get_comma_list(MIME_FIELD_VARY, MIME_LEN_VARY, &vary_list) <= 0)
+    return false;
+
+  for (Str *field = vary_list.head; field != NULL; field = field->next) {
+    if (field->len == 0)
+      continue;
+    if ((field->str[0] == '*') && (field->str[1] == NUL))
+      return false;
+
+    char *field_name_str = (char *)hdrtoken_string_to_wks(field->str, field->len);
+    if (field_name_str == NULL)
+      field_name_str = (char *)field->str;
+
+    vary_hash.update(field->str, field->len, ATSHash::nocase());
+    vary_hash.update("\n", 1);
+    variant_hash.update(field->str, field->len, ATSHash::nocase());
+
+    MIMEField *request_field = request->field_find(field_name_str, field->len);
+    if (request_field) {
+      HdrCsvIter iter;
+      int len;
+
+      for (const char *value = iter.get_first(request_field, &len); value; value = iter.get_next(&len)) {
+        variant_hash.update(":", 1);
+        variant_hash.update(value, len, ATSHash::nocase());
+      }
+    }
+    variant_hash.update("\n", 1);
+  }
+
+  vary_hash.final();
+  variant_hash.final();
+  *vary_key = vary_hash.get();
+  *variant_key = variant_hash.get();
+  return true;
+}
+
 /**
   If the request has If-modified-since or If-none-match,
   HTTP_STATUS_NOT_MODIFIED is returned if both or the existing one
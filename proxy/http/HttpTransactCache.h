@@ -129,6 +129,8 @@ public:
                                        HTTPHdr *obj_origin_server_response                                 // in
                                        );
 
+  static bool calculate_variant_key(HTTPHdr *request, HTTPHdr *response, uint64_t *vary_key, uint64_t *variant_key);
+
   static HTTPStatus match_response_to_request_conditionals(HTTPHdr *ua_request, HTTPHdr *c_response,
                                                            ink_time_t response_received_time);
 };
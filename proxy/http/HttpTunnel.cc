@@ -1149,6 +1149,16 @@ HttpTunnel::producer_handler(int event, HttpTunnelProducer *p)
 
   switch (event) {
   case VC_EVENT_READ_READY:
+    // A transfer that keeps going gets bigger blocks, so the same bytes take fewer reads and writes
+    if (p->vc_type == HT_HTTP_SERVER && p->read_vio && sm->t_state.http_config_param->adaptive_buffer_size) {
+      int64_t max_index = buffer_size_to_index(sm->t_state.http_config_param->adaptive_buffer_max_size);
+      MIOBuffer *buf = p->read_buffer;
+
+      if (buf->size_index < max_index && p->read_vio->ndone >= 2 * index_to_buffer_size(buf->size_index)) {
+        ++buf->size_index;
+      }
+    }
+
     // Data read from producer, reenable consumers
     for (c = p->consumer_list.head; c; c = c->link.next) {
       if (c->alive) {
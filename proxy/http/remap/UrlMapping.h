@@ -75,6 +75,8 @@ public:
   static redirect_tag_str *parse_format_redirect_url(char *url);
 };
 
+struct HttpLatencyEntry;
+
 /**
  * Used to store the mapping for class UrlRewrite
 **/
@@ -109,7 +111,8 @@ public:
   unsigned int map_id;
   referer_info *referer_list;
   redirect_tag_str *redir_chunk_list;
-  acl_filter_rule *filter; // acl filtering (list of rules)
+  acl_filter_rule *filter;         // acl filtering (list of rules)
+  HttpLatencyEntry *latency_stats; // latency histograms of this rule, set on first use
   unsigned int _plugin_count;
   LINK(url_mapping, link); // For use with the main Queue linked list holding all the mapping
 
@@ -351,6 +351,7 @@ public:
   static uint32_t accept_no_activity_timeout;
   static uint32_t no_activity_timeout_in;
   static uint32_t active_timeout_in;
+  static uint32_t park_idle_buffers;
 
   static void init();
 };
@@ -60,7 +60,7 @@ send_connection_event(Continuation *cont, int event, void *edata)
 
 Http2ClientSession::Http2ClientSession()
   : con_id(0), total_write_len(0), client_vc(NULL), read_buffer(NULL), sm_reader(NULL), write_buffer(NULL), sm_writer(NULL),
-    upgrade_context()
+    parked(false), parked_bytes(0), upgrade_context()
 {
 }
 
@@ -71,6 +71,7 @@ Http2ClientSession::destroy()
 
   ink_release_assert(this->client_vc == NULL);
 
+  this->unpark();
   this->connection_state.destroy();
 
   super::destroy();
@@ -227,6 +228,7 @@ Http2ClientSession::main_event_handler(int event, void *edata)
   switch (event) {
   case VC_EVENT_READ_COMPLETE:
   case VC_EVENT_READ_READY:
+    this->unpark();
     return (this->*session_handler)(event, edata);
 
   case HTTP2_SESSION_EVENT_XMIT: {
@@ -414,10 +416,46 @@ Http2ClientSession::state_complete_frame_read(int event, void *edata)
     return this->handleEvent(VC_EVENT_READ_READY, vio);
   }
 
+  if (Http2::park_idle_buffers && this->connection_state.get_client_stream_count() == 0) {
+    this->park();
+  }
+
   vio->reenable();
   return 0;
 }
 
+// Free the blocks of the empty read buffer while the connection has no open
+// stream, the net processor allocates one again once the client connection
+// is readable.
+void
+Http2ClientSession::park()
+{
+  if (this->parked) {
+    return;
+  }
+
+  this->parked_bytes = 0;
+  for (IOBufferBlock *b = this->sm_reader->get_current_block(); b; b = b->next) {
+    this->parked_bytes += b->block_size();
+  }
+  this->read_buffer->release_blocks();
+  this->parked = true;
+
+  DebugHttp2Ssn("parked, released %" PRId64 " bytes", this->parked_bytes);
+  HTTP_INCREMENT_DYN_STAT(http_current_parked_client_connections_stat);
+  HTTP_SUM_DYN_STAT(http_parked_client_buffer_bytes_stat, this->parked_bytes);
+}
+
+void
+Http2ClientSession::unpark()
+{
+  if (this->parked) {
+    this->parked = false;
+    HTTP_DECREMENT_DYN_STAT(http_current_parked_client_connections_stat);
+    HTTP_SUM_DYN_STAT(http_parked_client_buffer_bytes_stat, -this->parked_bytes);
+  }
+}
+
 int64_t
 Http2ClientSession::getPluginId() const
 {
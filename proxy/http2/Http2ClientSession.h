@@ -222,6 +222,9 @@ private:
   int state_start_frame_read(int, void *);
   int state_complete_frame_read(int, void *);
 
+  void park();
+  void unpark();
+
   int64_t con_id;
   int64_t total_write_len;
   SessionHandler session_handler;
@@ -232,6 +235,8 @@ private:
   IOBufferReader *sm_writer;
   Http2FrameHeader current_hdr;
   Http2ConnectionState connection_state;
+  bool parked; // read_buffer blocks released while no stream is open
+  int64_t parked_bytes;
 
   // For Upgrade: h2c
   Http2UpgradeContext upgrade_context;
@@ -166,6 +166,12 @@ public:
   {
     return continued_stream_id;
   }
+
+  uint32_t
+  get_client_stream_count() const
+  {
+    return client_streams_count;
+  }
   void
   set_continued_stream_id(Http2StreamId stream_id)
   {